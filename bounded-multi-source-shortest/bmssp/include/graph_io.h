@@ -0,0 +1,45 @@
+#ifndef GRAPH_IO_H
+#define GRAPH_IO_H
+
+#include "types.h"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Lectura de grafos reales: DIMACS 9th challenge (.gr) y listas de
+// aristas (espacios o CSV). El archivo se lee por bloques y cada bloque se
+// reparte entre hilos; las aristas se insertan directamente en el Graph sin
+// construir un std::vector<Edge> del archivo completo.
+
+enum class InputFormat {
+    AUTO,       // por extensión: .gr -> DIMACS, resto -> lista de aristas
+    DIMACS_GR,  // "p sp n m" + "a u v w", nodos base 1
+    EDGE_LIST   // "u v [w]" separados por espacios o comas, nodos base 0
+};
+
+struct ParseOptions {
+    InputFormat format = InputFormat::AUTO;
+    int threads = 0;                       // 0 = std::thread::hardware_concurrency()
+    std::size_t chunk_bytes = 16u << 20;   // bytes leídos por bloque
+    Weight default_weight = 1.0;           // listas de aristas sin columna de peso
+};
+
+struct ParseStats {
+    std::size_t bytes = 0;
+    std::size_t nodes = 0;
+    std::size_t edges = 0;
+    double seconds = 0.0;
+
+    double mb_per_s() const {
+        return seconds > 0.0 ? (bytes / (1024.0 * 1024.0)) / seconds : 0.0;
+    }
+};
+
+// Lanza std::runtime_error si el archivo no existe o tiene líneas mal formadas
+Graph load_graph(
+    const std::string& path,
+    const ParseOptions& opt = ParseOptions(),
+    ParseStats* stats = nullptr
+);
+
+#endif
@@ -0,0 +1,3 @@
+// Los dos proyectos comparten un único planificador: este proyecto usa el de
+// comparison-4algorithms tal cual (ver allí la documentación)
+#include "./../../comparison-4algorithms/include/thread_pool.h"
@@ -1,6 +1,7 @@
 #ifndef TYPES_H
 #define TYPES_H
 
+#include <cstddef>
 #include <vector>
 #include <unordered_map>
 
@@ -0,0 +1,2 @@
+// Misma implementación que en comparison-4algorithms (un único fuente)
+#include "./../../comparison-4algorithms/src/thread_pool.cpp"
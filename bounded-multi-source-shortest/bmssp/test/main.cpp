@@ -2,6 +2,7 @@
 #include "./../include/graph_generator.h"
 #include "./../include/dijkstra.h"
 #include "./../include/bmssp.h"
+#include "./../include/graph_io.h"
 
 #include <iostream>
 #include <fstream>
@@ -12,6 +13,8 @@
 #include <unordered_map>
 #include <vector>
 #include <cstdlib>   // para atoi, atof
+#include <algorithm>
+#include <random>
 
 using namespace std;
 
@@ -53,6 +56,43 @@ static BenchResult run_benchmark(const Graph& G, const vector<Edge>& E, Node sou
     return {time_dij, time_bm};
 }
 
+// Nodos del grafo en orden creciente, para sortear fuentes reproducibles
+// también en grafos cargados con ids no contiguos
+static vector<Node> sorted_nodes(const Graph& G) {
+    vector<Node> nodes;
+    nodes.reserve(G.size());
+    for (const auto& [u, _] : G) nodes.push_back(u);
+    sort(nodes.begin(), nodes.end());
+    return nodes;
+}
+
+static double median_of(vector<double> v) {
+    if (v.empty()) return 0.0;
+    sort(v.begin(), v.end());
+    size_t h = v.size() / 2;
+    return (v.size() % 2) ? v[h] : 0.5 * (v[h - 1] + v[h]);
+}
+
+// Filas agregadas (media y mediana) de todas las consultas de un grafo;
+// en ellas la columna query guarda el número de consultas
+static void write_sweep_aggregates(ofstream& fout, int graph, unsigned seed,
+                                   const vector<BenchResult>& rows) {
+    vector<double> dij, bm;
+    for (const auto& r : rows) {
+        dij.push_back(r.time_dij);
+        bm.push_back(r.time_bm);
+    }
+    auto mean = [](const vector<double>& v) {
+        double acc = 0.0;
+        for (double x : v) acc += x;
+        return v.empty() ? 0.0 : acc / v.size();
+    };
+    fout << "mean," << graph << "," << seed << "," << rows.size() << ",,"
+         << mean(dij) << "," << mean(bm) << "\n";
+    fout << "median," << graph << "," << seed << "," << rows.size() << ",,"
+         << median_of(dij) << "," << median_of(bm) << "\n";
+}
+
 static GraphType parse_graph_type(const string& s) {
     if (s == "random-m")   return GraphType::RANDOM_M;
     if (s == "er")         return GraphType::ER;
@@ -73,6 +113,16 @@ int main(int argc, char* argv[]) {
     string out_path = "benchmark_times.csv";
     string gtype_str = "random-m";
 
+    // modo sweep: un grafo por trial y muchas fuentes sobre él
+    string mode = "trials";
+    int queries = 100;
+    int warmup = 3;
+    unsigned query_seed = 12345;
+
+    // grafo real (DIMACS .gr o lista de aristas) en lugar de generado
+    string input_path, format_str = "auto";
+    int io_threads = 0;
+
     // parámetros específicos
     double p = 0.0005;
     int attach = 2;
@@ -95,6 +145,13 @@ int main(int argc, char* argv[]) {
         else if ((a == "--source") && need(1)) source = static_cast<Node>(atoi(argv[++i]));
         else if ((a == "--wmax") && need(1)) wmax = atof(argv[++i]);
         else if ((a == "--graph") && need(1)) gtype_str = argv[++i];
+        else if ((a == "--mode") && need(1)) mode = argv[++i];
+        else if ((a == "--queries") && need(1)) queries = atoi(argv[++i]);
+        else if ((a == "--warmup") && need(1)) warmup = atoi(argv[++i]);
+        else if ((a == "--query-seed") && need(1)) query_seed = static_cast<unsigned>(atoi(argv[++i]));
+        else if ((a == "--input") && need(1)) input_path = argv[++i];
+        else if ((a == "--format") && need(1)) format_str = argv[++i];
+        else if ((a == "--threads") && need(1)) io_threads = atoi(argv[++i]);
         // específicos
         else if ((a == "--p") && need(1)) p = atof(argv[++i]);
         else if ((a == "--attach") && need(1)) attach = atoi(argv[++i]);
@@ -110,12 +167,40 @@ int main(int argc, char* argv[]) {
 
     GraphType gtype = parse_graph_type(gtype_str);
 
+    // Con --input el grafo se carga una sola vez y se reutiliza en todos los trials
+    Graph G_input;
+    if (!input_path.empty()) {
+        ParseOptions popt;
+        popt.threads = io_threads;
+        if (format_str == "gr" || format_str == "dimacs") popt.format = InputFormat::DIMACS_GR;
+        else if (format_str == "edges" || format_str == "csv") popt.format = InputFormat::EDGE_LIST;
+
+        ParseStats pst;
+        try {
+            G_input = load_graph(input_path, popt, &pst);
+        } catch (const exception& ex) {
+            cerr << "Error: " << ex.what() << "\n";
+            return 1;
+        }
+        cout << "Grafo cargado: " << pst.nodes << " nodos, " << pst.edges << " aristas, "
+             << pst.bytes / (1024.0 * 1024.0) << " MB en " << pst.seconds << " s ("
+             << pst.mb_per_s() << " MB/s)\n";
+    }
+    const vector<Edge> no_edges;  // bmssp() no usa la lista de aristas
+
     ofstream fout(out_path);
     if (!fout) {
         cerr << "Error: cannot open output file: " << out_path << "\n";
         return 1;
     }
-    fout << "trial,seed,time_dijkstra,time_bmssp\n";
+    const bool sweep = (mode == "sweep");
+    if (sweep) {
+        // Con --input solo hay un grafo
+        if (!input_path.empty()) trials = 1;
+        fout << "kind,graph,seed,query,source,time_dijkstra,time_bmssp\n";
+    } else {
+        fout << "trial,seed,time_dijkstra,time_bmssp\n";
+    }
 
     for (int i = 0; i < trials; ++i) {
         GraphGenOptions opt;
@@ -136,7 +221,35 @@ int main(int argc, char* argv[]) {
                 opt.layers = layers; opt.width = width; opt.dagp = dagp; break;
         }
 
-        auto [G, E] = generate_graph(gtype, opt);
+        if (!input_path.empty()) opt.seed = seed0;
+        pair<Graph, vector<Edge>> generated;
+        if (input_path.empty()) generated = generate_graph(gtype, opt);
+        const Graph& G = input_path.empty() ? generated.first : G_input;
+        const vector<Edge>& E = input_path.empty() ? generated.second : no_edges;
+
+        if (sweep) {
+            // Fuentes sorteadas con mt19937 (salida fija por estándar) a partir
+            // de query_seed y del índice del grafo; el calentamiento usa las suyas
+            vector<Node> nodes = sorted_nodes(G);
+            if (nodes.empty()) continue;
+            mt19937 qrng(query_seed + 7919u * static_cast<unsigned>(i));
+            auto pick = [&]() { return nodes[qrng() % nodes.size()]; };
+
+            for (int w = 0; w < warmup; ++w) run_benchmark(G, E, pick());
+
+            vector<BenchResult> rows;
+            rows.reserve(max(0, queries));
+            for (int q = 0; q < queries; ++q) {
+                Node s_q = pick();
+                BenchResult r = run_benchmark(G, E, s_q);
+                rows.push_back(r);
+                fout << "query," << i << "," << opt.seed << "," << q << "," << s_q << ","
+                     << r.time_dij << "," << r.time_bm << "\n";
+            }
+            write_sweep_aggregates(fout, i, opt.seed, rows);
+            continue;
+        }
+
         if (!G.count(source)) source = 0;
 
         BenchResult r = run_benchmark(G, E, source);
@@ -144,6 +257,7 @@ int main(int argc, char* argv[]) {
     }
 
     fout.close();
-    cout << "CSV listo (" << trials << " tests) => " << out_path << "\n";
+    if (sweep) cout << "CSV listo (" << trials << " grafos x " << queries << " fuentes) => " << out_path << "\n";
+    else cout << "CSV listo (" << trials << " tests) => " << out_path << "\n";
     return 0;
 }
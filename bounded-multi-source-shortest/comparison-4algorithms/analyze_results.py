@@ -10,6 +10,26 @@ import matplotlib.pyplot as plt
 import sys
 import os
 
+def load_results(filename):
+    """Carga un CSV de resultados; en modo sweep descarta las filas agregadas"""
+    df = pd.read_csv(filename)
+    if 'kind' in df.columns:
+        df = df[df['kind'] == 'query']
+    return df
+
+ALGORITHM_KEYS = ['dijkstra', 'bmssp', 'astar', 'dstar_lite']
+
+def cost_per_relaxation(df):
+    """Nanosegundos por relajación de cada algoritmo (None si no hay contadores)"""
+    out = {}
+    for key in ALGORITHM_KEYS:
+        col = f'relaxations_{key}'
+        if col not in df.columns or df[col].sum() <= 0:
+            out[key] = None
+            continue
+        out[key] = 1e9 * df[f'time_{key}'].sum() / df[col].sum()
+    return out
+
 def analyze_csv(filename):
     """Analiza un archivo CSV de resultados"""
     if not os.path.exists(filename):
@@ -20,7 +40,7 @@ def analyze_csv(filename):
     print("=" * 50)
     
     # Cargar datos
-    df = pd.read_csv(filename)
+    df = load_results(filename)
     
     # Estadísticas básicas
     algorithms = ['time_dijkstra', 'time_bmssp', 'time_astar', 'time_dstar_lite']
@@ -64,6 +84,27 @@ def analyze_csv(filename):
     
     print()
 
+    # Contadores de Instrument (CSV generados con columnas relaxations_*)
+    costs = cost_per_relaxation(df)
+    if any(c is not None for c in costs.values()):
+        print("Coste por relajación (ns):")
+        for key, name in zip(ALGORITHM_KEYS, algorithm_names):
+            if costs[key] is None:
+                continue
+            line = f"  {name:8}: {costs[key]:.1f} ns  ({df[f'relaxations_{key}'].mean():.0f} relajaciones)"
+            misses = f'cache_misses_{key}'
+            if misses in df.columns and df[misses].notna().any():
+                line += f", {df[misses].sum() / df[f'relaxations_{key}'].sum():.3f} fallos de caché/relajación"
+            print(line)
+        print()
+
+    phases = [c for c in df.columns if c.startswith('bmssp_') and c.endswith('_s')]
+    if phases and df[phases].sum().sum() > 0:
+        print("Desglose de BMSSP por fase (segundos promedio):")
+        for c in phases:
+            print(f"  {c[len('bmssp_'):-2]:12}: {df[c].mean():.6f}")
+        print()
+
 def create_comparison_plot(filenames):
     """Crea un gráfico comparativo con colores distintivos"""
     plt.figure(figsize=(14, 10))
@@ -79,7 +120,7 @@ def create_comparison_plot(filenames):
 
     for i, filename in enumerate(filenames):
         if os.path.exists(filename):
-            df = pd.read_csv(filename)
+            df = load_results(filename)
             avg_times = [df[alg].mean() for alg in algorithms]
 
             # Crear etiqueta más descriptiva
@@ -104,6 +145,42 @@ def create_comparison_plot(filenames):
     plt.savefig('algorithm_comparison.png', dpi=300, bbox_inches='tight')
     plt.show()
 
+def create_cost_plot(filenames):
+    """Gráfico de coste por relajación (ns) cuando los CSV traen contadores"""
+    algorithm_names = ['Dijkstra', 'BMSSP', 'A*', 'D*-lite']
+    colors = ['#2E86AB', '#A23B72', '#F18F01', '#C73E1D']
+    x_pos = np.arange(len(algorithm_names))
+    width = 0.15
+
+    plotted = False
+    plt.figure(figsize=(14, 10))
+    for i, filename in enumerate(filenames):
+        if not os.path.exists(filename):
+            continue
+        costs = cost_per_relaxation(load_results(filename))
+        if all(c is None for c in costs.values()):
+            continue
+        values = [costs[k] if costs[k] is not None else 0.0 for k in ALGORITHM_KEYS]
+        label = filename.replace('test_', '').replace('.csv', '').replace('_', ' ').title()
+        plt.bar(x_pos + i*width, values, width, label=label,
+                color=colors[i % len(colors)], alpha=0.8, edgecolor='black', linewidth=0.5)
+        plotted = True
+
+    if not plotted:
+        plt.close()
+        return
+
+    plt.xlabel('Algoritmos', fontsize=12, fontweight='bold')
+    plt.ylabel('Coste por relajación (ns)', fontsize=12, fontweight='bold')
+    plt.title('Coste por Relajación de Arista', fontsize=14, fontweight='bold', pad=20)
+    plt.xticks(x_pos + width*1.5, algorithm_names, fontsize=11)
+    plt.legend(bbox_to_anchor=(1.05, 1), loc='upper left', fontsize=10)
+    plt.grid(True, alpha=0.3, axis='y')
+
+    plt.tight_layout()
+    plt.savefig('cost_per_relaxation.png', dpi=300, bbox_inches='tight')
+    plt.show()
+
 def main():
     if len(sys.argv) < 2:
         print("Uso: python analyze_results.py [archivo1.csv] [archivo2.csv] ...")
@@ -121,6 +198,7 @@ def main():
     if len(filenames) > 1:
         print("[GRAFICO] Creando grafico comparativo...")
         create_comparison_plot(filenames)
+        create_cost_plot(filenames)
 
 if __name__ == "__main__":
     main()
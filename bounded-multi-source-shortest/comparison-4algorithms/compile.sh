@@ -1,20 +1,37 @@
 #!/bin/bash
 
 # Script de compilación para el proyecto con A* y D*-lite
-# Uso: ./compile.sh
+# Uso: ./compile.sh [opciones extra de g++]
+#   ./compile.sh -DWEIGHT_FLOAT   pesos float en los algoritmos sobre lista de adyacencia
 
 echo "Compilando proyecto con 4 algoritmos (BMSSP, Dijkstra, A*, D*-lite)..."
 
 cd test/
 
 # Compilar con optimizaciones para grafos grandes
-g++ -std=c++17 -O3 -march=native -mtune=native \
+g++ -std=c++17 -O3 -march=native -mtune=native -pthread "$@" \
   ./../src/graph_generator.cpp \
+  ./../src/csr_graph.cpp \
   ./../src/dijkstra.cpp \
   ./../src/data_structure_d.cpp \
   ./../src/bmssp.cpp \
+  ./../src/bmssp_trace.cpp \
+  ./../src/bmssp_tuner.cpp \
   ./../src/astar.cpp \
   ./../src/dstar_lite.cpp \
+  ./../src/graph_io.cpp \
+  ./../src/benchmark.cpp \
+  ./../src/validation.cpp \
+  ./../src/instrumentation.cpp \
+  ./../src/memory_pool.cpp \
+  ./../src/degree_reduction.cpp \
+  ./../src/grid_graph.cpp \
+  ./../src/jps.cpp \
+  ./../src/hpa.cpp \
+  ./../src/query_service.cpp \
+  ./../src/thread_pool.cpp \
+  ./../src/multi_agent.cpp \
+  ./../src/anytime.cpp \
   main.cpp -o test_4algorithms
 
 if [ $? -eq 0 ]; then
@@ -33,6 +50,39 @@ if [ $? -eq 0 ]; then
     echo ""
     echo "  # Malla 2D 2000x2000 (4M nodos)"
     echo "  ./test_4algorithms --graph grid2d --rows 2000 --cols 2000 -t 5"
+    echo ""
+    echo "  # double, float y punto fijo (x1000) sobre el mismo grafo CSR"
+    echo "  ./test_4algorithms --mode weights --graph random-m -n 2000000 -m 8000000 --fixed-scale 1000"
+    echo ""
+    echo "  # Malla 2000x2000 además sin listas de adyacencia (coste por celda: --grid-cost cell)"
+    echo "  ./test_4algorithms --graph grid2d --rows 2000 --cols 2000 --diag -t 3 --implicit"
+    echo ""
+    echo "  # Mapa de ocupación de coste uniforme: además JPS y JPS+ (columnas time_jps, time_jps_plus)"
+    echo "  ./test_4algorithms --graph grid2d --rows 2000 --cols 2000 --diag --implicit --grid-cost uniform --obstacles 0.2"
+    echo ""
+    echo "  # HPA* con clusters de 32x32 (columnas time_hpa y hpa_excess, exceso de coste sobre A*)"
+    echo "  ./test_4algorithms --graph grid2d --rows 2000 --cols 2000 --diag --implicit --grid-cost uniform --obstacles 0.05 --hpa 32"
+    echo ""
+    echo "  # Servicio de consultas concurrentes: registro \"algoritmo source target\" a varios ritmos (0 = sin límite)"
+    echo "  ./test_4algorithms --mode serve --graph grid2d --rows 500 --cols 500 --query-log consultas.txt --rate 0,100,1000 --service-threads 8"
+    echo ""
+    echo "  # Pool de trabajo común: coste de lanzar tareas (pool vs un std::thread por tarea) y prueba de estrés"
+    echo "  ./test_4algorithms --mode pool -t 3 -n 4000000 --pool-threads 8 --pool-pin --queries 200"
+    echo ""
+    echo "  # Agentes D* Lite sobre un mismo grafo: 64 agentes, 100 pasos con 200 cambios de coste por paso"
+    echo "  ./test_4algorithms --mode agents --graph grid2d --rows 300 --cols 300 --agents 64 --agent-steps 100 --changes 200"
+    echo ""
+    echo "  # Anytime: calidad frente a tiempo de A* ponderado, ARA* y Anytime D* (epsilon 3 -> 1, 10 ms por búsqueda)"
+    echo "  ./test_4algorithms --mode anytime --graph grid2d --rows 1000 --cols 1000 --implicit --epsilon 3 --epsilon-step 0.5 --budget-ms 10"
+    echo ""
+    echo "  # Plazo de 10 ms por consulta: coste del token sin plazo, consultas interrumpidas y retraso al parar"
+    echo "  ./test_4algorithms --mode deadline --graph grid2d --rows 1000 --cols 1000 --queries 50 --deadline-ms 10"
+    echo ""
+    echo "  # BMSSP también sobre el grafo transformado a grado <= 2 (columna time_bmssp_reduced)"
+    echo "  ./test_4algorithms --graph random-m -n 200000 -m 800000 -t 3 --degree-reduce"
+    echo ""
+    echo "  # Red de carreteras DIMACS (9th challenge) con coordenadas para A*"
+    echo "  ./test_4algorithms --input USA-road-d.NY.gr --coords USA-road-d.NY.co -t 5"
 else
     echo "❌ Error en la compilación"
     exit 1
@@ -0,0 +1,110 @@
+#ifndef ANYTIME_H
+#define ANYTIME_H
+
+#include "types.h"
+#include "cancel.h"
+#include "dstar_lite.h"
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <unordered_map>
+#include <vector>
+
+// Búsquedas acotadas y anytime: A* ponderado, ARA* (Likhachev, Gordon y
+// Thrun, 2003) y Anytime D* (Likhachev et al., 2005). Con una heurística
+// consistente, cada solución publicada cumple coste <= bound · óptimo.
+// Todas se detienen al agotar el presupuesto y devuelven la mejor solución
+// publicada hasta entonces.
+
+struct AnytimeOptions {
+    double epsilon_start = 3.0;  // peso inicial de h
+    double epsilon_step = 0.5;   // lo que baja epsilon en cada mejora
+    double epsilon_final = 1.0;  // 1 = termina con la solución óptima
+    AnytimeBudget budget;
+};
+
+struct AnytimeSolution {
+    std::vector<Node> path;  // source ... target; vacío si no hay camino
+    Weight cost;             // infinito si no hay camino
+    double epsilon = 0.0;    // epsilon de la iteración que la produjo
+    double bound = 0.0;      // cota de suboptimalidad (<= epsilon)
+    double seconds = 0.0;    // desde el inicio de la llamada
+    std::size_t expansions = 0;
+};
+
+// Recibe cada solución mejorada en el momento en que se obtiene
+using SolutionCallback = std::function<void(const AnytimeSolution&)>;
+
+struct AnytimeResult {
+    AnytimeSolution best;    // última solución publicada
+    int solutions = 0;       // soluciones publicadas
+    bool exhausted = false;  // se agotó el presupuesto antes de epsilon_final
+};
+
+// A* ponderado: una sola pasada con f = g + epsilon·h sin reabrir nodos
+template <class G>
+AnytimeResult weighted_astar(
+    const G& graph,
+    Node source,
+    Node target,
+    const HeuristicFunction& heuristic,
+    double epsilon,
+    const AnytimeBudget& budget = AnytimeBudget(),
+    Instrument* instr = nullptr,
+    std::pmr::memory_resource* mem = nullptr
+);
+
+// ARA*: A* ponderado con epsilon decreciente que reutiliza la búsqueda
+// anterior (solo reexpande los nodos inconsistentes). G: Graph, CsrGraph o
+// GridGraph (ver graph_concept.h); instanciado para los tres.
+template <class G>
+AnytimeResult ara_star(
+    const G& graph,
+    Node source,
+    Node target,
+    const HeuristicFunction& heuristic,
+    const AnytimeOptions& opt = AnytimeOptions(),
+    const SolutionCallback& on_solution = nullptr,
+    Instrument* instr = nullptr,
+    std::pmr::memory_resource* mem = nullptr
+);
+
+// Anytime D*: D*-lite (dstar_lite.h) con claves infladas por epsilon para
+// los nodos sobreconsistentes y una lista INCONS; cada mejora baja epsilon y
+// reutiliza el estado de la anterior. Tras cambios de coste repara la
+// solución con el epsilon inicial y vuelve a mejorarla. El grafo es del que
+// llama, que lo modifica y avisa con update_graph(); preds es el índice de
+// predecesores del grafo, prestado como en D*-lite, así que crearlo es O(1).
+template <class G>
+class BasicAnytimeDStar {
+private:
+    BasicDStarLite<G> engine;
+    AnytimeOptions options;
+    double epsilon;
+    bool converged = false;  // última solución con epsilon_final y sin cambios después
+    AnytimeSolution last;
+
+public:
+    // mem: memoria del estado por nodo (nullptr = recurso por defecto)
+    BasicAnytimeDStar(const G& g, Predecessors<G>& preds, Node s, Node goal, const HeuristicFunction& h,
+                      const AnytimeOptions& opt = AnytimeOptions(), Instrument* instr = nullptr,
+                      std::pmr::memory_resource* mem = nullptr);
+
+    // Mejora la solución hasta epsilon_final o hasta agotar el presupuesto
+    AnytimeResult improve(const SolutionCallback& on_solution = nullptr);
+
+    // changed_edges ya están aplicadas en el grafo (aristas nuevas solo en
+    // Graph); epsilon vuelve a epsilon_start para reparar deprisa
+    void update_graph(const std::vector<Edge>& changed_edges);
+
+    // El agente avanzó: las claves se recalculan en la siguiente mejora
+    void move_start(Node s);
+
+    double current_epsilon() const { return epsilon; }
+    std::size_t state_nodes() const { return engine.state_nodes(); }
+};
+
+using AnytimeDStar = BasicAnytimeDStar<Graph>;
+
+#endif
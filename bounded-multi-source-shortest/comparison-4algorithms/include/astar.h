@@ -2,16 +2,25 @@
 #define ASTAR_H
 
 #include "types.h"
+#include "cancel.h"
+#include <memory_resource>
 #include <unordered_map>
 #include <vector>
 
-// Algoritmo A* para encontrar camino más corto desde source hasta target
+// Algoritmo A* para encontrar camino más corto desde source hasta target.
+// G: Graph, CsrGraph o GridGraph (ver graph_concept.h); instanciado para
+// los tres. mem: memoria de los contenedores internos (nullptr = recurso por defecto).
+// cancel: si el token pide parar, devuelve el camino hasta target ya
+// encontrado (coste no necesariamente óptimo) o un mapa vacío.
+template <class G>
 std::unordered_map<Node, Weight> astar(
-    const Graph& graph, 
+    const G& graph, 
     Node source, 
     Node target,
     const HeuristicFunction& heuristic,
-    Instrument* instr = nullptr
+    Instrument* instr = nullptr,
+    std::pmr::memory_resource* mem = nullptr,
+    CancelToken* cancel = nullptr
 );
 
 // Heurística simple basada en distancia euclidiana estimada
@@ -0,0 +1,69 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <cstddef>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Arnés de medición: calentamiento, repetición adaptativa hasta que el
+// intervalo de confianza de la mediana es suficientemente estrecho,
+// afinidad de CPU opcional y vaciado de caché entre repeticiones.
+
+struct HarnessOptions {
+    int warmup = 3;              // ejecuciones descartadas
+    int min_reps = 10;
+    int max_reps = 1000;
+    double max_seconds = 10.0;   // tiempo total máximo de medición
+    double ci_target = 0.01;     // semiancho relativo del IC de la mediana
+    double confidence = 0.95;    // 0.90, 0.95 o 0.99
+    int pin_cpu = -1;            // -1 = sin afinidad (solo Linux)
+    bool flush_cache = false;    // mediciones en frío
+    std::size_t flush_bytes = 64u << 20;
+};
+
+struct BenchStats {
+    std::vector<double> samples;  // segundos, en orden de ejecución
+    int reps = 0;
+    bool converged = false;       // se alcanzó ci_target antes de los límites
+    double min = 0.0, median = 0.0, p90 = 0.0, p99 = 0.0, max = 0.0;
+    double mean = 0.0, stddev = 0.0;
+    double ci_low = 0.0, ci_high = 0.0;  // IC de la mediana (estadísticos de orden)
+
+    double ci_rel_halfwidth() const {
+        return median > 0.0 ? 0.5 * (ci_high - ci_low) / median : 0.0;
+    }
+};
+
+// Mide body(); setup() se ejecuta antes de cada repetición fuera del tiempo
+// medido (p.ej. reinicializar distancias)
+BenchStats measure(
+    const std::function<void()>& body,
+    const HarnessOptions& opt = HarnessOptions(),
+    const std::function<void()>& setup = nullptr
+);
+
+// Calcula estadísticos sobre muestras ya tomadas
+BenchStats summarize(std::vector<double> samples, double confidence = 0.95);
+
+// Percentil p en [0, 100] con interpolación lineal sobre datos ordenados
+double percentile_sorted(const std::vector<double>& sorted, double p);
+
+// Fija el hilo actual a un núcleo; false si no es posible en la plataforma
+bool pin_current_thread(int cpu);
+
+// Recorre un buffer mayor que la caché de último nivel
+void flush_caches(std::size_t bytes);
+
+// Salida CSV/JSON. label identifica la medición (algoritmo, grafo, etc.)
+struct BenchRecord {
+    std::string label;
+    std::vector<std::pair<std::string, std::string>> fields;  // columnas extra
+    BenchStats stats;
+};
+
+void write_bench_csv(std::ostream& os, const std::vector<BenchRecord>& records);
+void write_bench_json(std::ostream& os, const std::vector<BenchRecord>& records);
+
+#endif
@@ -2,6 +2,8 @@
 #define BMSSP_H
 
 #include "types.h"
+#include "cancel.h"
+#include <memory_resource>
 #include <unordered_set>
 #include <utility>
 
@@ -25,6 +27,26 @@ std::pair<double, std::unordered_set<Node>> basecase(
     Instrument* instr = nullptr
 );
 
+// Nivel de recursión inicial para n nodos: l = ⌈log2(n) / t⌉, t = ⌊log2(n)^(2/3)⌋
+int bmssp_default_levels(int n);
+
+// Parámetros de BMSSP; un valor <= 0 se deriva de n con las fórmulas del artículo
+struct BmsspParams {
+    int levels = 0;      // l de la llamada inicial, ⌈log2(n) / t⌉
+    int t = 0;           // t = ⌊log2(n)^(2/3)⌋
+    int k = 0;           // k = ⌊log2(n)^(1/3)⌋; también tamaño de basecase
+    int p_limit = 0;     // máximo de pivotes; <= 0 sin tope (como en el artículo)
+    int block_size = 0;  // bloque de DataStructureD, min(|P|, 64)
+    // Rondas de find_pivots con frentes grandes en el pool global, con
+    // dirección adaptativa (arriba abajo / abajo arriba). Solo con ids de
+    // nodo densos y más de un hilo; si no, secuencial. Las distancias finales
+    // no cambian (W y P pueden hacerlo: las rondas paralelas son de Jacobi).
+    bool parallel = false;
+};
+
+// Completa los campos <= 0 de p con los valores por defecto para n nodos
+BmsspParams bmssp_resolve_params(int n, const BmsspParams& p = BmsspParams());
+
 std::pair<double, std::unordered_set<Node>> bmssp(
     const Graph& graph,
     std::unordered_map<Node, Weight>& dist,
@@ -36,4 +58,45 @@ std::pair<double, std::unordered_set<Node>> bmssp(
     Instrument* instr = nullptr
 );
 
+// Igual que la anterior con parámetros explícitos; la llamada inicial usa
+// params.levels. mem respalda las arenas por nivel (nullptr = recurso por defecto).
+// Si la llamada inicial acaba en ejecución parcial (|U| >= k·2^(l·t)) el
+// B' devuelto es < B y los nodos con distancia en [B', B) quedan sin fijar.
+// cancel: si el token pide parar, cada nivel termina como en la ejecución
+// parcial (sin extraer más de D), con la misma garantía para d < B'.
+std::pair<double, std::unordered_set<Node>> bmssp(
+    const Graph& graph,
+    std::unordered_map<Node, Weight>& dist,
+    const std::vector<Edge>& edges,
+    const BmsspParams& params,
+    double B,
+    const std::unordered_set<Node>& S,
+    int n,
+    Instrument* instr = nullptr,
+    std::pmr::memory_resource* mem = nullptr,
+    CancelToken* cancel = nullptr
+);
+
+struct BmsspOutcome {
+    double B_prime = 0.0;         // B' de la llamada inicial (o del cierre si se interrumpe)
+    bool partial = false;         // B' < B: la llamada inicial no cubrió todo
+    size_t fallback_settled = 0;  // nodos fijados por el Dijkstra de cierre
+    SearchStatus status = SearchStatus::COMPLETE;  // parada por el token: dist exacta solo para d < B_prime
+};
+
+// bmssp() con resultado completo: si la llamada inicial es parcial, un
+// Dijkstra acotado por B sembrado con los nodos de distancia en [B', B)
+// termina el trabajo. Al volver, dist es exacta para todo nodo con d < B.
+BmsspOutcome bmssp_complete(
+    const Graph& graph,
+    std::unordered_map<Node, Weight>& dist,
+    const BmsspParams& params,
+    double B,
+    const std::unordered_set<Node>& S,
+    int n,
+    Instrument* instr = nullptr,
+    std::pmr::memory_resource* mem = nullptr,
+    CancelToken* cancel = nullptr
+);
+
 #endif
\ No newline at end of file
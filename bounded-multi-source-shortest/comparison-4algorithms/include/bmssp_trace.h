@@ -0,0 +1,63 @@
+#ifndef BMSSP_TRACE_H
+#define BMSSP_TRACE_H
+
+#include <chrono>
+#include <cstddef>
+#include <ostream>
+#include <vector>
+
+// Registro de cada llamada recursiva de bmssp(). Se activa asignando un
+// BmsspTrace a Instrument::trace; sin él el coste es una comprobación de puntero.
+
+struct TraceEvent {
+    int level = 0;
+    size_t S = 0, P = 0, W = 0, U = 0;  // tamaños de los conjuntos de la llamada
+    size_t pulls = 0;                   // extracciones de D
+    bool partial = false;               // acabó por |U| >= k·2^(l·t) con D no vacía
+    double B = 0.0, B_prime = 0.0;
+    double start = 0.0;                 // segundos desde la creación del trazador
+    double elapsed = 0.0;
+};
+
+// Agregado por nivel de todas las llamadas registradas, incluidas las que
+// el buffer circular ya haya descartado
+struct TraceLevelSummary {
+    size_t calls = 0;
+    size_t sum_S = 0, sum_P = 0, sum_W = 0, sum_U = 0;
+    size_t max_S = 0, max_U = 0;
+    size_t pulls = 0;
+    size_t partial = 0;      // llamadas con ejecución parcial
+    double seconds = 0.0;  // inclusivo
+};
+
+class BmsspTrace {
+private:
+    std::vector<TraceEvent> ring;
+    size_t head = 0;    // próxima posición a escribir
+    size_t stored = 0;
+    size_t total = 0;
+    std::vector<TraceLevelSummary> summary;
+    std::chrono::steady_clock::time_point origin;
+
+public:
+    explicit BmsspTrace(size_t capacity = 1u << 16);
+
+    double now() const;
+    void record(const TraceEvent& ev);
+    void clear();
+
+    size_t recorded() const { return total; }
+    size_t dropped() const { return total - stored; }
+
+    // Eventos retenidos, del más antiguo al más reciente (orden de salida)
+    std::vector<TraceEvent> events() const;
+    const std::vector<TraceLevelSummary>& levels() const { return summary; }
+
+    // Formato trace-event de Chrome (chrome://tracing, Perfetto): un evento
+    // "X" por llamada; las llamadas anidadas se ven como un flame graph
+    void write_chrome_trace(std::ostream& os) const;
+    // CSV con una fila por nivel
+    void write_level_summary(std::ostream& os) const;
+};
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef BMSSP_TUNER_H
+#define BMSSP_TUNER_H
+
+#include "types.h"
+#include "bmssp.h"
+#include <string>
+#include <vector>
+
+// Búsqueda de parámetros de BMSSP sobre una muestra de fuentes de un grafo.
+// Cada configuración se puntúa por (nodos con distancia distinta de Dijkstra,
+// tiempo total): una configuración rápida que deja nodos sin fijar no gana.
+
+enum class TuneMethod { GRID, SUCCESSIVE_HALVING };
+
+struct TuneOptions {
+    TuneMethod method = TuneMethod::SUCCESSIVE_HALVING;
+    int samples = 8;        // fuentes de la muestra
+    unsigned seed = 12345;  // sorteo de fuentes
+    int eta = 3;            // successive halving: conserva 1/eta por ronda
+    double tolerance = 1e-9;
+};
+
+struct TuneCandidate {
+    BmsspParams params;     // resueltos (sin campos <= 0 salvo p_limit y block_size)
+    int evaluated = 0;      // fuentes medidas
+    size_t mismatches = 0;
+    double seconds = 0.0;
+
+    double mean_seconds() const { return evaluated ? seconds / evaluated : 0.0; }
+};
+
+struct TuneResult {
+    std::string fingerprint;
+    TuneCandidate best;
+    TuneCandidate baseline;  // parámetros por defecto sobre las mismas fuentes
+    size_t candidates = 0;
+    size_t runs = 0;         // ejecuciones de bmssp() en total
+};
+
+// Huella del grafo independiente del orden de inserción: n, m y un hash de
+// las aristas
+std::string graph_fingerprint(const Graph& graph);
+
+// Rejilla alrededor de los valores por defecto para n nodos
+std::vector<BmsspParams> default_search_space(int n);
+
+TuneResult tune_bmssp(const Graph& graph, const std::vector<Edge>& edges,
+                      const std::vector<BmsspParams>& space,
+                      const TuneOptions& opt = TuneOptions());
+
+// Base de configuraciones: una línea "huella levels t k p_limit block_size"
+// por grafo. load devuelve false si la huella no está (o no hay fichero).
+bool load_tuned_params(const std::string& path, const std::string& fingerprint, BmsspParams& out);
+void save_tuned_params(const std::string& path, const std::string& fingerprint, const BmsspParams& params);
+
+std::string params_to_string(const BmsspParams& p);
+
+#endif
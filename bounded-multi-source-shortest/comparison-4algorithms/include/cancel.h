@@ -0,0 +1,138 @@
+#ifndef CANCEL_H
+#define CANCEL_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+// Cancelación cooperativa para consultas con plazo. Los bucles principales
+// (dijkstra, astar, bmssp, D*-lite) consultan el token cada
+// CANCEL_CHECK_INTERVAL unidades de trabajo a través de un CancelPoll; sin
+// token el coste es un decremento y un salto que nunca se toma. Al parar
+// devuelven lo que llevan y el motivo queda en el token.
+
+enum class SearchStatus { COMPLETE, CANCELLED, DEADLINE };
+
+inline const char* search_status_name(SearchStatus s) {
+    switch (s) {
+        case SearchStatus::COMPLETE: return "complete";
+        case SearchStatus::CANCELLED: return "cancelled";
+        case SearchStatus::DEADLINE: return "deadline";
+    }
+    return "?";
+}
+
+// Un token por consulta: cancel() vale desde cualquier hilo; el plazo se
+// fija antes de lanzarla
+class CancelToken {
+private:
+    using clock = std::chrono::steady_clock;
+    std::atomic<bool> cancelled{false};
+    std::atomic<SearchStatus> result{SearchStatus::COMPLETE};
+    clock::time_point deadline = clock::time_point::max();
+
+public:
+    CancelToken() = default;
+    // Plazo de seconds desde ahora (<= 0: sin plazo)
+    explicit CancelToken(double seconds) { set_timeout(seconds); }
+
+    void cancel() { cancelled.store(true, std::memory_order_relaxed); }
+    void set_deadline(clock::time_point t) { deadline = t; }
+    void set_timeout(double seconds) {
+        deadline = seconds > 0.0 ? clock::now() + std::chrono::duration_cast<clock::duration>(
+                                                      std::chrono::duration<double>(seconds))
+                                 : clock::time_point::max();
+    }
+
+    // Lo llaman los algoritmos: true = hay que parar, con el motivo anotado
+    bool check() {
+        if (cancelled.load(std::memory_order_relaxed)) {
+            result.store(SearchStatus::CANCELLED, std::memory_order_relaxed);
+            return true;
+        }
+        if (deadline != clock::time_point::max() && clock::now() >= deadline) {
+            result.store(SearchStatus::DEADLINE, std::memory_order_relaxed);
+            return true;
+        }
+        return false;
+    }
+
+    // COMPLETE salvo que alguna búsqueda se haya detenido por este token
+    SearchStatus status() const { return result.load(std::memory_order_relaxed); }
+    bool stopped() const { return status() != SearchStatus::COMPLETE; }
+};
+
+// Unidades de trabajo entre dos consultas al token. Una unidad es una
+// extracción, una arista relajada o un nodo recorrido en una pasada lineal,
+// así que un nodo de grado alto no alarga el intervalo. 1024 unidades son
+// unas 200 extracciones con grado medio 4: una llamada a now() entre ellas
+// queda por debajo del 1 % incluso en grafos indexados
+constexpr std::int64_t CANCEL_CHECK_INTERVAL = 1024;
+
+// Contador local del bucle. Sin token empieza en el máximo y nunca llega a 0
+// en la práctica; tras parar se queda en 0 para que cada llamada siguiente
+// vuelva a decir que pare.
+class CancelPoll {
+private:
+    CancelToken* token;
+    std::int64_t left;
+
+    bool expired() {
+        if (!token) {
+            left = std::numeric_limits<std::int64_t>::max();
+            return false;
+        }
+        if (token->check()) {
+            left = 0;
+            return true;
+        }
+        left = CANCEL_CHECK_INTERVAL;
+        return false;
+    }
+
+public:
+    explicit CancelPoll(CancelToken* t)
+        : token(t), left(t ? CANCEL_CHECK_INTERVAL : std::numeric_limits<std::int64_t>::max()) {}
+
+    // work unidades desde la última llamada; true = hay que parar
+    bool stop(std::int64_t work = 1) {
+        if ((left -= work) > 0) return false;
+        return expired();
+    }
+};
+
+// Límite de trabajo de las búsquedas anytime (anytime.h, y D*-lite como
+// motor de Anytime D*); el reloj se consulta cada 64 expansiones
+struct AnytimeBudget {
+    double seconds = 0.0;        // <= 0: sin límite de tiempo
+    std::size_t expansions = 0;  // 0: sin límite de expansiones
+};
+
+// Cuenta expansiones contra un AnytimeBudget desde su construcción
+class BudgetMeter {
+private:
+    using clock = std::chrono::steady_clock;
+    AnytimeBudget budget;
+    clock::time_point t0;
+    std::size_t count = 0;
+    bool out = false;
+
+public:
+    explicit BudgetMeter(const AnytimeBudget& b) : budget(b), t0(clock::now()) {}
+
+    // Una expansión más; false si el presupuesto ya está agotado
+    bool expand() {
+        if (out) return false;
+        ++count;
+        if (budget.expansions > 0 && count > budget.expansions) out = true;
+        else if (budget.seconds > 0.0 && (count & 63) == 0 && seconds() >= budget.seconds) out = true;
+        return !out;
+    }
+    bool exhausted() const { return out; }
+    std::size_t expansions() const { return count; }
+    double seconds() const { return std::chrono::duration<double>(clock::now() - t0).count(); }
+};
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef CSR_GRAPH_H
+#define CSR_GRAPH_H
+
+#include "types.h"
+#include "weight.h"
+#include <cstddef>
+#include <vector>
+
+// Grafo en formato CSR: las aristas salientes de u ocupan el rango
+// [offsets[u], offsets[u+1]) de targets/weights. Nodos 0..n-1.
+// W: tipo de peso (ver weight.h); en punto fijo, peso real = weights[e] / scale.
+// Concepto de grafo indexado compartido con GridGraph: graph_concept.h.
+template <class W>
+struct BasicCsrGraph {
+    using weight_type = W;
+
+    std::vector<std::size_t> offsets;
+    std::vector<Node> targets;
+    std::vector<W> weights;
+    double scale = 1.0;
+
+    int num_nodes() const { return offsets.empty() ? 0 : (int)offsets.size() - 1; }
+    std::size_t num_edges() const { return targets.size(); }
+    std::size_t degree(Node u) const { return offsets[u + 1] - offsets[u]; }
+
+    template <class F>
+    void for_each_out(Node u, F&& f) const {
+        for (std::size_t e = offsets[u]; e < offsets[u + 1]; ++e) f(targets[e], weights[e]);
+    }
+};
+
+using CsrGraph = BasicCsrGraph<Weight>;
+
+// Resultado de las comprobaciones al cambiar el tipo de peso
+struct WeightCastReport {
+    double max_abs_error = 0.0;   // redondeo máximo de un peso
+    double max_rel_error = 0.0;
+    std::size_t zeroed = 0;       // pesos positivos que quedan en 0
+    double path_bound = 0.0;      // (n-1) * peso máximo: cota de cualquier camino simple
+    // La cota de camino no es representable con precisión/rango del tipo:
+    // fixed32 puede saturar en infinito; float pierde más de 1e-3 relativo
+    bool path_may_overflow = false;
+    bool path_may_lose_precision = false;
+};
+
+// Copia el grafo con pesos de tipo W. scale solo se usa en punto fijo.
+// Lanza std::overflow_error/std::domain_error si algún peso no cabe.
+template <class W>
+BasicCsrGraph<W> cast_weights(const CsrGraph& csr, double scale = 1.0, WeightCastReport* report = nullptr);
+
+// Conversión al formato de lista de adyacencia que usan los algoritmos
+Graph csr_to_graph(const CsrGraph& csr);
+
+std::vector<Edge> csr_to_edges(const CsrGraph& csr);
+
+#endif
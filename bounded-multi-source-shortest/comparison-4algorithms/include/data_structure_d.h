@@ -2,14 +2,16 @@
 #define DATA_STRUCTURE_D_H
 
 #include "types.h"
-#include <queue>
+#include "packed_key.h"
+#include <vector>
 #include <unordered_set>
 #include <utility>
 
 class DataStructureD {
 private:
-    using PQPair = std::pair<Weight, Node>;
-    std::priority_queue<PQPair, std::vector<PQPair>, std::greater<PQPair>> heap;
+    // Montículo de mínimos de claves empaquetadas (std::push_heap con greater);
+    // la clave exacta de cada nodo está en best
+    std::vector<PackedKey> heap;
     std::unordered_map<Node, Weight> best;
     int M;
     double B_upper;
@@ -20,10 +22,17 @@ private:
 public:
     DataStructureD(int M, double B_upper, int block_size = -1);
     
+    // Vacía D y fija nuevos parámetros conservando la memoria reservada
+    void reset(int M, double B_upper, int block_size = -1);
+    
     void insert(Node v, Weight key);
     void batch_prepend(const std::vector<std::pair<Node, Weight>>& pairs);
     bool empty();
     std::pair<Weight, std::unordered_set<Node>> pull();
+    // Como pull() pero escribe el bloque en out (vaciado antes) y devuelve Bi:
+    // una cota estrictamente mayor que el bloque y no mayor que ninguna
+    // clave que queda en D, o B_upper si queda vacía
+    Weight pull_into(std::vector<Node>& out);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,40 @@
+#ifndef DEGREE_REDUCTION_H
+#define DEGREE_REDUCTION_H
+
+#include "types.h"
+#include <cstddef>
+#include <unordered_map>
+
+// Transformación a grado constante (preprocesado del artículo de BMSSP):
+// cada vértice v con grado de entrada + salida mayor que max_degree se
+// sustituye por un ciclo dirigido de peso cero con un nodo por arista
+// incidente. Cada nodo del ciclo conserva una única arista original, así
+// que su grado de entrada y de salida es <= 2.
+//
+// El primer nodo del ciclo conserva el id de v y los demás reciben ids
+// nuevos por encima de max_original. Como el ciclo pesa cero, todos sus
+// nodos tienen la distancia de v: una consulta desde v sobre el grafo
+// reducido da las distancias originales en los mismos ids.
+
+struct DegreeReduction {
+    Graph graph;                      // grafo transformado
+    Node max_original = -1;           // ids > max_original son nodos de ciclo
+    std::size_t original_nodes = 0;
+    std::size_t original_edges = 0;
+    std::size_t edges = 0;            // aristas del grafo transformado (con las de ciclo)
+    std::size_t reduced_vertices = 0; // vértices sustituidos por un ciclo
+    double seconds = 0.0;             // tiempo de la transformación
+
+    std::size_t nodes() const { return graph.size(); }
+};
+
+// Lanza std::runtime_error si max_degree < 2 o si los ids nuevos desbordan Node
+DegreeReduction reduce_degree(const Graph& graph, int max_degree = 2);
+
+// Distancias de los nodos originales a partir de las del grafo reducido
+std::unordered_map<Node, Weight> map_back_distances(
+    const DegreeReduction& reduction,
+    const std::unordered_map<Node, Weight>& dist
+);
+
+#endif
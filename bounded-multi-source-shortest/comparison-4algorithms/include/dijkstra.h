@@ -2,12 +2,47 @@
 #define DIJKSTRA_H
 
 #include "types.h"
+#include "csr_graph.h"
+#include "grid_graph.h"
+#include "cancel.h"
+#include <memory_resource>
 #include <unordered_map>
+#include <vector>
 
+// mem: memoria de la cola de prioridad (nullptr = recurso por defecto).
+// cancel: si el token pide parar (ver cancel.h), el resultado es parcial:
+// exacto para los nodos ya extraídos, cota superior para el resto. Si para
+// durante la inicialización O(n), solo están source y los nodos ya
+// inicializados (a infinito).
 std::unordered_map<Node, Weight> dijkstra(
     const Graph& graph, 
     Node source, 
-    Instrument* instr = nullptr
+    Instrument* instr = nullptr,
+    std::pmr::memory_resource* mem = nullptr,
+    CancelToken* cancel = nullptr
 );
 
-#endif
\ No newline at end of file
+// Núcleo sobre CSR plantillado en el tipo de peso (instanciado para double,
+// float y Fixed32). Devuelve dist[u] para u en 0..n-1; WeightTraits<W>::inf()
+// marca los no alcanzables (en Fixed32 también los que saturan).
+template <class W>
+std::vector<W> dijkstra_csr(
+    const BasicCsrGraph<W>& graph,
+    Node source,
+    Instrument* instr = nullptr,
+    std::pmr::memory_resource* mem = nullptr,
+    CancelToken* cancel = nullptr
+);
+
+// El mismo núcleo sobre cualquier grafo indexado (graph_concept.h);
+// instanciado para GridGraph
+template <class G>
+std::vector<typename G::weight_type> dijkstra_indexed(
+    const G& graph,
+    Node source,
+    Instrument* instr = nullptr,
+    std::pmr::memory_resource* mem = nullptr,
+    CancelToken* cancel = nullptr
+);
+
+#endif
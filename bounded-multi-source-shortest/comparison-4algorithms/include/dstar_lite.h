@@ -2,53 +2,133 @@
 #define DSTAR_LITE_H
 
 #include "types.h"
+#include "graph_concept.h"
+#include "cancel.h"
+#include <memory_resource>
 #include <unordered_map>
-#include <vector>
 #include <unordered_set>
+#include <vector>
 #include <queue>
 
-// Algoritmo D*-lite para planificación dinámica
-class DStarLite {
+// Algoritmo D*-lite (Koenig y Likhachev, 2002) para planificación dinámica:
+// búsqueda hacia atrás desde goal, g(u) = distancia u -> goal. G: Graph,
+// CsrGraph o GridGraph (ver graph_concept.h); instanciado para los tres.
+// Sobre Graph el estado es disperso y h se calcula al primer uso, así que la
+// memoria del estado crece con los nodos explorados, no con el grafo. Los
+// predecesores salen de un Predecessors<G> (graph_concept.h) construido una
+// vez por grafo y prestado al planificador, así que crearlo es O(1).
+// Con epsilon > 1 hace de motor de Anytime D* (anytime.h): las claves de
+// los nodos sobreconsistentes se inflan y los ya cerrados que vuelven a ser
+// inconsistentes esperan en INCONS hasta la siguiente iteración.
+template <class G>
+class BasicDStarLite {
 private:
-    const Graph& graph;
+    const G& graph;
     Node start, goal;
     HeuristicFunction heuristic;
     Instrument* instrument;
+    Instrument local_instrument;  // destino de los contadores si no se pasa uno
+    
+    std::pmr::memory_resource* memory;  // contenedores internos
+    
+    NodeValues<G, Weight> g_cost;
+    NodeValues<G, Weight> rhs_cost;
+    NodeValues<G, Weight> h_cost;  // memoria de h(start, u); < 0 sin calcular
+    Predecessors<G>& preds;        // prestado; update_graph anota las aristas nuevas
     
-    std::unordered_map<Node, Weight> g_cost;
-    std::unordered_map<Node, Weight> rhs_cost;
-    std::unordered_map<Node, Weight> h_cost;
+    // Entradas (f_cost, g_cost) = clave (k1, k2). Borrado perezoso: una
+    // entrada vale si su clave es la de open_key; open_key = (inf, inf) si
+    // el nodo no está en OPEN
+    using Key = std::pair<Weight, Weight>;
+    using OpenQueue = std::priority_queue<DStarLiteNode, std::pmr::vector<DStarLiteNode>, std::greater<DStarLiteNode>>;
+    OpenQueue open_list;
+    NodeValues<G, Key> open_key;
     
-    std::priority_queue<DStarLiteNode, std::vector<DStarLiteNode>, std::greater<DStarLiteNode>> open_list;
-    std::unordered_set<Node> open_set;
+    Weight km;  // key modifier; queda a 0: move_start rehace las claves
     
-    Weight km;  // key modifier
+    double epsilon = 1.0;                  // peso de h en las claves sobreconsistentes
+    std::pmr::unordered_set<Node> closed;  // sobreconsistentes expandidos (solo con epsilon > 1)
+    std::pmr::unordered_set<Node> incons;  // cerrados que volvieron a ser inconsistentes
+    bool rekey = false;                    // epsilon o start cambiaron: claves de OPEN obsoletas
+    
+    CancelToken* cancel;       // nullptr = sin plazo
+    bool interrupted = false;  // la última búsqueda paró por el token
+    std::int64_t work = 0;     // aristas recorridas por update_vertex desde la última consulta al token
     
     void initialize();
+    Weight h(Node u);
+    void push_open(Node u);
     void update_vertex(Node u);
-    void compute_shortest_path();
-    std::pair<Weight, Weight> calculate_key(Node u);
+    void reopen();
+    Key calculate_key(Node u);
     
 public:
-    DStarLite(const Graph& g, Node s, Node g_goal, const HeuristicFunction& h, Instrument* instr = nullptr);
+    // preds: predecesores de g, compartidos por todos los planificadores del
+    // grafo. mem: memoria de los contenedores internos (nullptr = recurso por
+    // defecto). Ambos deben sobrevivir al planificador. cancel: token
+    // consultado en compute_shortest_path (ver cancel.h)
+    BasicDStarLite(const G& g, Predecessors<G>& preds, Node s, Node g_goal, const HeuristicFunction& h,
+                   Instrument* instr = nullptr, std::pmr::memory_resource* mem = nullptr,
+                   CancelToken* cancel = nullptr);
     
-    // Encuentra el camino inicial
+    // Encuentra el camino inicial. Si el token la interrumpe devuelve un mapa
+    // vacío; el estado queda intacto y find_path()/replan() continúan la
+    // búsqueda donde se quedó (con un token nuevo vía set_cancel)
     std::unordered_map<Node, Weight> find_path();
     
-    // Actualiza el grafo cuando cambian los costos de las aristas
+    // changed_edges ya están aplicadas en el grafo: cambian de coste o son
+    // nuevas (solo en Graph; en los grafos indexados solo cambian pesos). Las
+    // nuevas se anotan en el índice de predecesores compartido
     void update_graph(const std::vector<Edge>& changed_edges);
     
     // Recalcula el camino después de cambios
     std::unordered_map<Node, Weight> replan();
+    
+    void set_cancel(CancelToken* token) { cancel = token; }
+    bool was_interrupted() const { return interrupted; }
+    
+    // Anytime D*: la siguiente búsqueda empieza otra iteración (CLOSED
+    // vacío, INCONS de vuelta en OPEN y claves recalculadas)
+    void set_epsilon(double eps);
+    void move_start(Node s);
+    
+    // Expande hasta que start es consistente; false si la para el token o
+    // se agota meter (el estado queda para continuar)
+    bool compute_shortest_path(BudgetMeter* meter = nullptr);
+    
+    // Camino por el sucesor que minimiza c(u, v) + g(v); true si llega a goal
+    bool path(std::vector<Node>& nodes, Weight& cost) const;
+    
+    std::size_t state_nodes() const { return rhs_cost.size(); }
 };
 
-// Función wrapper para compatibilidad con el benchmark
+using DStarLite = BasicDStarLite<Graph>;
+
+// Función wrapper para compatibilidad con el benchmark: una consulta con un
+// planificador nuevo sobre el índice preds del grafo
+template <class G>
+std::unordered_map<Node, Weight> dstar_lite(
+    const G& graph,
+    Predecessors<G>& preds,
+    Node source,
+    Node target,
+    const HeuristicFunction& heuristic,
+    Instrument* instr = nullptr,
+    std::pmr::memory_resource* mem = nullptr,
+    CancelToken* cancel = nullptr
+);
+
+// Sin índice: construye uno solo para esta consulta, O(n + m) en Graph y
+// CsrGraph. Para varias consultas sobre el mismo grafo, la versión con preds
+template <class G>
 std::unordered_map<Node, Weight> dstar_lite(
-    const Graph& graph, 
-    Node source, 
+    const G& graph,
+    Node source,
     Node target,
     const HeuristicFunction& heuristic,
-    Instrument* instr = nullptr
+    Instrument* instr = nullptr,
+    std::pmr::memory_resource* mem = nullptr,
+    CancelToken* cancel = nullptr
 );
 
 #endif
@@ -0,0 +1,169 @@
+#ifndef GRAPH_CONCEPT_H
+#define GRAPH_CONCEPT_H
+
+#include "types.h"
+#include <algorithm>
+#include <cstddef>
+#include <memory_resource>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Acceso uniforme a los grafos sobre los que corren A*, D*-lite y Dijkstra:
+//  - Graph (lista de adyacencia en hash, ids arbitrarios)
+//  - grafos indexados con nodos 0..n-1: BasicCsrGraph y GridGraph, que
+//    exponen weight_type, num_nodes() y for_each_out(u, f) con f(v, w);
+//    GridGraph además for_each_in(v, f) con f(u, w)
+
+inline std::size_t node_count(const Graph& g) { return g.size(); }
+
+template <class G>
+std::size_t node_count(const G& g) { return (std::size_t)g.num_nodes(); }
+
+template <class F>
+void for_each_node(const Graph& g, F&& f) {
+    for (const auto& [u, _] : g) f(u);
+}
+
+template <class G, class F>
+void for_each_node(const G& g, F&& f) {
+    for (Node u = 0, n = g.num_nodes(); u < n; ++u) f(u);
+}
+
+template <class F>
+void for_each_out(const Graph& g, Node u, F&& f) {
+    auto it = g.find(u);
+    if (it == g.end()) return;
+    for (const auto& [v, w] : it->second) f(v, w);
+}
+
+template <class G, class F>
+void for_each_out(const G& g, Node u, F&& f) {
+    g.for_each_out(u, f);
+}
+
+// Valor por nodo inicializado a init: vector denso en los grafos indexados
+// (sin hashing en el bucle principal) y hash disperso en Graph, donde solo
+// ocupan memoria los nodos escritos. get() lee sin crear la entrada.
+template <class G, class T>
+class NodeValues {
+private:
+    std::pmr::vector<T> values;
+
+public:
+    NodeValues(const G& g, T init, std::pmr::memory_resource* mem)
+        : values(node_count(g), init, mem) {}
+
+    T& operator[](Node u) { return values[(std::size_t)u]; }
+    const T& operator[](Node u) const { return values[(std::size_t)u]; }
+    T get(Node u) const { return values[(std::size_t)u]; }
+    void fill(T value) { std::fill(values.begin(), values.end(), value); }
+    std::size_t size() const { return values.size(); }
+};
+
+template <class T>
+class NodeValues<Graph, T> {
+private:
+    std::pmr::unordered_map<Node, T> values;
+    T init;
+
+public:
+    // O(1): un nodo ausente vale init hasta que se escribe
+    NodeValues(const Graph&, T init_value, std::pmr::memory_resource* mem)
+        : values(mem), init(init_value) {}
+
+    T& operator[](Node u) { return values.try_emplace(u, init).first->second; }
+    T get(Node u) const {
+        auto it = values.find(u);
+        return it == values.end() ? init : it->second;
+    }
+    // Todos los nodos pasan a valer value
+    void fill(T value) {
+        values.clear();
+        init = value;
+    }
+    std::size_t size() const { return values.size(); }  // nodos escritos
+};
+
+// true si G calcula sus aristas entrantes (for_each_in)
+template <class G, class = void>
+struct has_for_each_in : std::false_type {};
+
+template <class G>
+struct has_for_each_in<G, std::void_t<decltype(std::declval<const G&>().for_each_in(
+                              Node(), std::declval<void (*)(Node, typename G::weight_type)>()))>>
+    : std::true_type {};
+
+// Predecesores de cada nodo, para las búsquedas hacia atrás (D*-lite). En
+// los grafos indexados con for_each_in se calculan al vuelo; en los demás,
+// CSR inverso de O(n + m) construido con el índice. Se construye una vez por
+// grafo, como el grafo inverso de MultiAgentPlanner, y los planificadores lo
+// toman prestado: ninguna consulta paga el recorrido del grafo.
+template <class G>
+class Predecessors {
+private:
+    const G& graph;
+    std::pmr::vector<std::size_t> offsets;  // aristas hacia v: [offsets[v], offsets[v + 1])
+    std::pmr::vector<Node> sources;
+
+public:
+    explicit Predecessors(const G& g, std::pmr::memory_resource* mem = nullptr)
+        : graph(g), offsets(mem ? mem : std::pmr::get_default_resource()),
+          sources(mem ? mem : std::pmr::get_default_resource()) {
+        if constexpr (!has_for_each_in<G>::value) {
+            const int n = g.num_nodes();
+            offsets.assign((std::size_t)n + 1, 0);
+            for (Node u = 0; u < n; ++u) g.for_each_out(u, [&](Node v, auto) { offsets[(std::size_t)v + 1]++; });
+            for (int v = 0; v < n; ++v) offsets[(std::size_t)v + 1] += offsets[(std::size_t)v];
+            sources.resize(offsets.back());
+            std::pmr::vector<std::size_t> next(offsets.begin(), offsets.end() - 1, offsets.get_allocator());
+            for (Node u = 0; u < n; ++u) g.for_each_out(u, [&](Node v, auto) { sources[next[(std::size_t)v]++] = u; });
+        }
+    }
+
+    // f(u) para cada arista u -> v
+    template <class F>
+    void for_each(Node v, F&& f) const {
+        if constexpr (has_for_each_in<G>::value) {
+            graph.for_each_in(v, [&](Node u, auto) { f(u); });
+        } else {
+            for (std::size_t e = offsets[(std::size_t)v]; e < offsets[(std::size_t)v + 1]; ++e) f(sources[e]);
+        }
+    }
+
+    // Solo cambian pesos: no hay aristas nuevas que anotar
+    void add(Node, Node) {}
+};
+
+// Graph: índice inverso en hash; add() registra las aristas nuevas (una
+// arista ya anotada no se repite, así que varios planificadores que
+// comparten el índice pueden anotar el mismo cambio)
+template <>
+class Predecessors<Graph> {
+private:
+    std::pmr::unordered_map<Node, std::pmr::vector<Node>> preds;
+
+public:
+    explicit Predecessors(const Graph& g, std::pmr::memory_resource* mem = nullptr)
+        : preds(mem ? mem : std::pmr::get_default_resource()) {
+        preds.reserve(g.size());
+        for (const auto& [u, adj] : g) {
+            for (const auto& [v, w] : adj) preds[v].push_back(u);
+        }
+    }
+
+    template <class F>
+    void for_each(Node v, F&& f) const {
+        auto it = preds.find(v);
+        if (it == preds.end()) return;
+        for (Node u : it->second) f(u);
+    }
+
+    void add(Node from, Node to) {
+        auto& p = preds[to];
+        if (std::find(p.begin(), p.end(), from) == p.end()) p.push_back(from);
+    }
+};
+
+#endif
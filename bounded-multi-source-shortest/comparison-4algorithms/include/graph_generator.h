@@ -2,6 +2,8 @@
 #define GRAPH_GENERATOR_H
 
 #include "types.h"
+#include "csr_graph.h"
+#include "grid_graph.h"
 #include <utility>
 #include <vector>
 #include <unordered_map>
@@ -40,6 +42,8 @@ struct GraphGenOptions {
     bool diag = false;
     int layers = 0, width = 0;
     double dagp = 0.02;
+
+    int threads = 0;  // 0 = std::thread::hardware_concurrency(); no altera el grafo generado
 };
 
 std::pair<Graph, std::vector<Edge>> generate_graph(
@@ -47,6 +51,37 @@ std::pair<Graph, std::vector<Edge>> generate_graph(
     const GraphGenOptions& opt
 );
 
+// Generación directa en CSR, en paralelo y reproducible para cualquier
+// número de hilos (Philox por bloque de nodos origen)
+CsrGraph generate_graph_csr(
+    GraphType type,
+    const GraphGenOptions& opt
+);
+
+// Malla implícita sin listas de adyacencia. PLANES da exactamente los pesos
+// de generate_grid2d_directed con la misma semilla; CELL sortea un coste
+// por celda en [1, max_w).
+GridGraph generate_grid_implicit(
+    int rows,
+    int cols,
+    bool diag,
+    GridCostModel model,
+    double max_w = 100.0,
+    unsigned seed = 0,
+    int threads = 0
+);
+
+// Mapa de ocupación: coste 1 por celda y cada celda bloqueada con
+// probabilidad obstacle_p (coste uniforme, apto para JPS con diag)
+GridGraph generate_occupancy_grid(
+    int rows,
+    int cols,
+    bool diag,
+    double obstacle_p,
+    unsigned seed = 0,
+    int threads = 0
+);
+
 std::pair<Graph, std::vector<Edge>> generate_er_directed(
     int n, 
     double p, 
@@ -0,0 +1,119 @@
+#ifndef GRID_GRAPH_H
+#define GRID_GRAPH_H
+
+#include "types.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <limits>
+#include <vector>
+
+// Malla 2D implícita: rows x cols celdas, nodo u = r * cols + c, vecinos
+// calculados aritméticamente (4 u 8 direcciones) sin listas de adyacencia.
+// Cumple el mismo concepto de grafo indexado que BasicCsrGraph (ver
+// graph_concept.h): weight_type, num_nodes() y for_each_out(u, f).
+//
+// Dos modelos de coste:
+//  - CELL: coste por celda; entrar en v cuesta cell_cost[v] por la longitud
+//    del paso (1 recto, √2 en diagonal). Coste infinito = celda bloqueada.
+//  - PLANES: un plano de pesos por dirección; w(u -> vecino d) = planes[d][u].
+//    Reproduce exactamente cualquier malla con pesos por arista.
+
+enum class GridCostModel { CELL, PLANES };
+
+struct GridGraph {
+    using weight_type = Weight;
+
+    // Mismo orden de direcciones que el generador grid2d
+    static constexpr int DR4[4] = {1, -1, 0, 0};
+    static constexpr int DC4[4] = {0, 0, 1, -1};
+    static constexpr int DR8[8] = {1, 1, 1, 0, 0, -1, -1, -1};
+    static constexpr int DC8[8] = {1, 0, -1, 1, -1, 1, 0, -1};
+    static constexpr Weight SQRT2 = (Weight)1.41421356237309504880;
+
+    int rows = 0, cols = 0;
+    bool diag = false;                 // 8-conectada
+    GridCostModel model = GridCostModel::CELL;
+    std::vector<Weight> cell_cost;     // CELL: rows * cols
+    std::vector<Weight> planes;        // PLANES: directions() * rows * cols, plano d en [d*n, (d+1)*n)
+    Weight min_weight = 0;             // cota inferior de un paso recto, para la heurística
+
+    int num_nodes() const { return rows * cols; }
+    int directions() const { return diag ? 8 : 4; }
+    const int* dr() const { return diag ? DR8 : DR4; }
+    const int* dc() const { return diag ? DC8 : DC4; }
+    static bool is_diagonal(int dr, int dc) { return dr != 0 && dc != 0; }
+
+    bool blocked(Node u) const {
+        return model == GridCostModel::CELL && !(cell_cost[u] < std::numeric_limits<Weight>::infinity());
+    }
+
+    // f(v, w) para cada arista u -> v (se omiten las celdas bloqueadas)
+    template <class F>
+    void for_each_out(Node u, F&& f) const {
+        const int r = u / cols, c = u % cols;
+        const int n = rows * cols;
+        const int* r_off = dr();
+        const int* c_off = dc();
+        for (int d = 0, dirs = directions(); d < dirs; ++d) {
+            int rr = r + r_off[d], cc = c + c_off[d];
+            if (rr < 0 || rr >= rows || cc < 0 || cc >= cols) continue;
+            Node v = rr * cols + cc;
+            Weight w;
+            if (model == GridCostModel::PLANES) {
+                w = planes[(std::size_t)d * n + u];
+            } else {
+                w = cell_cost[v];
+                if (is_diagonal(r_off[d], c_off[d])) w *= SQRT2;
+            }
+            if (w < std::numeric_limits<Weight>::infinity()) f(v, w);
+        }
+    }
+
+    // f(u, w) para cada arista u -> v: las mismas aristas vistas desde v
+    template <class F>
+    void for_each_in(Node v, F&& f) const {
+        const int r = v / cols, c = v % cols;
+        const int n = rows * cols;
+        const int* r_off = dr();
+        const int* c_off = dc();
+        for (int d = 0, dirs = directions(); d < dirs; ++d) {
+            int ur = r - r_off[d], uc = c - c_off[d];
+            if (ur < 0 || ur >= rows || uc < 0 || uc >= cols) continue;
+            Node u = ur * cols + uc;
+            Weight w;
+            if (model == GridCostModel::PLANES) {
+                w = planes[(std::size_t)d * n + u];
+            } else {
+                w = cell_cost[v];
+                if (is_diagonal(r_off[d], c_off[d])) w *= SQRT2;
+            }
+            if (w < std::numeric_limits<Weight>::infinity()) f(u, w);
+        }
+    }
+
+    std::size_t num_edges() const;
+    std::size_t memory_bytes() const;
+
+    // Admisible: pasos mínimos entre a y b por min_weight (octil con coste
+    // por celda, Chebyshev con planos, Manhattan en 4-conectada)
+    Weight heuristic(Node a, Node b) const {
+        int dy = std::abs(a / cols - b / cols), dx = std::abs(a % cols - b % cols);
+        if (!diag) return (Weight)(dx + dy) * min_weight;
+        int lo = std::min(dx, dy), hi = std::max(dx, dy);
+        if (model == GridCostModel::PLANES) return (Weight)hi * min_weight;
+        return ((Weight)(hi - lo) + SQRT2 * lo) * min_weight;
+    }
+};
+
+// Malla con coste por celda (vector de rows * cols, infinito = bloqueada).
+// Lanza std::runtime_error si el tamaño no cuadra o hay costes negativos.
+GridGraph make_cell_grid(int rows, int cols, bool diag, std::vector<Weight> cell_cost);
+
+// Malla con un plano de pesos por dirección (directions() * rows * cols)
+GridGraph make_plane_grid(int rows, int cols, bool diag, std::vector<Weight> planes);
+
+// Lista de adyacencia equivalente, para comparar con los algoritmos sobre Graph
+Graph grid_to_graph(const GridGraph& grid);
+
+#endif
@@ -0,0 +1,75 @@
+#ifndef HPA_H
+#define HPA_H
+
+#include "types.h"
+#include "grid_graph.h"
+#include <cstddef>
+#include <memory_resource>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// HPA* (Botea, Müller y Schaeffer, 2004) sobre GridGraph: la malla se parte
+// en clusters de cluster_size x cluster_size celdas. En cada frontera entre
+// clusters vecinos, cada tramo de celdas cruzables aporta una transición (dos
+// en los extremos si el tramo es largo), y con diagonales también cada cruce
+// que solo existe en diagonal, incluidos los que pasan por la esquina común
+// de cuatro clusters; solo cuentan los cruces con arista en los dos
+// sentidos. Esas celdas son los nodos del grafo abstracto: cada cluster
+// guarda las distancias entre los suyos sin salir de él, y las aristas entre
+// clusters son las de la malla.
+//
+// find_path conecta source y target a los nodos de su cluster, busca con A*
+// en el grafo abstracto y refina cada tramo con A* dentro de su cluster. El
+// camino es casi óptimo (restringido a pasar por las transiciones). Con
+// source o target en una celda bloqueada devuelve vacío.
+//
+// La malla no se copia: tras cambiar costes en ella, cells_changed
+// recalcula solo los clusters afectados. Si algún coste baja de
+// grid.min_weight hay que actualizarlo para que la heurística siga siendo
+// admisible.
+class HpaGrid {
+private:
+    struct Cluster {
+        std::vector<Node> nodes;   // celdas abstractas, ordenadas
+        std::vector<Weight> dist;  // nodes.size()^2: dist[i * k + j] de nodes[i] a nodes[j]
+        // Transiciones (celda propia, celda vecina) con el cluster de la
+        // derecha y con el de abajo
+        std::vector<std::pair<Node, Node>> right, down;
+        // Con diagonales, cruces por la esquina con los clusters de abajo a
+        // la derecha y de abajo a la izquierda
+        std::vector<std::pair<Node, Node>> corner;
+    };
+
+    const GridGraph& grid;
+    int size;                  // lado de un cluster
+    int cluster_rows, cluster_cols;
+    std::vector<Cluster> clusters;
+
+    int cluster_of(Node u) const;
+    int node_index(int c, Node u) const;  // posición de u en clusters[c].nodes, -1 si no es abstracta
+    void find_entrances(int c);
+    void rebuild(int c);
+
+public:
+    double build_seconds = 0.0;
+
+    // Lanza std::runtime_error si cluster_size < 2
+    HpaGrid(const GridGraph& g, int cluster_size = 32);
+
+    // Los costes de cells (cell_cost o aristas de salida) han cambiado en la
+    // malla: recalcula transiciones y distancias de los clusters afectados.
+    // Devuelve cuántos clusters se han recalculado.
+    std::size_t cells_changed(const std::vector<Node>& cells);
+
+    // Mismo formato que astar(): g de cada celda del camino; vacío si no hay
+    std::unordered_map<Node, Weight> find_path(Node source, Node target, Instrument* instr = nullptr,
+                                               std::pmr::memory_resource* mem = nullptr) const;
+
+    int cluster_size() const { return size; }
+    std::size_t num_clusters() const { return clusters.size(); }
+    std::size_t abstract_nodes() const;
+    std::size_t memory_bytes() const;
+};
+
+#endif
@@ -0,0 +1,96 @@
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#include "types.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+// Nivel de instrumentación fijado al compilar (-DINSTRUMENTATION_LEVEL=n):
+//   0 = sin contadores (todo se elimina)
+//   1 = contadores de Instrument (por defecto)
+//   2 = contadores + temporizadores por fase y por nivel de recursión
+#ifndef INSTRUMENTATION_LEVEL
+#define INSTRUMENTATION_LEVEL 1
+#endif
+
+#define INSTR_CONCAT_(a, b) a##b
+#define INSTR_CONCAT(a, b) INSTR_CONCAT_(a, b)
+
+#if INSTRUMENTATION_LEVEL >= 1
+#define INSTR_ADD(instr, field, n) ((instr)->field += (n))
+#define INSTR_HEAP(instr, size) ((instr)->note_heap_size(size))
+#else
+#define INSTR_ADD(instr, field, n) ((void)0)
+#define INSTR_HEAP(instr, size) ((void)0)
+#endif
+
+#if INSTRUMENTATION_LEVEL >= 2
+// Acumula el tiempo del ámbito actual en la fase indicada
+class ScopedPhase {
+private:
+    Instrument* instr;
+    int phase;
+    std::chrono::steady_clock::time_point t0;
+
+public:
+    ScopedPhase(Instrument* in, Phase p)
+        : instr(in), phase((int)p), t0(std::chrono::steady_clock::now()) {}
+    ~ScopedPhase() {
+        instr->phase_seconds[phase] +=
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        instr->phase_calls[phase]++;
+    }
+};
+
+// Igual que ScopedPhase pero por nivel de recursión de bmssp()
+class ScopedLevel {
+private:
+    Instrument* instr;
+    int level;
+    std::chrono::steady_clock::time_point t0;
+
+public:
+    ScopedLevel(Instrument* in, int l)
+        : instr(in), level(l < 0 ? 0 : (l >= MAX_LEVELS ? MAX_LEVELS - 1 : l)),
+          t0(std::chrono::steady_clock::now()) {}
+    ~ScopedLevel() {
+        instr->level_seconds[level] +=
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        instr->level_calls[level]++;
+    }
+};
+
+#define INSTR_PHASE(instr, phase) ScopedPhase INSTR_CONCAT(instr_phase_, __LINE__)(instr, phase)
+#define INSTR_LEVEL(instr, level) ScopedLevel INSTR_CONCAT(instr_level_, __LINE__)(instr, level)
+#else
+#define INSTR_PHASE(instr, phase) ((void)0)
+#define INSTR_LEVEL(instr, level) ((void)0)
+#endif
+
+// Pico de memoria residente del proceso en bytes (0 si no está disponible)
+std::size_t peak_rss_bytes();
+
+// Contadores hardware de una región (Linux perf_event_open); -1 si no hay
+struct PerfSample {
+    long long instructions = -1;
+    long long cache_misses = -1;
+    long long branch_misses = -1;
+};
+
+class PerfCounters {
+private:
+    int fds[3];
+
+public:
+    PerfCounters();
+    ~PerfCounters();
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    bool available() const;
+    void start();
+    PerfSample stop();
+};
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef JPS_H
+#define JPS_H
+
+#include "types.h"
+#include "grid_graph.h"
+#include <cstdint>
+#include <memory_resource>
+#include <unordered_map>
+#include <vector>
+
+// Jump Point Search (Harabor y Grastien, 2011) y JPS+ con distancias de salto
+// precalculadas, para mallas 8-conectadas de coste uniforme: GridGraph con
+// modelo CELL, todas las celdas libres al mismo coste c (paso recto c,
+// diagonal √2·c) y las bloqueadas a infinito. Como en GridGraph se permite
+// cortar esquinas: la diagonal solo exige que la celda de destino esté libre.
+//
+// Devuelven lo mismo que astar(): g de cada nodo del camino, incluidas las
+// celdas intermedias entre puntos de salto; vacío si target no es alcanzable.
+
+// true si grid es 8-conectada, con modelo CELL y un único coste finito
+// (que se deja en cost)
+bool is_uniform_grid(const GridGraph& grid, Weight* cost = nullptr);
+
+// Tabla de JPS+: para cada celda y dirección (orden GridGraph::DR8/DC8),
+// pasos hasta el siguiente punto de salto (> 0) o, si no lo hay antes de un
+// obstáculo o del borde, -(pasos libres) (<= 0)
+struct JumpTable {
+    int rows = 0, cols = 0;
+    std::vector<std::int32_t> dist;  // 8 planos de rows * cols
+    double seconds = 0.0;            // tiempo de construcción
+
+    std::int32_t at(int dir, Node u) const { return dist[(std::size_t)dir * rows * cols + u]; }
+    std::size_t memory_bytes() const { return dist.capacity() * sizeof(std::int32_t); }
+};
+
+// Lanza std::runtime_error si la malla no es uniforme (is_uniform_grid)
+JumpTable build_jump_table(const GridGraph& grid);
+
+// Precondición: is_uniform_grid(grid). Para no recorrer la malla en cada
+// consulta solo se comprueba (con std::runtime_error) que sea 8-conectada
+// con modelo CELL; el coste de paso es grid.min_weight.
+std::unordered_map<Node, Weight> jps(
+    const GridGraph& grid,
+    Node source,
+    Node target,
+    Instrument* instr = nullptr,
+    std::pmr::memory_resource* mem = nullptr
+);
+
+// table debe ser la de build_jump_table(grid)
+std::unordered_map<Node, Weight> jps_plus(
+    const GridGraph& grid,
+    const JumpTable& table,
+    Node source,
+    Node target,
+    Instrument* instr = nullptr,
+    std::pmr::memory_resource* mem = nullptr
+);
+
+#endif
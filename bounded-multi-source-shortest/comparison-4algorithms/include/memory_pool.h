@@ -0,0 +1,43 @@
+#ifndef MEMORY_POOL_H
+#define MEMORY_POOL_H
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <string>
+
+// Memoria de trabajo de las consultas. Los contenedores internos de los
+// algoritmos son std::pmr y toman un memory_resource (nullptr = el recurso
+// por defecto de std::pmr, es decir new/delete).
+
+enum class AllocMode {
+    DEFAULT,  // new/delete
+    POOL,     // std::pmr::unsynchronized_pool_resource reutilizado entre consultas
+    ARENA     // arena de avance (monotonic_buffer_resource) vaciada tras cada consulta
+};
+
+const char* alloc_mode_name(AllocMode mode);
+// "default", "pool" o "arena"; lanza std::runtime_error si no se reconoce
+AllocMode parse_alloc_mode(const std::string& s);
+
+// Un QueryMemory por hilo: ninguno de los recursos es thread-safe
+class QueryMemory {
+private:
+    AllocMode mode;
+    std::unique_ptr<std::byte[]> buffer;  // bloque inicial de la arena
+    std::size_t buffer_bytes;
+    std::unique_ptr<std::pmr::unsynchronized_pool_resource> pool;
+    std::unique_ptr<std::pmr::monotonic_buffer_resource> arena;
+
+public:
+    explicit QueryMemory(AllocMode mode, std::size_t arena_bytes = 64u << 20);
+    QueryMemory(const QueryMemory&) = delete;
+    QueryMemory& operator=(const QueryMemory&) = delete;
+
+    AllocMode alloc_mode() const { return mode; }
+    std::pmr::memory_resource* resource();
+    // Llamar entre consultas, cuando ya no quedan contenedores vivos en el recurso
+    void reset();
+};
+
+#endif
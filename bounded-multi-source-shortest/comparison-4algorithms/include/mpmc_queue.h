@@ -0,0 +1,103 @@
+#ifndef MPMC_QUEUE_H
+#define MPMC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+// Cola acotada multi-productor / multi-consumidor sin cerrojos (Vyukov):
+// cada celda lleva un número de secuencia que dice si está libre para el
+// productor de la vuelta actual o lista para su consumidor, y las dos
+// posiciones avanzan con compare_exchange. try_push / try_pop no bloquean
+// nunca; quien llama decide cómo esperar.
+template <class T>
+class MpmcQueue {
+private:
+    struct Cell {
+        std::atomic<std::size_t> sequence;
+        alignas(T) unsigned char storage[sizeof(T)];
+
+        T* value() { return std::launder(reinterpret_cast<T*>(storage)); }
+    };
+
+    // Productores y consumidores escriben en líneas de caché distintas
+    static constexpr std::size_t LINE = 64;
+
+    std::unique_ptr<Cell[]> cells;
+    std::size_t mask;
+    alignas(LINE) std::atomic<std::size_t> head{0};  // siguiente a extraer
+    alignas(LINE) std::atomic<std::size_t> tail{0};  // siguiente a insertar
+
+public:
+    // capacity: potencia de dos >= 2; lanza std::runtime_error si no lo es
+    explicit MpmcQueue(std::size_t capacity) : cells(new Cell[capacity]), mask(capacity - 1) {
+        if (capacity < 2 || (capacity & (capacity - 1)) != 0) {
+            throw std::runtime_error("MpmcQueue capacity must be a power of two >= 2");
+        }
+        for (std::size_t i = 0; i < capacity; ++i) cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    MpmcQueue(const MpmcQueue&) = delete;
+    MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+    ~MpmcQueue() {
+        T discarded;
+        while (try_pop(discarded)) {}
+    }
+
+    std::size_t capacity() const { return mask + 1; }
+
+    // false si la cola está llena (value queda intacto)
+    bool try_push(T&& value) {
+        std::size_t pos = tail.load(std::memory_order_relaxed);
+        while (true) {
+            Cell& cell = cells[pos & mask];
+            std::size_t seq = cell.sequence.load(std::memory_order_acquire);
+            std::ptrdiff_t diff = (std::ptrdiff_t)seq - (std::ptrdiff_t)pos;
+            if (diff == 0) {
+                if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    new (cell.storage) T(std::move(value));
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // false si la cola está vacía
+    bool try_pop(T& out) {
+        std::size_t pos = head.load(std::memory_order_relaxed);
+        while (true) {
+            Cell& cell = cells[pos & mask];
+            std::size_t seq = cell.sequence.load(std::memory_order_acquire);
+            std::ptrdiff_t diff = (std::ptrdiff_t)seq - (std::ptrdiff_t)(pos + 1);
+            if (diff == 0) {
+                if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    T* v = cell.value();
+                    out = std::move(*v);
+                    v->~T();
+                    cell.sequence.store(pos + mask + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Aproximado con productores o consumidores activos
+    bool empty() const {
+        return head.load(std::memory_order_acquire) >= tail.load(std::memory_order_acquire);
+    }
+};
+
+#endif
@@ -0,0 +1,102 @@
+#ifndef MULTI_AGENT_H
+#define MULTI_AGENT_H
+
+#include "types.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <unordered_map>
+#include <vector>
+
+// Planificador D* Lite para muchos agentes sobre un único grafo mutable. El
+// grafo y sus aristas de entrada (para los predecesores de la búsqueda hacia
+// atrás) se guardan una vez; cada agente solo tiene estado (g, rhs, h
+// memorizada) para los nodos que ha tocado, en un mapa disperso con su propia
+// memoria, y un montículo con borrado perezoso. h(start, u) se calcula al
+// primer uso y se invalida cuando el agente se mueve.
+//
+// Los cambios de coste entran en una cola común; replan_all() los aplica al
+// grafo una sola vez y después replanifica todos los agentes en paralelo en
+// el pool global: cada agente solo revisa los orígenes de aristas cambiadas
+// que ya había tocado.
+
+struct AgentPath {
+    std::vector<Node> nodes;  // start ... goal; vacío si no hay camino
+    Weight cost = 0;          // infinito si no hay camino
+};
+
+class MultiAgentPlanner {
+private:
+    struct State {
+        Weight g, rhs;
+        Weight h = 0;
+        std::uint64_t h_epoch = 0;  // h vale si coincide con Agent::epoch
+        Weight k1 = 0, k2 = 0;      // clave vigente si open
+        bool open = false;
+    };
+
+    struct OpenEntry {
+        Weight k1, k2;
+        Node node;
+        // Orden de montículo de mínimos con std::push_heap
+        bool operator<(const OpenEntry& o) const { return k1 > o.k1 || (k1 == o.k1 && k2 > o.k2); }
+    };
+
+    struct Agent {
+        Node start, goal;
+        Weight km = 0;
+        std::uint64_t epoch = 1;
+        std::unique_ptr<std::pmr::unsynchronized_pool_resource> memory;
+        std::pmr::unordered_map<Node, State> states;
+        std::pmr::vector<OpenEntry> open;
+        AgentPath path;
+        Instrument instr;
+
+        Agent(Node s, Node g);
+    };
+
+    Graph graph;
+    Graph reverse;  // aristas de entrada: reverse[v] = {(u, w) : u -> v}
+    HeuristicFunction heuristic;
+    std::vector<std::unique_ptr<Agent>> agents;
+    std::vector<Edge> pending;
+
+    State& state(Agent& a, Node u);
+    Weight g_of(const Agent& a, Node u) const;
+    void calculate_key(Agent& a, Node u, State& st, Weight& k1, Weight& k2);
+    void update_vertex(Agent& a, Node u);
+    void compute_shortest_path(Agent& a);
+    void extract_path(Agent& a);
+    void replan(Agent& a, const std::vector<Node>& changed_sources);
+
+public:
+    // El grafo pasa a ser del planificador; h(a, b) debe ser consistente
+    MultiAgentPlanner(Graph g, HeuristicFunction h);
+    ~MultiAgentPlanner();
+
+    MultiAgentPlanner(const MultiAgentPlanner&) = delete;
+    MultiAgentPlanner& operator=(const MultiAgentPlanner&) = delete;
+
+    // Nuevo agente; su primer camino se calcula en el siguiente replan_all()
+    int add_agent(Node start, Node goal);
+    // El agente avanza (normalmente al siguiente nodo de su camino)
+    void move_agent(int id, Node start);
+
+    // Coste nuevo de u -> v (infinito = bloqueada); crea la arista si no
+    // existe. Se aplica en el siguiente replan_all().
+    void push_change(const Edge& e) { pending.push_back(e); }
+    void push_changes(const std::vector<Edge>& changes) { pending.insert(pending.end(), changes.begin(), changes.end()); }
+
+    // Aplica los cambios pendientes y replanifica todos los agentes en paralelo
+    void replan_all();
+
+    int num_agents() const { return (int)agents.size(); }
+    const AgentPath& path(int id) const { return agents[id]->path; }
+    const Instrument& instrument(int id) const { return agents[id]->instr; }
+    // Nodos con estado en el agente (crece con lo explorado, no con el grafo)
+    std::size_t agent_state_nodes(int id) const { return agents[id]->states.size(); }
+    const Graph& shared_graph() const { return graph; }
+};
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef PACKED_KEY_H
+#define PACKED_KEY_H
+
+#include "types.h"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+// Entrada de cola de prioridad en 64 bits: los 32 bits altos son la
+// distancia redondeada a float con una codificación que conserva el orden
+// como entero sin signo, y los 32 bajos el nodo. Comparar dos claves es una
+// única comparación de enteros (desempate por id de nodo).
+//
+// El redondeo a float es monótono: d1 <= d2 implica bits(d1) <= bits(d2).
+// Dos distancias distintas pueden compartir bits, así que los usuarios
+// comparan con la distancia exacta guardada aparte y no con la de la clave.
+
+using PackedKey = std::uint64_t;
+
+inline std::uint32_t monotone_bits(Weight d) {
+    float f = (float)d;
+    std::uint32_t b;
+    std::memcpy(&b, &f, sizeof(b));
+    // Positivos: se activa el signo; negativos: se invierten todos los bits
+    return (b & 0x80000000u) ? ~b : (b | 0x80000000u);
+}
+
+inline float monotone_value(std::uint32_t bits) {
+    std::uint32_t b = (bits & 0x80000000u) ? (bits & 0x7fffffffu) : ~bits;
+    float f;
+    std::memcpy(&f, &b, sizeof(f));
+    return f;
+}
+
+// Menor distancia con esos bits: toda d con bits mayores o iguales es >= que
+// ella y toda d con bits menores, estrictamente menor. Es la cota que
+// separa lo ya extraído de lo que queda en una cola de claves empaquetadas;
+// la distancia exacta de la cima no sirve, porque otra entrada con los
+// mismos bits puede tener una distancia exacta menor.
+inline Weight monotone_floor(std::uint32_t bits) {
+    float f = monotone_value(bits);
+    if (std::isnan(f) || f == -std::numeric_limits<float>::infinity()) return f;
+    if (f == 0.0f && !std::signbit(f)) return 0.0;  // -0 va justo antes
+    // El punto medio con el float anterior es exacto en double; según el
+    // redondeo al par, pertenece a f o al anterior
+    double below = std::nextafter(f, -std::numeric_limits<float>::infinity());
+    double mid = below + ((double)f - below) / 2;
+    if (std::isinf(f)) mid = below + std::ldexp(1.0, std::ilogb(below) - 24);
+    return monotone_bits(mid) == bits ? mid : std::nextafter(mid, std::numeric_limits<double>::infinity());
+}
+
+inline PackedKey pack_key(Weight d, Node u) {
+    return ((PackedKey)monotone_bits(d) << 32) | (std::uint32_t)u;
+}
+
+inline std::uint32_t key_bits(PackedKey k) { return (std::uint32_t)(k >> 32); }
+inline Node key_node(PackedKey k) { return (Node)(std::uint32_t)k; }
+inline float key_value(PackedKey k) { return monotone_value(key_bits(k)); }
+
+#endif
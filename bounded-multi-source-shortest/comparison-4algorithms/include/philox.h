@@ -0,0 +1,74 @@
+#ifndef PHILOX_H
+#define PHILOX_H
+
+#include <cstdint>
+
+// Generador contador Philox4x32-10 (Salmon et al., SC'11). Cada par
+// (seed, stream) define una secuencia independiente a la que se accede sin
+// estado compartido, así que cada bloque de trabajo usa su propio stream y
+// el resultado no depende del número de hilos ni del orden de ejecución.
+class Philox4x32 {
+private:
+    uint32_t ctr[4];
+    uint32_t key[2];
+    uint32_t out[4];
+    int idx;
+
+    static void round(uint32_t c[4], const uint32_t k[2]) {
+        uint64_t p0 = (uint64_t)0xD2511F53u * c[0];
+        uint64_t p1 = (uint64_t)0xCD9E8D57u * c[2];
+        uint32_t r0 = (uint32_t)(p1 >> 32) ^ c[1] ^ k[0];
+        uint32_t r1 = (uint32_t)p1;
+        uint32_t r2 = (uint32_t)(p0 >> 32) ^ c[3] ^ k[1];
+        uint32_t r3 = (uint32_t)p0;
+        c[0] = r0; c[1] = r1; c[2] = r2; c[3] = r3;
+    }
+
+    void refill() {
+        uint32_t c[4] = {ctr[0], ctr[1], ctr[2], ctr[3]};
+        uint32_t k[2] = {key[0], key[1]};
+        for (int r = 0; r < 10; ++r) {
+            if (r > 0) { k[0] += 0x9E3779B9u; k[1] += 0xBB67AE85u; }
+            round(c, k);
+        }
+        out[0] = c[0]; out[1] = c[1]; out[2] = c[2]; out[3] = c[3];
+        if (++ctr[0] == 0) ++ctr[1];
+        idx = 0;
+    }
+
+public:
+    Philox4x32(uint64_t seed, uint64_t stream)
+        : ctr{0, 0, (uint32_t)stream, (uint32_t)(stream >> 32)},
+          key{(uint32_t)seed, (uint32_t)(seed >> 32)}, out{0, 0, 0, 0}, idx(4) {}
+
+    uint32_t next_u32() {
+        if (idx == 4) refill();
+        return out[idx++];
+    }
+
+    // Uniforme en [0, 1) con 53 bits de mantisa
+    double uniform01() {
+        uint64_t a = next_u32() >> 5, b = next_u32() >> 6;
+        return (a * 67108864.0 + b) * (1.0 / 9007199254740992.0);
+    }
+
+    double uniform(double lo, double hi) {
+        return lo + (hi - lo) * uniform01();
+    }
+
+    // Entero uniforme en [0, n) sin sesgo (multiplicación de Lemire)
+    uint32_t below(uint32_t n) {
+        uint64_t m = (uint64_t)next_u32() * n;
+        uint32_t low = (uint32_t)m;
+        if (low < n) {
+            uint32_t threshold = (uint32_t)(-n) % n;
+            while (low < threshold) {
+                m = (uint64_t)next_u32() * n;
+                low = (uint32_t)m;
+            }
+        }
+        return (uint32_t)(m >> 32);
+    }
+};
+
+#endif
@@ -0,0 +1,149 @@
+#ifndef QUERY_SERVICE_H
+#define QUERY_SERVICE_H
+
+#include "types.h"
+#include "bmssp.h"
+#include "graph_concept.h"
+#include "memory_pool.h"
+#include "mpmc_queue.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Servicio de consultas concurrentes sobre un grafo inmutable: varios
+// clientes envían (algoritmo, source, target) a una cola MPMC sin cerrojos y
+// un grupo fijo de hilos las resuelve, cada uno con su propia memoria de
+// trabajo (QueryMemory). Los algoritmos solo leen el grafo, así que no hay
+// más sincronización que la cola y los contadores atómicos; un hilo sin
+// trabajo espera un momento activamente y después se duerme hasta el
+// siguiente envío.
+
+enum class QueryAlgorithm { DIJKSTRA, BMSSP, ASTAR, DSTAR_LITE };
+
+const char* query_algorithm_name(QueryAlgorithm algorithm);
+// "dijkstra", "bmssp", "astar" o "dstar_lite"; lanza std::runtime_error si no
+QueryAlgorithm parse_query_algorithm(const std::string& s);
+
+struct QueryRequest {
+    QueryAlgorithm algorithm = QueryAlgorithm::ASTAR;
+    Node source = 0;
+    Node target = 0;
+};
+
+struct QueryResult {
+    QueryRequest request;
+    Weight distance = 0;           // source -> target; infinito si no es alcanzable
+    double queue_seconds = 0.0;    // desde submit hasta que un hilo la toma
+    double service_seconds = 0.0;  // ejecución del algoritmo
+    int worker = -1;
+};
+
+// Se llama en el hilo que resolvió la consulta; debe ser breve. Si lanza, la
+// consulta cuenta en failed y el hilo sigue atendiendo.
+using QueryCallback = std::function<void(const QueryResult&)>;
+
+struct ServiceOptions {
+    int threads = 0;                   // <= 0: std::thread::hardware_concurrency()
+    std::size_t queue_capacity = 1024; // potencia de dos
+    AllocMode alloc = AllocMode::ARENA;
+    BmsspParams bmssp;
+};
+
+// Latencias (submit -> fin) en segundos; percentiles aproximados por un
+// histograma logarítmico (cuatro cubetas por potencia de dos)
+struct ServiceStats {
+    std::size_t submitted = 0, completed = 0, failed = 0, rejected = 0;
+    double elapsed_seconds = 0.0;  // desde la construcción o reset_stats()
+    double throughput = 0.0;       // completed / elapsed_seconds
+    double mean_latency = 0.0, p50_latency = 0.0, p99_latency = 0.0, max_latency = 0.0;
+    double mean_queue = 0.0, mean_service = 0.0;
+};
+
+class QueryService {
+private:
+    using clock = std::chrono::steady_clock;
+
+    struct Job {
+        QueryRequest request;
+        std::promise<QueryResult> promise;  // si no hay callback
+        QueryCallback callback;
+        clock::time_point enqueued;
+    };
+
+    static constexpr int LATENCY_BUCKETS = 160;
+
+    const Graph graph;
+    Predecessors<Graph> preds;  // para D*-lite; se construye con el servicio y los hilos solo lo leen
+    const HeuristicFunction heuristic;
+    const ServiceOptions options;
+    MpmcQueue<Job> queue;
+    std::vector<std::thread> workers;
+    std::atomic<bool> stopping{false};
+    // Hilos dormidos esperando trabajo; los envíos solo toman el cerrojo si
+    // hay alguno
+    std::atomic<int> sleepers{0};
+    std::mutex wake_mutex;
+    std::condition_variable wake;
+
+    std::atomic<std::size_t> submitted{0}, completed{0}, failed{0}, rejected{0};
+    std::atomic<std::uint64_t> latency_ns_sum{0}, queue_ns_sum{0}, service_ns_sum{0}, latency_ns_max{0};
+    std::array<std::atomic<std::uint64_t>, LATENCY_BUCKETS> latency_hist{};
+    std::atomic<std::int64_t> stats_start_ns{0};
+
+    void enqueue(Job&& job);
+    void wake_worker();
+    void worker_loop(int id);
+    void run(Job& job, int id, QueryMemory& memory);
+
+public:
+    // Arranca los hilos; el grafo pasa a ser del servicio
+    QueryService(Graph g, HeuristicFunction h, const ServiceOptions& opt = ServiceOptions());
+    ~QueryService();
+
+    QueryService(const QueryService&) = delete;
+    QueryService& operator=(const QueryService&) = delete;
+
+    // Bloquean (cediendo el procesador) mientras la cola está llena; lanzan
+    // std::runtime_error tras shutdown(). Si el algoritmo lanza, el future
+    // recibe la excepción; con callback solo se cuenta en failed (también si
+    // lanza el propio callback).
+    std::future<QueryResult> submit(const QueryRequest& request);
+    void submit(const QueryRequest& request, QueryCallback callback);
+    std::vector<std::future<QueryResult>> submit_batch(const std::vector<QueryRequest>& requests);
+
+    // No bloquea: false (y cuenta como rechazada) si la cola está llena
+    bool try_submit(const QueryRequest& request, QueryCallback callback);
+
+    // Espera a que terminen todas las consultas enviadas hasta ahora
+    void drain();
+    // Termina las pendientes y para los hilos; idempotente. No debe
+    // solaparse con submit desde otros hilos.
+    void shutdown();
+
+    int num_threads() const { return (int)workers.size(); }
+
+    ServiceStats stats() const;
+    // Llamar sin consultas en curso (por ejemplo tras drain())
+    void reset_stats();
+};
+
+// Registro de consultas: una por línea "algoritmo source target"; líneas
+// vacías y las que empiezan por '#' se ignoran. Lanza std::runtime_error si
+// no se puede abrir o una línea es inválida.
+std::vector<QueryRequest> load_query_log(const std::string& path);
+
+// Reproduce requests a rate consultas por segundo desde un único productor
+// (carga abierta: con la cola llena la consulta se rechaza) o, con rate <= 0,
+// tan rápido como acepte la cola. Espera a que terminen y devuelve las
+// estadísticas de esa pasada (se reinician al empezar).
+ServiceStats replay_queries(QueryService& service, const std::vector<QueryRequest>& requests, double rate);
+
+#endif
@@ -0,0 +1,179 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include "mpmc_queue.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Planificador común de todos los caminos paralelos: hilos fijos con una
+// deque de Chase–Lev cada uno (el dueño apila y desapila por abajo, los demás
+// roban por arriba) y una cola MPMC de inyección para las tareas que llegan
+// desde hilos ajenos. Quien espera un TaskGroup no se bloquea: ejecuta
+// tareas (las suyas o robadas) hasta que el grupo termina, así que con un
+// único hilo (sin trabajadores) todo corre en el que llama.
+
+class ThreadPool;
+class TaskGroup;
+
+namespace pool_detail {
+
+struct Task {
+    void (*invoke)(Task*);  // ejecuta y libera la tarea
+    TaskGroup* group;
+};
+
+// Deque de Chase–Lev (Lê et al., 2013). Solo el dueño llama a push/pop;
+// steal desde cualquier hilo. Los arrays sustituidos al crecer se guardan
+// hasta destruir la deque porque un ladrón puede estar leyéndolos.
+class WorkDeque {
+private:
+    struct Array {
+        std::int64_t capacity;
+        std::unique_ptr<std::atomic<Task*>[]> slots;
+
+        explicit Array(std::int64_t cap) : capacity(cap), slots(new std::atomic<Task*>[cap]) {}
+        Task* get(std::int64_t i) const { return slots[i & (capacity - 1)].load(std::memory_order_relaxed); }
+        void put(std::int64_t i, Task* t) { slots[i & (capacity - 1)].store(t, std::memory_order_relaxed); }
+    };
+
+    alignas(64) std::atomic<std::int64_t> top{0};
+    alignas(64) std::atomic<std::int64_t> bottom{0};
+    std::atomic<Array*> array;
+    std::vector<std::unique_ptr<Array>> arrays;  // vivos y retirados; solo el dueño los toca
+
+public:
+    explicit WorkDeque(std::int64_t capacity = 256);
+
+    void push(Task* t);
+    Task* pop();
+    Task* steal();
+    bool empty() const {
+        return top.load(std::memory_order_relaxed) >= bottom.load(std::memory_order_relaxed);
+    }
+};
+
+}  // namespace pool_detail
+
+struct PoolOptions {
+    int threads = 0;   // paralelismo total, contando al hilo que espera; <= 0: hardware_concurrency()
+    bool pin = false;  // fija el trabajador i a la CPU i + 1 (solo Linux)
+    std::size_t inject_capacity = 4096;  // cola de tareas externas (potencia de dos)
+};
+
+class ThreadPool {
+private:
+    struct Worker {
+        pool_detail::WorkDeque deque;
+        std::thread thread;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;  // threads - 1
+    MpmcQueue<pool_detail::Task*> inject;
+    std::atomic<bool> stopping{false};
+
+    // Trabajadores dormidos: solo se toca el mutex si hay alguno
+    std::mutex sleep_mutex;
+    std::condition_variable wake;
+    std::atomic<int> sleeping{0};
+    std::atomic<std::uint64_t> epoch{0};
+
+    void worker_loop(int index);
+    bool has_work() const;
+    void notify();
+
+    friend class TaskGroup;
+    void submit(pool_detail::Task* task);
+    // Una tarea para el hilo actual: la suya, robada o inyectada; nullptr si no hay
+    pool_detail::Task* find_task();
+
+public:
+    explicit ThreadPool(const PoolOptions& opt = PoolOptions());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Paralelismo total (trabajadores + el hilo que espera)
+    int concurrency() const { return (int)workers.size() + 1; }
+
+    // Pool compartido por todos los caminos paralelos; se crea en el primer
+    // uso con PoolOptions() salvo que antes se llame a configure_global, que
+    // lanza std::runtime_error si ya existe
+    static ThreadPool& global();
+    static void configure_global(const PoolOptions& opt);
+};
+
+// Grupo fork/join: run() lanza una tarea, wait() ayuda a ejecutar hasta que
+// terminan todas y relanza la primera excepción. El destructor espera.
+class TaskGroup {
+private:
+    template <class F>
+    struct FnTask : pool_detail::Task {
+        F fn;
+        explicit FnTask(F&& f) : fn(std::move(f)) {}
+    };
+
+    ThreadPool& pool;
+    std::atomic<std::size_t> pending{0};
+    std::atomic<bool> failed{false};
+    std::exception_ptr error;
+
+    friend class ThreadPool;
+    static void execute(pool_detail::Task* task);
+    void fail(std::exception_ptr e);
+
+public:
+    explicit TaskGroup(ThreadPool& p = ThreadPool::global()) : pool(p) {}
+    ~TaskGroup();
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    template <class F>
+    void run(F f) {
+        auto* task = new FnTask<F>(std::move(f));
+        task->invoke = [](pool_detail::Task* t) {
+            std::unique_ptr<FnTask<F>> self(static_cast<FnTask<F>*>(t));
+            self->fn();
+        };
+        task->group = this;
+        pending.fetch_add(1, std::memory_order_relaxed);
+        pool.submit(task);
+    }
+
+    void wait();
+};
+
+// a() y b() en paralelo; vuelve cuando terminan las dos
+template <class A, class B>
+void fork_join(A&& a, B&& b, ThreadPool& pool = ThreadPool::global()) {
+    TaskGroup group(pool);
+    group.run([&b]() { b(); });
+    a();
+    group.wait();
+}
+
+// f(i) para i en [begin, end): el rango se parte por la mitad hasta grain
+// índices, y las mitades se reparten por robo
+template <class F>
+void parallel_for(std::size_t begin, std::size_t end, std::size_t grain, const F& f,
+                  ThreadPool& pool = ThreadPool::global()) {
+    if (grain == 0) grain = 1;
+    if (end - begin <= grain || pool.concurrency() == 1 || end <= begin) {
+        for (std::size_t i = begin; i < end; ++i) f(i);
+        return;
+    }
+    std::size_t mid = begin + (end - begin) / 2;
+    fork_join([&]() { parallel_for(begin, mid, grain, f, pool); },
+              [&]() { parallel_for(mid, end, grain, f, pool); }, pool);
+}
+
+#endif
@@ -1,12 +1,19 @@
 #ifndef TYPES_H
 #define TYPES_H
 
+#include <cstddef>
 #include <vector>
 #include <unordered_map>
 #include <functional>
 
 using Node = int;
+// -DWEIGHT_FLOAT: pesos de 4 bytes en Graph/Edge. Los núcleos CSR admiten
+// además double y punto fijo en tiempo de ejecución (weight.h).
+#ifdef WEIGHT_FLOAT
+using Weight = float;
+#else
 using Weight = double;
+#endif
 
 struct Edge {
     Node from, to;
@@ -15,13 +22,38 @@ struct Edge {
 
 using Graph = std::unordered_map<Node, std::vector<std::pair<Node, Weight>>>;
 
+// Fases de BMSSP con temporizador propio (ver instrumentation.h)
+enum class Phase { FIND_PIVOTS, BASECASE, D_PULL, BATCH_RELAX, COUNT };
+constexpr int PHASE_COUNT = (int)Phase::COUNT;
+constexpr int MAX_LEVELS = 16;
+
+class BmsspTrace;  // bmssp_trace.h
+
 struct Instrument {
     size_t relaxations = 0;
     size_t heap_ops = 0;
+    size_t settled = 0;      // nodos fijados (extraídos con clave vigente)
+    size_t stale_pops = 0;   // extracciones descartadas por clave obsoleta
+    size_t peak_heap = 0;    // tamaño máximo de la cola de prioridad
+    size_t partial_calls = 0;      // bmssp(): llamadas que acaban por |U| >= k·2^(l·t)
+    size_t fallback_settled = 0;   // bmssp_complete(): nodos cerrados por el Dijkstra final
+    size_t pivot_rounds_parallel = 0;   // find_pivots: rondas en el pool (BmsspParams::parallel)
+    size_t pivot_rounds_bottom_up = 0;  // de ellas, de abajo arriba
+
+    // Solo con INSTRUMENTATION_LEVEL >= 2
+    double phase_seconds[PHASE_COUNT] = {};
+    size_t phase_calls[PHASE_COUNT] = {};
+    double level_seconds[MAX_LEVELS] = {};  // inclusivo: incluye subniveles
+    size_t level_calls[MAX_LEVELS] = {};
+
+    BmsspTrace* trace = nullptr;  // registro de llamadas de bmssp() (opcional)
     
     void reset() {
-        relaxations = 0;
-        heap_ops = 0;
+        *this = Instrument();
+    }
+
+    void note_heap_size(size_t size) {
+        if (size > peak_heap) peak_heap = size;
     }
 };
 
@@ -0,0 +1,65 @@
+#ifndef VALIDATION_H
+#define VALIDATION_H
+
+#include "types.h"
+#include "degree_reduction.h"
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Verificación cruzada de distancias contra Dijkstra como referencia
+
+struct Mismatch {
+    Node node;
+    Weight expected;
+    Weight got;  // infinito si el nodo falta en el resultado
+};
+
+struct ValidationReport {
+    std::string algorithm;
+    std::size_t checked = 0;
+    std::size_t mismatches = 0;
+    std::vector<Mismatch> first;  // primeros nodos erróneos, en orden de id
+
+    bool ok() const { return mismatches == 0; }
+};
+
+struct ValidationOptions {
+    double tolerance = 1e-9;  // error relativo admitido (absoluto si |d| < 1)
+    int max_report = 5;       // nodos erróneos guardados por algoritmo
+    bool bmssp_parallel = false;  // BMSSP con BmsspParams::parallel
+};
+
+bool distances_match(Weight expected, Weight got, double tolerance);
+
+// SSSP: compara todos los nodos de reference (inalcanzable = infinito)
+ValidationReport compare_all(
+    const std::string& algorithm,
+    const std::unordered_map<Node, Weight>& reference,
+    const std::unordered_map<Node, Weight>& candidate,
+    const ValidationOptions& opt = ValidationOptions()
+);
+
+// Punto a punto: compara un único valor
+ValidationReport compare_one(
+    const std::string& algorithm,
+    Node node,
+    Weight expected,
+    Weight got,
+    const ValidationOptions& opt = ValidationOptions()
+);
+
+// Ejecuta Dijkstra, BMSSP (todos los nodos), A* y D*-lite (solo el destino)
+// sobre una consulta y devuelve un informe por algoritmo. Con reduced,
+// además BMSSP sobre el grafo de grado reducido ("bmssp_reduced").
+std::vector<ValidationReport> validate_query(
+    const Graph& graph,
+    Node source,
+    Node target,
+    const HeuristicFunction& heuristic,
+    const ValidationOptions& opt = ValidationOptions(),
+    const DegreeReduction* reduced = nullptr
+);
+
+#endif
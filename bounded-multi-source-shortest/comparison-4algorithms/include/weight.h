@@ -0,0 +1,67 @@
+#ifndef WEIGHT_H
+#define WEIGHT_H
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+// Tipos de peso para los núcleos CSR plantillados: float, double y punto
+// fijo de 32 bits. Un peso en punto fijo vale raw / scale; UINT32_MAX es el
+// infinito y las sumas saturan en él.
+
+using Fixed32 = std::uint32_t;
+
+template <class W>
+struct WeightTraits;
+
+template <>
+struct WeightTraits<double> {
+    static constexpr const char* name = "double";
+    static double inf() { return std::numeric_limits<double>::infinity(); }
+    static double add(double a, double b) { return a + b; }
+    static double to_double(double w, double) { return w; }
+    static double from_double(double x, double) { return x; }
+    // Error relativo de una suma de pesos
+    static double epsilon() { return std::numeric_limits<double>::epsilon(); }
+};
+
+template <>
+struct WeightTraits<float> {
+    static constexpr const char* name = "float";
+    static float inf() { return std::numeric_limits<float>::infinity(); }
+    static float add(float a, float b) { return a + b; }
+    static double to_double(float w, double) { return w; }
+    static float from_double(double x, double) {
+        if (std::isfinite(x) && std::fabs(x) > std::numeric_limits<float>::max()) {
+            throw std::overflow_error("weight out of float range: " + std::to_string(x));
+        }
+        return (float)x;
+    }
+    static double epsilon() { return std::numeric_limits<float>::epsilon(); }
+};
+
+template <>
+struct WeightTraits<Fixed32> {
+    static constexpr const char* name = "fixed32";
+    static Fixed32 inf() { return std::numeric_limits<Fixed32>::max(); }
+    static Fixed32 add(Fixed32 a, Fixed32 b) {
+        std::uint64_t s = (std::uint64_t)a + b;
+        return s >= inf() ? inf() : (Fixed32)s;
+    }
+    static double to_double(Fixed32 w, double scale) {
+        return w == inf() ? std::numeric_limits<double>::infinity() : w / scale;
+    }
+    // Lanza si el peso es negativo o no cabe por debajo del infinito
+    static Fixed32 from_double(double x, double scale) {
+        if (std::isinf(x) && x > 0) return inf();
+        double r = std::nearbyint(x * scale);
+        if (!(r >= 0.0)) throw std::domain_error("negative or NaN weight in fixed32: " + std::to_string(x));
+        if (r >= (double)inf()) throw std::overflow_error("weight out of fixed32 range: " + std::to_string(x));
+        return (Fixed32)r;
+    }
+    static double epsilon() { return 0.0; }  // sumas exactas hasta saturar
+};
+
+#endif
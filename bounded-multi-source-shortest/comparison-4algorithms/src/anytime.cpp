@@ -0,0 +1,331 @@
+#include "./../include/anytime.h"
+#include "./../include/instrumentation.h"
+#include "./../include/packed_key.h"
+#include "./../include/graph_concept.h"
+#include "./../include/csr_graph.h"
+#include "./../include/grid_graph.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <queue>
+
+namespace {
+
+const Weight INF = std::numeric_limits<Weight>::infinity();
+
+// Estado de ARA* por nodo; h se memoriza al primer uso (< 0 sin calcular)
+struct AraState {
+    Weight g = INF;
+    Weight f = INF;      // clave vigente si open
+    Weight h = -1.0;
+    Node parent = -1;
+    std::uint32_t closed = 0;  // iteración en que se expandió (CLOSED)
+    bool open = false;
+    bool incons = false;       // en la lista INCONS
+};
+
+template <class G>
+class AraSearch {
+private:
+    using OpenQueue = std::priority_queue<PackedKey, std::pmr::vector<PackedKey>, std::greater<PackedKey>>;
+
+    const G& graph;
+    Node source, target;
+    const HeuristicFunction& heuristic;
+    Instrument* instr;
+    std::pmr::memory_resource* mem;
+
+    NodeValues<G, AraState> states;
+    OpenQueue open;
+    std::pmr::vector<Node> incons;
+    std::uint32_t iteration = 1;
+    double epsilon = 1.0;
+
+    Weight h(AraState& st, Node u) {
+        if (st.h < 0) st.h = heuristic(u, target);
+        return st.h;
+    }
+
+    void push(AraState& st, Node u) {
+        st.f = st.g + (Weight)epsilon * h(st, u);
+        st.open = true;
+        open.push(pack_key(st.f, u));
+        INSTR_ADD(instr, heap_ops, 1);
+        INSTR_HEAP(instr, open.size());
+    }
+
+    bool valid(PackedKey k) const {
+        const AraState st = states.get(key_node(k));
+        return st.open && key_bits(k) == monotone_bits(st.f);
+    }
+
+    // ImprovePath: expande mientras alguna clave abierta sea menor que
+    // fvalue(target). false si el presupuesto se agota antes.
+    bool improve_path(BudgetMeter& meter) {
+        while (!open.empty()) {
+            PackedKey k = open.top();
+            const AraState top = states.get(key_node(k));
+            if (!top.open || key_bits(k) != monotone_bits(top.f)) {
+                open.pop();
+                INSTR_ADD(instr, stale_pops, 1);
+                continue;
+            }
+            // fvalue(target) = g(target): h(target, target) = 0
+            if (top.f >= states.get(target).g) break;
+            if (!meter.expand()) return false;
+            open.pop();
+            INSTR_ADD(instr, heap_ops, 1);
+            INSTR_ADD(instr, settled, 1);
+
+            const Node u = key_node(k);
+            AraState& su = states[u];
+            su.open = false;
+            su.closed = iteration;
+            const Weight g_u = su.g;
+            for_each_out(graph, u, [&](Node v, Weight w) {
+                INSTR_ADD(instr, relaxations, 1);
+                Weight tentative = g_u + w;
+                if (!(tentative < states.get(v).g)) return;
+                AraState& sv = states[v];
+                sv.g = tentative;
+                sv.parent = u;
+                if (sv.closed != iteration) {
+                    push(sv, v);
+                } else if (!sv.incons) {
+                    sv.incons = true;
+                    incons.push_back(v);
+                }
+            });
+        }
+        return true;
+    }
+
+    // min(epsilon, g(target) / min_{OPEN ∪ INCONS} (g + h))
+    double bound() {
+        Weight lower = INF;
+        auto consider = [&](Node u) {
+            AraState& st = states[u];
+            lower = std::min(lower, st.g + h(st, u));
+        };
+        std::pmr::vector<PackedKey> keys(mem);
+        while (!open.empty()) {
+            PackedKey k = open.top();
+            open.pop();
+            if (!valid(k)) continue;
+            keys.push_back(k);
+            consider(key_node(k));
+        }
+        for (Node u : incons) consider(u);
+        // Se vuelven a encolar las vigentes: el montículo queda sin obsoletas
+        for (PackedKey k : keys) open.push(k);
+        const Weight g_goal = states.get(target).g;
+        if (g_goal <= 0 || lower == INF) return 1.0;  // nada abierto puede mejorarla
+        if (lower <= 0) return epsilon;
+        return std::max(1.0, std::min(epsilon, (double)(g_goal / lower)));
+    }
+
+    // Nueva iteración con epsilon menor: OPEN ∪ INCONS con claves nuevas, CLOSED vacío
+    void reopen() {
+        std::pmr::vector<Node> nodes(mem);
+        while (!open.empty()) {
+            PackedKey k = open.top();
+            open.pop();
+            if (!valid(k)) continue;
+            states[key_node(k)].open = false;
+            nodes.push_back(key_node(k));
+        }
+        for (Node u : incons) {
+            AraState& st = states[u];
+            st.incons = false;
+            if (!st.open) nodes.push_back(u);
+        }
+        incons.clear();
+        iteration++;
+        for (Node u : nodes) {
+            AraState& st = states[u];
+            if (!st.open) push(st, u);
+        }
+    }
+
+    // Camino por los padres. Su coste puede ser menor que g(target): un
+    // antecesor mejorado después no propaga su g hasta target.
+    void extract(AnytimeSolution& sol) {
+        sol.path.clear();
+        sol.cost = states.get(target).g;
+        if (sol.cost == INF) return;
+        for (Node u = target;; u = states.get(u).parent) {
+            sol.path.push_back(u);
+            if (u == source) break;
+        }
+        std::reverse(sol.path.begin(), sol.path.end());
+        sol.cost = 0;
+        for (std::size_t i = 0; i + 1 < sol.path.size(); ++i) {
+            Weight step = INF;
+            for_each_out(graph, sol.path[i], [&](Node v, Weight w) {
+                if (v == sol.path[i + 1]) step = std::min(step, w);
+            });
+            sol.cost += step;
+        }
+    }
+
+public:
+    AraSearch(const G& g, Node s, Node t, const HeuristicFunction& hf, Instrument* in, std::pmr::memory_resource* m)
+        : graph(g), source(s), target(t), heuristic(hf), instr(in), mem(m),
+          states(g, AraState(), m), open(std::greater<PackedKey>(), std::pmr::vector<PackedKey>(m)),
+          incons(m) {}
+
+    AnytimeResult run(const AnytimeOptions& opt, const SolutionCallback& on_solution) {
+        BudgetMeter meter(opt.budget);
+        AnytimeResult result;
+        result.best.cost = INF;
+        const double eps_final = std::max(1.0, opt.epsilon_final);
+        epsilon = std::max(eps_final, opt.epsilon_start);
+
+        AraState& s = states[source];
+        s.g = 0;
+        push(s, source);
+
+        while (true) {
+            if (!improve_path(meter)) {
+                result.exhausted = true;
+                break;
+            }
+            if (states.get(target).g == INF) break;  // no hay camino
+
+            AnytimeSolution sol;
+            extract(sol);
+            sol.epsilon = epsilon;
+            sol.bound = bound();
+            sol.seconds = meter.seconds();
+            sol.expansions = meter.expansions();
+            if (sol.cost < result.best.cost || sol.bound < result.best.bound) {
+                result.best = sol;
+                result.solutions++;
+                if (on_solution) on_solution(result.best);
+            }
+            if (epsilon <= eps_final || sol.bound <= eps_final) break;
+            epsilon = std::max(eps_final, epsilon - std::max(opt.epsilon_step, 1e-6));
+            reopen();
+        }
+        return result;
+    }
+};
+
+}  // namespace
+
+template <class G>
+AnytimeResult ara_star(
+    const G& graph,
+    Node source,
+    Node target,
+    const HeuristicFunction& heuristic,
+    const AnytimeOptions& opt,
+    const SolutionCallback& on_solution,
+    Instrument* instr,
+    std::pmr::memory_resource* mem) {
+
+    Instrument local_instr;
+    if (!instr) instr = &local_instr;
+    if (!mem) mem = std::pmr::get_default_resource();
+    AraSearch<G> search(graph, source, target, heuristic, instr, mem);
+    return search.run(opt, on_solution);
+}
+
+template <class G>
+AnytimeResult weighted_astar(
+    const G& graph,
+    Node source,
+    Node target,
+    const HeuristicFunction& heuristic,
+    double epsilon,
+    const AnytimeBudget& budget,
+    Instrument* instr,
+    std::pmr::memory_resource* mem) {
+
+    // Primera iteración de ARA*: misma cota epsilon sin reabrir nodos
+    AnytimeOptions opt;
+    opt.epsilon_start = opt.epsilon_final = std::max(1.0, epsilon);
+    opt.budget = budget;
+    return ara_star(graph, source, target, heuristic, opt, nullptr, instr, mem);
+}
+
+template AnytimeResult ara_star<Graph>(const Graph&, Node, Node, const HeuristicFunction&, const AnytimeOptions&,
+                                       const SolutionCallback&, Instrument*, std::pmr::memory_resource*);
+template AnytimeResult ara_star<CsrGraph>(const CsrGraph&, Node, Node, const HeuristicFunction&,
+                                          const AnytimeOptions&, const SolutionCallback&, Instrument*,
+                                          std::pmr::memory_resource*);
+template AnytimeResult ara_star<GridGraph>(const GridGraph&, Node, Node, const HeuristicFunction&,
+                                           const AnytimeOptions&, const SolutionCallback&, Instrument*,
+                                           std::pmr::memory_resource*);
+template AnytimeResult weighted_astar<Graph>(const Graph&, Node, Node, const HeuristicFunction&, double,
+                                             const AnytimeBudget&, Instrument*, std::pmr::memory_resource*);
+template AnytimeResult weighted_astar<CsrGraph>(const CsrGraph&, Node, Node, const HeuristicFunction&, double,
+                                                const AnytimeBudget&, Instrument*, std::pmr::memory_resource*);
+template AnytimeResult weighted_astar<GridGraph>(const GridGraph&, Node, Node, const HeuristicFunction&, double,
+                                                 const AnytimeBudget&, Instrument*, std::pmr::memory_resource*);
+
+// ---------------------------------------------------------------------------
+// Anytime D*
+
+template <class G>
+BasicAnytimeDStar<G>::BasicAnytimeDStar(const G& g, Predecessors<G>& preds, Node s, Node goal,
+                                        const HeuristicFunction& h, const AnytimeOptions& opt, Instrument* instr,
+                                        std::pmr::memory_resource* mem)
+    : engine(g, preds, s, goal, h, instr, mem), options(opt),
+      epsilon(std::max(std::max(1.0, opt.epsilon_final), opt.epsilon_start)) {
+    last.cost = INF;
+    engine.set_epsilon(epsilon);
+}
+
+template <class G>
+AnytimeResult BasicAnytimeDStar<G>::improve(const SolutionCallback& on_solution) {
+    BudgetMeter meter(options.budget);
+    AnytimeResult result;
+    result.best = last;
+    if (converged) return result;
+    const double eps_final = std::max(1.0, options.epsilon_final);
+    while (true) {
+        // Si el presupuesto se agota, la siguiente llamada sigue esta iteración
+        if (!engine.compute_shortest_path(&meter)) {
+            result.exhausted = true;
+            break;
+        }
+        AnytimeSolution sol;
+        if (!engine.path(sol.path, sol.cost)) {
+            sol.path.clear();
+            sol.cost = INF;
+        }
+        sol.epsilon = sol.bound = epsilon;
+        sol.seconds = meter.seconds();
+        sol.expansions = meter.expansions();
+        last = sol;
+        result.best = sol;
+        result.solutions++;
+        if (on_solution && sol.cost < INF) on_solution(sol);
+        if (epsilon <= eps_final) {
+            converged = true;
+            break;
+        }
+        epsilon = std::max(eps_final, epsilon - std::max(options.epsilon_step, 1e-6));
+        engine.set_epsilon(epsilon);
+    }
+    return result;
+}
+
+template <class G>
+void BasicAnytimeDStar<G>::update_graph(const std::vector<Edge>& changed_edges) {
+    engine.update_graph(changed_edges);
+    epsilon = std::max(std::max(1.0, options.epsilon_final), options.epsilon_start);
+    engine.set_epsilon(epsilon);
+    converged = false;
+}
+
+template <class G>
+void BasicAnytimeDStar<G>::move_start(Node s) {
+    engine.move_start(s);
+    converged = false;
+}
+
+template class BasicAnytimeDStar<Graph>;
+template class BasicAnytimeDStar<CsrGraph>;
+template class BasicAnytimeDStar<GridGraph>;
@@ -1,104 +1,122 @@
 #include "./../include/astar.h"
+#include "./../include/instrumentation.h"
+#include "./../include/packed_key.h"
+#include "./../include/graph_concept.h"
+#include "./../include/csr_graph.h"
+#include "./../include/grid_graph.h"
 #include <queue>
 #include <limits>
 #include <cmath>
-#include <unordered_set>
 
+template <class G>
 std::unordered_map<Node, Weight> astar(
-    const Graph& graph, 
+    const G& graph, 
     Node source, 
     Node target,
     const HeuristicFunction& heuristic,
-    Instrument* instr) {
+    Instrument* instr,
+    std::pmr::memory_resource* mem,
+    CancelToken* cancel) {
     
     Instrument local_instr;
     if (!instr) instr = &local_instr;
+    if (!mem) mem = std::pmr::get_default_resource();
     
-    // Optimización: reservar espacio para evitar reallocaciones
-    std::unordered_map<Node, Weight> g_cost;
-    std::unordered_map<Node, Weight> f_cost;
-    std::unordered_map<Node, Node> parent;
-    
-    g_cost.reserve(graph.size());
-    f_cost.reserve(graph.size());
-    parent.reserve(graph.size());
-    
-    // Inicializar costos
-    for (const auto& [node, _] : graph) {
-        g_cost[node] = std::numeric_limits<Weight>::infinity();
-        f_cost[node] = std::numeric_limits<Weight>::infinity();
-    }
+    // Vectores densos en grafos indexados; en Graph hash disperso: sin pasada
+    // inicial por el grafo y memoria proporcional a los nodos alcanzados
+    const Weight INF = std::numeric_limits<Weight>::infinity();
+    NodeValues<G, Weight> g_cost(graph, INF, mem);
+    NodeValues<G, Weight> f_cost(graph, INF, mem);
+    NodeValues<G, Node> parent(graph, source, mem);  // parent[source] = source
     
     g_cost[source] = 0.0;
     f_cost[source] = heuristic(source, target);
     
-    // Usar priority_queue con comparador personalizado para mejor rendimiento
-    std::priority_queue<AStarNode, std::vector<AStarNode>, std::greater<AStarNode>> open_list;
-    std::unordered_set<Node> closed_set;
-    std::unordered_set<Node> open_set;  // Para verificación rápida
+    // Claves empaquetadas (f, nodo). Una mejora de g vuelve a encolar el nodo
+    // aunque ya esté abierto o cerrado; las entradas con f distinto de
+    // f_cost[u] se descartan al salir.
+    std::priority_queue<PackedKey, std::pmr::vector<PackedKey>, std::greater<PackedKey>> open_list{
+        std::greater<PackedKey>(), std::pmr::vector<PackedKey>(mem)};
+    
+    open_list.push(pack_key(f_cost[source], source));
+    INSTR_ADD(instr, heap_ops, 1);
     
-    open_list.push(AStarNode(source, g_cost[source], f_cost[source]));
-    open_set.insert(source);
-    instr->heap_ops++;
+    // f exacta de target; la búsqueda termina cuando ninguna clave abierta
+    // puede mejorarla (bits mayores => f exacta mayor por redondeo monótono)
+    Weight f_target = (source == target) ? f_cost[source] : INF;
     
+    CancelPoll poll(cancel);
+    std::int64_t work = 1;  // extracción y aristas de la anterior
+    bool stopped = false;
     while (!open_list.empty()) {
-        AStarNode current = open_list.top();
+        if (poll.stop(work)) {
+            stopped = true;
+            break;
+        }
+        work = 1;
+        PackedKey key = open_list.top();
+        if (key_bits(key) > monotone_bits(f_target)) break;
         open_list.pop();
-        instr->heap_ops++;
+        INSTR_ADD(instr, heap_ops, 1);
         
-        Node u = current.node;
+        Node u = key_node(key);
+        if (key_bits(key) > monotone_bits(f_cost.get(u))) {
+            INSTR_ADD(instr, stale_pops, 1);
+            continue;
+        }
+        INSTR_ADD(instr, settled, 1);
         
-        if (u == target) {
-            // Reconstruir camino y devolver distancias
-            std::unordered_map<Node, Weight> dist;
-            dist.reserve(graph.size());
-            dist[target] = g_cost[target];
+        Weight g_u = g_cost.get(u);
+        for_each_out(graph, u, [&](Node v, Weight w) {
+            INSTR_ADD(instr, relaxations, 1);
+            ++work;
+            Weight tentative_g = g_u + w;
             
-            Node curr = target;
-            while (parent.find(curr) != parent.end()) {
-                curr = parent[curr];
-                dist[curr] = g_cost[curr];
+            if (tentative_g < g_cost.get(v)) {
+                parent[v] = u;
+                g_cost[v] = tentative_g;
+                Weight f = tentative_g + heuristic(v, target);
+                f_cost[v] = f;
+                if (v == target) f_target = f;
+                open_list.push(pack_key(f, v));
+                INSTR_ADD(instr, heap_ops, 1);
+                INSTR_HEAP(instr, open_list.size());
             }
-            
-            return dist;
-        }
+        });
+    }
+    
+    if (std::isfinite(g_cost.get(target))) {
+        // Reconstruir camino y devolver distancias
+        std::unordered_map<Node, Weight> dist;
+        dist[target] = g_cost[target];
         
-        if (closed_set.find(u) != closed_set.end()) {
-            continue;
+        Node curr = target;
+        while (curr != source) {
+            curr = parent[curr];
+            dist[curr] = g_cost[curr];
         }
         
-        closed_set.insert(u);
-        open_set.erase(u);
-        
-        if (graph.find(u) != graph.end()) {
-            for (const auto& [v, w] : graph.at(u)) {
-                if (closed_set.find(v) != closed_set.end()) {
-                    continue;
-                }
-                
-                instr->relaxations++;
-                Weight tentative_g = g_cost[u] + w;
-                
-                if (tentative_g < g_cost[v]) {
-                    parent[v] = u;
-                    g_cost[v] = tentative_g;
-                    f_cost[v] = g_cost[v] + heuristic(v, target);
-                    
-                    // Solo agregar si no está ya en open_set
-                    if (open_set.find(v) == open_set.end()) {
-                        open_list.push(AStarNode(v, g_cost[v], f_cost[v]));
-                        open_set.insert(v);
-                        instr->heap_ops++;
-                    }
-                }
-            }
-        }
+        return dist;
     }
     
-    // Si no se encontró camino, devolver distancias parciales
-    return g_cost;
+    // Si no se encontró camino, devolver distancias parciales (nada si se
+    // interrumpió: recorrer el grafo entero no cabe en el plazo)
+    std::unordered_map<Node, Weight> dist;
+    if (stopped) return dist;
+    for_each_node(graph, [&](Node u) { dist[u] = g_cost.get(u); });
+    return dist;
 }
 
+template std::unordered_map<Node, Weight> astar<Graph>(
+    const Graph&, Node, Node, const HeuristicFunction&, Instrument*, std::pmr::memory_resource*,
+    CancelToken*);
+template std::unordered_map<Node, Weight> astar<CsrGraph>(
+    const CsrGraph&, Node, Node, const HeuristicFunction&, Instrument*, std::pmr::memory_resource*,
+    CancelToken*);
+template std::unordered_map<Node, Weight> astar<GridGraph>(
+    const GridGraph&, Node, Node, const HeuristicFunction&, Instrument*, std::pmr::memory_resource*,
+    CancelToken*);
+
 Weight euclidean_heuristic(Node a, Node b) {
     // Heurística simple basada en diferencia de IDs
     // En un grafo real, esto sería la distancia euclidiana real
@@ -0,0 +1,195 @@
+#include "./../include/benchmark.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+
+double z_for(double confidence) {
+    if (confidence >= 0.99) return 2.576;
+    if (confidence >= 0.95) return 1.960;
+    return 1.645;
+}
+
+// IC de la mediana sin suponer distribución: rangos binomiales n/2 ± z·√n/2
+void median_ci(const std::vector<double>& sorted, double z, double& lo, double& hi) {
+    std::size_t n = sorted.size();
+    if (n == 0) { lo = hi = 0.0; return; }
+    double half = z * std::sqrt((double)n) / 2.0;
+    long long j = (long long)std::floor(n / 2.0 - half);
+    long long k = (long long)std::ceil(n / 2.0 + half);
+    j = std::max(0LL, std::min((long long)n - 1, j));
+    k = std::max(0LL, std::min((long long)n - 1, k));
+    lo = sorted[j];
+    hi = sorted[k];
+}
+
+std::string json_escape(const std::string& s) {
+    std::string out;
+    for (char c : s) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out;
+}
+
+}  // namespace
+
+double percentile_sorted(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    double pos = std::max(0.0, std::min(100.0, p)) / 100.0 * (sorted.size() - 1);
+    std::size_t i = (std::size_t)pos;
+    if (i + 1 >= sorted.size()) return sorted.back();
+    double frac = pos - i;
+    return sorted[i] + frac * (sorted[i + 1] - sorted[i]);
+}
+
+BenchStats summarize(std::vector<double> samples, double confidence) {
+    BenchStats st;
+    st.samples = std::move(samples);
+    st.reps = (int)st.samples.size();
+    if (st.samples.empty()) return st;
+
+    std::vector<double> sorted = st.samples;
+    std::sort(sorted.begin(), sorted.end());
+    st.min = sorted.front();
+    st.max = sorted.back();
+    st.median = percentile_sorted(sorted, 50.0);
+    st.p90 = percentile_sorted(sorted, 90.0);
+    st.p99 = percentile_sorted(sorted, 99.0);
+
+    double acc = 0.0;
+    for (double x : sorted) acc += x;
+    st.mean = acc / sorted.size();
+    double var = 0.0;
+    for (double x : sorted) var += (x - st.mean) * (x - st.mean);
+    st.stddev = sorted.size() > 1 ? std::sqrt(var / (sorted.size() - 1)) : 0.0;
+
+    median_ci(sorted, z_for(confidence), st.ci_low, st.ci_high);
+    return st;
+}
+
+bool pin_current_thread(int cpu) {
+#ifdef __linux__
+    if (cpu < 0) return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+void flush_caches(std::size_t bytes) {
+    static std::vector<std::uint64_t> buffer;
+    std::size_t words = bytes / sizeof(std::uint64_t);
+    if (buffer.size() < words) buffer.resize(words, 1);
+    volatile std::uint64_t sink = 0;
+    std::uint64_t acc = 0;
+    for (std::size_t i = 0; i < words; i += 8) {  // una palabra por línea de 64 B
+        buffer[i] += acc;
+        acc += buffer[i];
+    }
+    sink = acc;
+    (void)sink;
+}
+
+BenchStats measure(const std::function<void()>& body, const HarnessOptions& opt,
+                   const std::function<void()>& setup) {
+    using clock = std::chrono::steady_clock;
+    if (opt.pin_cpu >= 0) pin_current_thread(opt.pin_cpu);
+
+    for (int i = 0; i < opt.warmup; ++i) {
+        if (setup) setup();
+        body();
+    }
+
+    std::vector<double> samples;
+    samples.reserve(std::max(1, opt.min_reps));
+    double z = z_for(opt.confidence);
+    bool converged = false;
+    auto start = clock::now();
+
+    int max_reps = std::max(1, std::max(opt.min_reps, opt.max_reps));
+    for (int rep = 0; rep < max_reps; ++rep) {
+        if (setup) setup();
+        if (opt.flush_cache) flush_caches(opt.flush_bytes);
+
+        auto t0 = clock::now();
+        body();
+        auto t1 = clock::now();
+        samples.push_back(std::chrono::duration<double>(t1 - t0).count());
+
+        if ((int)samples.size() >= opt.min_reps) {
+            std::vector<double> sorted = samples;
+            std::sort(sorted.begin(), sorted.end());
+            double lo, hi;
+            median_ci(sorted, z, lo, hi);
+            double med = percentile_sorted(sorted, 50.0);
+            if (med > 0.0 && 0.5 * (hi - lo) / med <= opt.ci_target) {
+                converged = true;
+                break;
+            }
+        }
+        if (std::chrono::duration<double>(clock::now() - start).count() > opt.max_seconds &&
+            (int)samples.size() >= std::max(1, std::min(opt.min_reps, 3))) {
+            break;
+        }
+    }
+
+    BenchStats st = summarize(std::move(samples), opt.confidence);
+    st.converged = converged;
+    return st;
+}
+
+void write_bench_csv(std::ostream& os, const std::vector<BenchRecord>& records) {
+    auto old_precision = os.precision(9);
+    os << "label";
+    if (!records.empty()) {
+        for (const auto& [key, _] : records.front().fields) os << "," << key;
+    }
+    os << ",reps,converged,min,median,p90,p99,max,mean,stddev,ci_low,ci_high\n";
+    for (const auto& r : records) {
+        const BenchStats& s = r.stats;
+        os << r.label;
+        for (const auto& [_, value] : r.fields) os << "," << value;
+        os << "," << s.reps << "," << (s.converged ? 1 : 0)
+           << "," << s.min << "," << s.median << "," << s.p90 << "," << s.p99 << "," << s.max
+           << "," << s.mean << "," << s.stddev << "," << s.ci_low << "," << s.ci_high << "\n";
+    }
+    os.precision(old_precision);
+}
+
+void write_bench_json(std::ostream& os, const std::vector<BenchRecord>& records) {
+    auto old_precision = os.precision(9);
+    os << "[\n";
+    for (std::size_t i = 0; i < records.size(); ++i) {
+        const BenchRecord& r = records[i];
+        const BenchStats& s = r.stats;
+        os << "  {\"label\": \"" << json_escape(r.label) << "\"";
+        for (const auto& [key, value] : r.fields) {
+            os << ", \"" << json_escape(key) << "\": \"" << json_escape(value) << "\"";
+        }
+        os << ", \"reps\": " << s.reps << ", \"converged\": " << (s.converged ? "true" : "false")
+           << ", \"min\": " << s.min << ", \"median\": " << s.median
+           << ", \"p90\": " << s.p90 << ", \"p99\": " << s.p99 << ", \"max\": " << s.max
+           << ", \"mean\": " << s.mean << ", \"stddev\": " << s.stddev
+           << ", \"ci_low\": " << s.ci_low << ", \"ci_high\": " << s.ci_high
+           << ", \"samples\": [";
+        for (std::size_t j = 0; j < s.samples.size(); ++j) {
+            if (j) os << ", ";
+            os << s.samples[j];
+        }
+        os << "]}" << (i + 1 < records.size() ? "," : "") << "\n";
+    }
+    os << "]\n";
+    os.precision(old_precision);
+}
@@ -1,269 +1,1120 @@
 #include "./../include/bmssp.h"
 #include "./../include/data_structure_d.h"
+#include "./../include/instrumentation.h"
+#include "./../include/bmssp_trace.h"
+#include "./../include/packed_key.h"
+#include "./../include/thread_pool.h"
 #include <algorithm>
-#include <queue>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
 #include <limits>
 #include <cmath>
+#include <memory>
+#include <memory_resource>
+#include <optional>
 
-std::pair<std::unordered_set<Node>, std::unordered_set<Node>> find_pivots(
+namespace {
+
+using NodeSet = std::pmr::unordered_set<Node>;
+using NodeVec = std::pmr::vector<Node>;
+
+// Conjunto de nodos como rango contiguo (equivalente a std::span en C++17)
+struct NodeSpan {
+    const Node* data = nullptr;
+    size_t size = 0;
+
+    const Node* begin() const { return data; }
+    const Node* end() const { return data + size; }
+};
+
+// Rondas de find_pivots en paralelo sobre el pool global. Cada ronda elige
+// dirección como en el BFS de Beamer: de arriba abajo (cada trozo del frente
+// relaja sus aristas de salida y deja en su propio buffer solo las que
+// mejoran, que luego se aplican en orden) o, si las aristas del frente pesan
+// más que recorrer el grafo entero, de abajo arriba (cada nodo busca entre
+// sus aristas de entrada la mejor desde el frente y escribe su propia
+// distancia, sin carreras). Ambas son rondas de Jacobi: usan las distancias
+// del frente al empezar la ronda, así que W cumple lo mismo que en la versión
+// secuencial aunque el orden de relajación cambie.
+//
+// Necesita ids densos en [0, bound) y que dist tenga todos los nodos (como
+// al llamar a bmssp); si los ids no lo son, usable() es false. Un mapa de
+// bits atómico marca los nodos de W para consultarlo sin tocar el conjunto.
+class ParallelPivots {
+private:
+    struct Candidate {
+        Node v, u;
+        Weight d;
+        bool applied;  // de abajo arriba: dist[v] ya escrita
+    };
+
+    static constexpr size_t FRONT_CHUNK = 256;    // nodos del frente por trozo
+    static constexpr size_t NODE_CHUNK = 1 << 14; // ids por trozo de abajo arriba
+    static constexpr size_t BOTTOM_UP_RATIO = 16; // aristas del frente * ratio > n + m
+
+    const Graph& graph;
+    ThreadPool& pool;
+    size_t bound = 0, edges = 0;
+    bool dense = false;
+
+    std::unique_ptr<std::atomic<std::uint64_t>[]> in_w;
+    std::vector<std::uint32_t> out_degree;
+    std::vector<Weight> front_dist;  // abajo arriba: distancia de los nodos del frente, si no infinito
+    // Aristas de entrada en CSR, construidas la primera vez que hacen falta
+    std::vector<size_t> rev_offset;
+    std::vector<Node> rev_source;
+    std::vector<Weight> rev_weight;
+
+    std::vector<std::vector<Candidate>> buffers;
+    std::vector<size_t> relaxed;
+
+    void build_reverse() {
+        if (!rev_offset.empty()) return;
+        rev_offset.assign(bound + 1, 0);
+        for (const auto& [u, adj] : graph) {
+            for (const auto& [v, w] : adj) rev_offset[v + 1]++;
+        }
+        for (size_t i = 0; i < bound; ++i) rev_offset[i + 1] += rev_offset[i];
+        rev_source.resize(edges);
+        rev_weight.resize(edges);
+        std::vector<size_t> fill(rev_offset.begin(), rev_offset.end() - 1);
+        for (const auto& [u, adj] : graph) {
+            for (const auto& [v, w] : adj) {
+                rev_source[fill[v]] = u;
+                rev_weight[fill[v]++] = w;
+            }
+        }
+    }
+
+    void prepare_buffers(size_t chunks) {
+        if (buffers.size() < chunks) buffers.resize(chunks);
+        relaxed.assign(chunks, 0);
+    }
+
+    void top_down(std::unordered_map<Node, Weight>& dist, double B, const NodeVec& frontier) {
+        const Weight INF = std::numeric_limits<Weight>::infinity();
+        size_t chunks = (frontier.size() + FRONT_CHUNK - 1) / FRONT_CHUNK;
+        prepare_buffers(chunks);
+        parallel_for(0, chunks, 1, [&](size_t c) {
+            std::vector<Candidate>& buf = buffers[c];
+            buf.clear();
+            size_t count = 0;
+            size_t end = std::min(frontier.size(), (c + 1) * FRONT_CHUNK);
+            for (size_t i = c * FRONT_CHUNK; i < end; ++i) {
+                Node u = frontier[i];
+                auto du_it = dist.find(u);
+                if (du_it == dist.end() || !(du_it->second < B)) continue;
+                Weight du = du_it->second;
+                auto it = graph.find(u);
+                if (it == graph.end()) continue;
+                for (const auto& [v, w] : it->second) {
+                    ++count;
+                    Weight nd = du + w;
+                    auto dv_it = dist.find(v);
+                    Weight dv = dv_it == dist.end() ? INF : dv_it->second;
+                    if (nd < dv || (nd == dv && nd < B && !marked(v))) buf.push_back({v, u, nd, false});
+                }
+            }
+            relaxed[c] = count;
+        }, pool);
+    }
+
+    void bottom_up(std::unordered_map<Node, Weight>& dist, double B, const NodeVec& frontier) {
+        const Weight INF = std::numeric_limits<Weight>::infinity();
+        build_reverse();
+        for (Node u : frontier) {
+            auto it = dist.find(u);
+            if (it != dist.end() && it->second < B) front_dist[u] = std::min(front_dist[u], it->second);
+        }
+        size_t chunks = (bound + NODE_CHUNK - 1) / NODE_CHUNK;
+        prepare_buffers(chunks);
+        parallel_for(0, chunks, 1, [&](size_t c) {
+            std::vector<Candidate>& buf = buffers[c];
+            buf.clear();
+            size_t count = 0;
+            size_t end = std::min(bound, (c + 1) * NODE_CHUNK);
+            for (size_t v = c * NODE_CHUNK; v < end; ++v) {
+                Weight best = INF;
+                Node best_u = -1;
+                for (size_t e = rev_offset[v]; e < rev_offset[v + 1]; ++e) {
+                    Weight du = front_dist[rev_source[e]];
+                    if (du == INF) continue;
+                    ++count;
+                    Weight nd = du + rev_weight[e];
+                    if (nd < best) { best = nd; best_u = rev_source[e]; }
+                }
+                if (best_u < 0) continue;
+                // Solo este trozo escribe dist[v]; find no modifica la tabla
+                auto dv_it = dist.find((Node)v);
+                if (dv_it == dist.end()) {
+                    buf.push_back({(Node)v, best_u, best, false});
+                } else if (best < dv_it->second) {
+                    dv_it->second = best;
+                    if (best < B) mark((Node)v);
+                    buf.push_back({(Node)v, best_u, best, true});
+                } else if (best == dv_it->second && best < B && !marked((Node)v)) {
+                    mark((Node)v);
+                    buf.push_back({(Node)v, best_u, best, true});
+                }
+            }
+            relaxed[c] = count;
+        }, pool);
+        for (Node u : frontier) front_dist[u] = INF;
+    }
+
+public:
+    ParallelPivots(const Graph& g, const std::unordered_map<Node, Weight>& dist, ThreadPool& p)
+        : graph(g), pool(p) {
+        Node max_id = -1;
+        for (const auto& [u, adj] : graph) {
+            if (u < 0) return;
+            max_id = std::max(max_id, u);
+            for (const auto& [v, w] : adj) {
+                if (v < 0) return;
+                max_id = std::max(max_id, v);
+            }
+            edges += adj.size();
+        }
+        bound = (size_t)max_id + 1;
+        // Ids dispersos: el mapa de bits y los arrays por id no compensan
+        if (bound > 2 * std::max(dist.size(), graph.size()) + 1024) return;
+        dense = true;
+        in_w.reset(new std::atomic<std::uint64_t>[(bound + 63) / 64]);
+        for (size_t i = 0; i < (bound + 63) / 64; ++i) in_w[i].store(0, std::memory_order_relaxed);
+        out_degree.assign(bound, 0);
+        for (const auto& [u, adj] : graph) out_degree[u] = (std::uint32_t)adj.size();
+        front_dist.assign(bound, std::numeric_limits<Weight>::infinity());
+    }
+
+    bool usable() const { return dense; }
+
+    // Los nodos fuera de [0, bound) (solo en S o en dist) nunca se marcan
+    bool marked(Node v) const {
+        if ((size_t)v >= bound) return false;
+        return (in_w[v >> 6].load(std::memory_order_relaxed) >> (v & 63)) & 1;
+    }
+    void mark(Node v) {
+        if ((size_t)v < bound) in_w[v >> 6].fetch_or(std::uint64_t(1) << (v & 63), std::memory_order_relaxed);
+    }
+    void unmark(Node v) {
+        if ((size_t)v < bound) in_w[v >> 6].fetch_and(~(std::uint64_t(1) << (v & 63)), std::memory_order_relaxed);
+    }
+
+    // Una ronda sobre frontier: actualiza dist, pred, W y next_front como la
+    // versión secuencial. Los candidatos se aplican en orden de trozo, así que
+    // el resultado no depende del número de hilos.
+    void round(std::unordered_map<Node, Weight>& dist, double B, const NodeVec& frontier,
+               NodeVec& next_front, std::pmr::unordered_map<Node, Node>& pred, NodeSet& W, Instrument* instr) {
+        size_t front_edges = 0;
+        for (Node u : frontier) {
+            if ((size_t)u < bound) front_edges += out_degree[u];
+        }
+        bool pull = front_edges * BOTTOM_UP_RATIO > bound + edges;
+        if (pull) bottom_up(dist, B, frontier);
+        else top_down(dist, B, frontier);
+        INSTR_ADD(instr, pivot_rounds_parallel, 1);
+        if (pull) INSTR_ADD(instr, pivot_rounds_bottom_up, 1);
+
+        for (size_t c = 0; c < relaxed.size(); ++c) {
+            INSTR_ADD(instr, relaxations, relaxed[c]);
+            for (const Candidate& cand : buffers[c]) {
+                if (cand.applied) {
+                    pred[cand.v] = cand.u;
+                    if (cand.d < B) {
+                        W.insert(cand.v);
+                        next_front.push_back(cand.v);
+                    }
+                    continue;
+                }
+                Weight& dv = dist[cand.v];
+                if (cand.d < dv) {
+                    dv = cand.d;
+                    pred[cand.v] = cand.u;
+                    if (cand.d < B) {
+                        W.insert(cand.v);
+                        mark(cand.v);
+                        next_front.push_back(cand.v);
+                    }
+                } else if (cand.d == dv && cand.d < B && W.insert(cand.v).second) {
+                    mark(cand.v);
+                    pred[cand.v] = cand.u;
+                    next_front.push_back(cand.v);
+                }
+            }
+        }
+    }
+};
+
+// Frentes más pequeños se relajan en secuencial aunque haya pool
+constexpr size_t PARALLEL_FRONTIER = 2048;
+
+// FindPivots del artículo con S como rango; los temporales salen de mem.
+// k_steps rondas de Bellman-Ford desde S que actualizan dist y acumulan en
+// W los nodos por debajo de B. Si |W| > k·|S|, P = S; si no, P son las
+// raíces de S cuyo árbol de caminos mínimos dentro de W tiene >= k nodos.
+// p_limit > 0 se queda con los p_limit pivotes de menor distancia. Con par,
+// las rondas de frentes grandes van en paralelo.
+void find_pivots_into(
     const Graph& graph,
     std::unordered_map<Node, Weight>& dist,
-    const std::unordered_set<Node>& S,
-    double B, int n, int k_steps, int p_limit,
-    Instrument* instr) {
-    
-    Instrument local_instr;
-    if (!instr) instr = &local_instr;
-    
-    std::vector<Node> S_filtered;
+    NodeSpan S,
+    double B, int k_steps, int p_limit,
+    std::pmr::memory_resource* mem,
+    NodeVec& P, NodeSet& W,
+    Instrument* instr,
+    ParallelPivots* par = nullptr) {
+
+    INSTR_PHASE(instr, Phase::FIND_PIVOTS);
+
+    int k = std::max(1, k_steps);
+    P.clear();
+    W.clear();
+    std::pmr::unordered_map<Node, Node> pred(mem);  // arista del bosque que fijó dist[v]
+    NodeVec frontier(mem), next_front(mem);
     for (Node v : S) {
-        if (dist[v] < B) {
-            S_filtered.push_back(v);
+        if (W.insert(v).second) {
+            frontier.push_back(v);
+            if (par) par->mark(v);
         }
     }
-    
-    std::unordered_set<Node> P;
-    if (S_filtered.empty()) {
-        int count = 0;
-        for (Node v : S) {
-            if (count++ >= std::max(1, std::min((int)S.size(), p_limit))) break;
-            P.insert(v);
+
+    bool too_large = false;
+    for (int step = 0; step < k && !frontier.empty(); ++step) {
+        next_front.clear();
+        if (par && frontier.size() >= PARALLEL_FRONTIER) {
+            par->round(dist, B, frontier, next_front, pred, W, instr);
+            frontier.swap(next_front);
+            if (W.size() > (size_t)k * S.size) {
+                too_large = true;
+                break;
+            }
+            continue;
         }
-    } else {
-        std::sort(S_filtered.begin(), S_filtered.end(),
-                  [&dist](Node a, Node b) { return dist[a] < dist[b]; });
-        int limit = std::max(1, std::min((int)S_filtered.size(), p_limit));
-        for (int i = 0; i < limit; ++i) {
-            P.insert(S_filtered[i]);
-        }
-    }
-    
-    std::unordered_set<Node> source_frontier = P.empty() ? S : P;
-    std::unordered_set<Node> discovered = source_frontier;
-    std::unordered_set<Node> frontier = source_frontier;
-    
-    for (int step = 0; step < std::max(1, k_steps); ++step) {
-        if (frontier.empty()) break;
-        
-        std::unordered_set<Node> next_front;
         for (Node u : frontier) {
             Weight du = dist[u];
-            if (du >= B) continue;
-            
-            if (graph.find(u) != graph.end()) {
-                for (const auto& [v, w] : graph.at(u)) {
-                    instr->relaxations++;
-                    Weight nd = du + w;
-                    if (nd < B && discovered.find(v) == discovered.end()) {
-                        discovered.insert(v);
-                        next_front.insert(v);
+            if (!(du < B)) continue;
+
+            auto it = graph.find(u);
+            if (it == graph.end()) continue;
+            for (const auto& [v, w] : it->second) {
+                INSTR_ADD(instr, relaxations, 1);
+                Weight nd = du + w;
+                Weight& dv = dist[v];
+                // Como en el artículo se acepta la igualdad: un nivel inferior
+                // vuelve a recorrer aristas que el superior ya relajó. La
+                // igualdad solo añade nodos nuevos a W, así pred no forma ciclos
+                if (nd < dv) {
+                    dv = nd;
+                    pred[v] = u;
+                    if (nd < B) {
+                        W.insert(v);
+                        if (par) par->mark(v);
+                        next_front.push_back(v);
                     }
+                } else if (nd == dv && nd < B && W.insert(v).second) {
+                    if (par) par->mark(v);
+                    pred[v] = u;
+                    next_front.push_back(v);
                 }
             }
         }
-        frontier = next_front;
+        frontier.swap(next_front);
+        if (W.size() > (size_t)k * S.size) {
+            too_large = true;
+            break;
+        }
+    }
+
+    if (par) {
+        for (Node v : W) par->unmark(v);
+    }
+
+    if (too_large) {
+        P.assign(S.begin(), S.end());
+    } else {
+        // Tamaño de cada árbol: raíz = primer antecesor sin arista en pred
+        std::pmr::unordered_map<Node, Node> root(mem);
+        std::pmr::unordered_map<Node, int> size(mem);
+        NodeVec chain(mem);
+        for (Node v : W) {
+            Node r = v;
+            chain.clear();
+            while (true) {
+                auto known = root.find(r);
+                if (known != root.end()) { r = known->second; break; }
+                auto p = pred.find(r);
+                if (p == pred.end() || chain.size() > W.size()) break;
+                chain.push_back(r);
+                r = p->second;
+            }
+            for (Node c : chain) root[c] = r;
+            size[r]++;
+        }
+        for (Node s : S) {
+            auto it = size.find(s);
+            if (it != size.end() && it->second >= k && dist[s] < B) {
+                P.push_back(s);
+                it->second = 0;  // S puede traer repetidos
+            }
+        }
     }
-    
-    std::unordered_set<Node> W = discovered;
-    if (P.empty() && !S.empty()) {
-        P.insert(*S.begin());
+
+    if (p_limit > 0 && (int)P.size() > p_limit) {
+        std::nth_element(P.begin(), P.begin() + p_limit, P.end(),
+                         [&dist](Node a, Node b) { return dist[a] < dist[b]; });
+        P.resize(p_limit);
     }
-    
-    return {P, W};
 }
 
-std::pair<double, std::unordered_set<Node>> basecase(
+constexpr int SMALL_K = 64;            // basecase con k <= SMALL_K: sin reservas
+constexpr size_t SMALL_HEAP = 256;     // entradas del montículo dentro del marco
+
+// Montículo de mínimos de claves empaquetadas. Las primeras Inline entradas
+// viven en el propio objeto (en la pila); si no caben, todo pasa a un vector
+// de mem. Inline = 0: siempre en el vector.
+template <size_t Inline>
+class BasecaseHeap {
+private:
+    PackedKey local[Inline > 0 ? Inline : 1];
+    std::pmr::vector<PackedKey> spill;
+    size_t count = 0;  // elementos en local mientras !spilled
+    bool spilled = (Inline == 0);
+
+public:
+    explicit BasecaseHeap(std::pmr::memory_resource* mem) : spill(mem) {}
+
+    bool empty() const { return spilled ? spill.empty() : count == 0; }
+    size_t size() const { return spilled ? spill.size() : count; }
+
+    void push(PackedKey key) {
+        if (!spilled && count == Inline) {
+            spill.reserve(2 * Inline);
+            spill.assign(local, local + count);
+            spilled = true;
+        }
+        if (spilled) {
+            spill.push_back(key);
+            std::push_heap(spill.begin(), spill.end(), std::greater<PackedKey>());
+        } else {
+            local[count++] = key;
+            std::push_heap(local, local + count, std::greater<PackedKey>());
+        }
+    }
+
+    PackedKey pop() {
+        if (spilled) {
+            std::pop_heap(spill.begin(), spill.end(), std::greater<PackedKey>());
+            PackedKey key = spill.back();
+            spill.pop_back();
+            return key;
+        }
+        std::pop_heap(local, local + count, std::greater<PackedKey>());
+        return local[--count];
+    }
+};
+
+// Uo para k <= SMALL_K: array en la pila con búsqueda lineal (a lo sumo
+// k+1 nodos), en orden de extracción
+struct InlineSettled {
+    static constexpr bool growable = false;
+    Node nodes[SMALL_K + 1];
+    int count = 0;
+
+    bool contains(Node u) const {
+        for (int i = 0; i < count; ++i) {
+            if (nodes[i] == u) return true;
+        }
+        return false;
+    }
+    bool insert(Node u) {
+        if (contains(u)) return false;
+        nodes[count++] = u;
+        return true;
+    }
+    int size() const { return count; }
+    const Node* begin() const { return nodes; }
+    const Node* end() const { return nodes + count; }
+};
+
+// Uo para k grande: conjunto hash y orden de extracción aparte
+struct HashSettled {
+    static constexpr bool growable = true;
+    NodeSet set;
+    NodeVec order;
+
+    explicit HashSettled(std::pmr::memory_resource* mem) : set(mem), order(mem) {}
+
+    bool contains(Node u) const { return set.count(u) > 0; }
+    bool insert(Node u) {
+        if (!set.insert(u).second) return false;
+        order.push_back(u);
+        return true;
+    }
+    int size() const { return (int)order.size(); }
+    const Node* begin() const { return order.data(); }
+    const Node* end() const { return order.data() + order.size(); }
+};
+
+// Dijkstra acotado a k+1 nodos fijados, sembrado con todos los nodos de S
+// por debajo de B (el mínimo de S si no hay ninguno); añade U a out y
+// devuelve B'.
+//
+// Si los k+1 nodos fijados empatan en maxd (ciclos de peso cero, p. ej. los
+// de la reducción de grado) U quedaría vacío y el padre repetiría la misma
+// llamada. En ese caso se fija la clase de empate completa y B' pasa justo
+// por encima de maxd; con un Settled de capacidad fija se devuelve NaN para
+// que el llamador repita con uno que crezca.
+template <class Heap, class Settled>
+double basecase_run(
     const Graph& graph,
     std::unordered_map<Node, Weight>& dist,
     double B,
-    const std::unordered_set<Node>& S,
+    NodeSpan S,
     int k,
+    Heap& heap,
+    Settled& Uo,
+    std::vector<Node>& out,
     Instrument* instr) {
-    
-    Instrument local_instr;
-    if (!instr) instr = &local_instr;
-    
-    if (S.empty()) {
-        return {B, std::unordered_set<Node>()};
-    }
-    
-    Node x = *std::min_element(S.begin(), S.end(),
-                               [&dist](Node a, Node b) { return dist[a] < dist[b]; });
-    
-    using PQPair = std::pair<Weight, Node>;
-    std::priority_queue<PQPair, std::vector<PQPair>, std::greater<PQPair>> heap;
-    
-    Weight start_d = dist[x];
-    heap.push({start_d, x});
-    instr->heap_ops++;
-    
-    std::unordered_set<Node> Uo;
-    
-    while (!heap.empty() && (int)Uo.size() < (k + 1)) {
-        auto [d_u, u] = heap.top();
-        heap.pop();
-        instr->heap_ops++;
-        
-        if (d_u > dist[u]) continue;
-        
-        Uo.insert(u);
-        
-        if (graph.find(u) != graph.end()) {
-            for (const auto& [v, w] : graph.at(u)) {
-                instr->relaxations++;
-                Weight newd = dist[u] + w;
-                if (newd < dist[v] && newd < B) {
-                    dist[v] = newd;
-                    heap.push({newd, v});
-                    instr->heap_ops++;
-                }
-            }
+
+    for (Node s : S) {
+        Weight d = dist[s];
+        if (d < B) {
+            heap.push(pack_key(d, s));
+            INSTR_ADD(instr, heap_ops, 1);
         }
     }
-    
-    if ((int)Uo.size() <= k) {
-        return {B, Uo};
-    } else {
-        std::vector<Weight> finite_dists;
-        for (Node v : Uo) {
-            if (std::isfinite(dist[v])) {
-                finite_dists.push_back(dist[v]);
-            }
+    if (heap.empty()) {
+        Node x = *std::min_element(S.begin(), S.end(),
+                                   [&dist](Node a, Node b) { return dist[a] < dist[b]; });
+        heap.push(pack_key(dist[x], x));
+        INSTR_ADD(instr, heap_ops, 1);
+    }
+    INSTR_HEAP(instr, heap.size());
+
+    auto settle = [&](PackedKey key) {
+        Node u = key_node(key);
+        Weight d_u = dist[u];
+        if (key_bits(key) > monotone_bits(d_u)) {
+            INSTR_ADD(instr, stale_pops, 1);
+            return;
         }
-        
-        if (finite_dists.empty()) {
-            return {B, std::unordered_set<Node>()};
+
+        // Una mejora por debajo de la resolución de la clave vuelve a sacar
+        // u: no cuenta otra vez en Uo pero sí propaga la nueva distancia
+        if (Uo.insert(u)) {
+            INSTR_ADD(instr, settled, 1);
         }
-        
-        Weight maxd = *std::max_element(finite_dists.begin(), finite_dists.end());
-        std::unordered_set<Node> U_filtered;
-        for (Node v : Uo) {
-            if (dist[v] < maxd) {
-                U_filtered.insert(v);
+
+        auto it = graph.find(u);
+        if (it == graph.end()) return;
+        for (const auto& [v, w] : it->second) {
+            INSTR_ADD(instr, relaxations, 1);
+            Weight newd = d_u + w;
+            if (newd < B) {
+                // <= como en el artículo: find_pivots de los niveles
+                // superiores ya puede haber dejado dist[v] en este valor
+                Weight& dv = dist[v];
+                if (newd <= dv && !(newd == dv && Uo.contains(v))) {
+                    dv = newd;
+                    heap.push(pack_key(newd, v));
+                    INSTR_ADD(instr, heap_ops, 1);
+                    INSTR_HEAP(instr, heap.size());
+                }
             }
         }
-        return {maxd, U_filtered};
+    };
+
+    while (!heap.empty() && Uo.size() < (k + 1)) {
+        PackedKey key = heap.pop();
+        INSTR_ADD(instr, heap_ops, 1);
+        settle(key);
+    }
+
+    if (Uo.size() <= k) {
+        out.insert(out.end(), Uo.begin(), Uo.end());
+        return B;
+    }
+
+    bool any_finite = false;
+    Weight maxd = -std::numeric_limits<Weight>::infinity();
+    for (Node v : Uo) {
+        if (std::isfinite(dist[v])) {
+            any_finite = true;
+            maxd = std::max(maxd, dist[v]);
+        }
+    }
+    if (!any_finite) {
+        return B;
+    }
+    // B' = la menor distancia con los bits de maxd, no maxd: en el montículo
+    // puede quedar una entrada con esos bits y distancia exacta menor
+    const Weight bound = monotone_floor(monotone_bits(maxd));
+    const size_t before = out.size();
+    for (Node v : Uo) {
+        if (dist[v] < bound) {
+            out.push_back(v);
+        }
+    }
+    if (out.size() > before) {
+        return bound;
+    }
+
+    if (!Settled::growable) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    // Todas las entradas con la clave de maxd: después ningún nodo pendiente
+    // tiene distancia <= maxd
+    const std::uint32_t tie_bits = monotone_bits(maxd);
+    while (!heap.empty()) {
+        PackedKey key = heap.pop();
+        INSTR_ADD(instr, heap_ops, 1);
+        if (key_bits(key) > tie_bits) break;
+        settle(key);
     }
+    maxd = -std::numeric_limits<Weight>::infinity();
+    for (Node v : Uo) {
+        maxd = std::max(maxd, dist[v]);
+        out.push_back(v);
+    }
+    return std::min(B, std::nextafter((double)maxd, std::numeric_limits<double>::infinity()));
 }
 
-std::pair<double, std::unordered_set<Node>> bmssp(
+// Hojas de la recursión: con k <= SMALL_K el montículo y Uo están en la
+// pila y la llamada no reserva memoria salvo que el montículo desborde
+double basecase_into(
     const Graph& graph,
     std::unordered_map<Node, Weight>& dist,
-    const std::vector<Edge>& edges,
-    int l, double B,
-    const std::unordered_set<Node>& S,
-    int n,
+    double B,
+    NodeSpan S,
+    int k,
+    std::pmr::memory_resource* mem,
+    std::vector<Node>& out,
     Instrument* instr) {
-    
-    Instrument local_instr;
-    if (!instr) instr = &local_instr;
-    
-    int t_param, k_param;
-    if (n <= 2) {
-        t_param = 1;
-        k_param = 2;
-    } else {
-        t_param = std::max(1, (int)std::round(std::pow(std::log(std::max(3, n)), 2.0 / 3.0)));
-        k_param = std::max(2, (int)std::round(std::pow(std::log(std::max(3, n)), 1.0 / 3.0)));
-    }
-    
-    if (l <= 0) {
-        if (S.empty()) {
-            return {B, std::unordered_set<Node>()};
-        }
-        return basecase(graph, dist, B, S, k_param, instr);
-    }
-    
-    int p_limit = std::max(1, 1 << std::min(10, t_param));
-    int k_steps = std::max(1, k_param);
-    
-    auto [P, W] = find_pivots(graph, dist, S, B, n, k_steps, p_limit, instr);
-    
-    int M = 1 << std::max(0, (l - 1) * t_param);
-    DataStructureD D(M, B, std::max(1, std::min((int)P.size(), 64)));
-    
-    for (Node x : P) {
-        D.insert(x, dist[x]);
-    }
-    
-    double B_prime_initial = B;
-    if (!P.empty()) {
-        B_prime_initial = std::numeric_limits<double>::infinity();
-        for (Node x : P) {
-            B_prime_initial = std::min(B_prime_initial, dist[x]);
-        }
-    }
-    
-    std::unordered_set<Node> U;
-    std::vector<double> B_prime_sub_values;
-    
-    int loop_guard = 0;
-    int limit = k_param * (1 << (l * std::max(1, t_param)));
-    
-    while ((int)U.size() < limit && !D.empty()) {
-        if (++loop_guard > 20000) break;
-        
-        double Bi;
-        std::unordered_set<Node> Si;
-        try {
-            auto result = D.pull();
-            Bi = result.first;
-            Si = result.second;
-        } catch (...) {
-            break;
+
+    if (S.size == 0) {
+        return B;
+    }
+    INSTR_PHASE(instr, Phase::BASECASE);
+
+    if (k <= SMALL_K) {
+        BasecaseHeap<SMALL_HEAP> heap(mem);
+        InlineSettled Uo;
+        double B_prime = basecase_run(graph, dist, B, S, k, heap, Uo, out, instr);
+        if (!std::isnan(B_prime)) return B_prime;
+        // Empate en maxd: se repite con Uo en memoria dinámica. dist solo ha
+        // bajado hacia valores alcanzables, así que repetir es correcto.
+    }
+    BasecaseHeap<0> heap(mem);
+    HashSettled Uo(mem);
+    return basecase_run(graph, dist, B, S, k, heap, Uo, out, instr);
+}
+
+// Estado de una llamada bmssp(l, B, S). La recursión siempre baja de l a
+// l-1, así que la pila explícita tiene a lo sumo un marco por nivel y cada
+// nivel reutiliza su marco, su DataStructureD y su arena.
+struct Frame {
+    int level = 0;
+    double B = 0.0;
+    NodeSpan S;
+    size_t out_begin = 0;  // resultado del marco: out[out_begin, out.size())
+
+    // Temporales en la arena del nivel; se destruyen al salir del marco
+    struct Sets {
+        NodeVec P;
+        NodeSet W, U;
+        explicit Sets(std::pmr::memory_resource* mem) : P(mem), W(mem), U(mem) {}
+    };
+    std::optional<Sets> sets;
+
+    std::vector<Node> Si;      // bloque extraído de D; es el S del hijo
+    double Bi = 0.0;
+    double B_prime_last = 0.0;  // B'_i del último hijo (B'_0 = mínimo de d en P)
+    bool waiting_child = false;
+    bool partial = false;       // salió por |U| >= k·2^(l·t) con D no vacía
+    long long limit = 0;
+
+    std::chrono::steady_clock::time_point t0;  // temporizador por nivel
+    TraceEvent ev;
+};
+
+// Arena de un nivel: bloque inicial tomado de upstream y monotonic_buffer_resource
+// encima; release() vuelve al bloque inicial sin devolverlo
+class LevelArena {
+private:
+    std::pmr::memory_resource* upstream;
+    void* block;
+    size_t bytes;
+    std::pmr::monotonic_buffer_resource arena;
+
+public:
+    LevelArena(size_t block_bytes, std::pmr::memory_resource* up)
+        : upstream(up), block(up->allocate(block_bytes)), bytes(block_bytes),
+          arena(block, block_bytes, up) {}
+    ~LevelArena() {
+        arena.release();
+        upstream->deallocate(block, bytes);
+    }
+    LevelArena(const LevelArena&) = delete;
+    LevelArena& operator=(const LevelArena&) = delete;
+
+    std::pmr::memory_resource* get() { return &arena; }
+    void release() { arena.release(); }
+};
+
+class BmsspDriver {
+private:
+    const Graph& graph;
+    std::unordered_map<Node, Weight>& dist;
+    const BmsspParams& params;
+    Instrument* instr;
+
+    static constexpr size_t ARENA_BYTES = 64u << 10;
+    std::vector<std::unique_ptr<LevelArena>> arenas;
+    std::vector<Frame> frames;  // indexado por nivel
+    std::vector<std::optional<DataStructureD>> D;
+    std::vector<std::pair<Node, Weight>> K_for_batch;
+    std::unique_ptr<ParallelPivots> par;  // BmsspParams::parallel
+    CancelPoll poll;
+    // Trabajo desde la última consulta al token: nodos fijados por basecase,
+    // nodos de W en find_pivots y aristas relajadas al absorber un hijo
+    std::int64_t work = 0;
+    bool stopped = false;  // el token pidió parar: ningún marco vuelve a extraer
+
+    void enter(int l, double B, NodeSpan S) {
+        Frame& f = frames[l];
+        f.level = l;
+        f.B = B;
+        f.S = S;
+        f.out_begin = out.size();
+        f.waiting_child = false;
+        f.partial = false;
+#if INSTRUMENTATION_LEVEL >= 2
+        f.t0 = std::chrono::steady_clock::now();
+#endif
+        if (instr->trace) {
+            f.ev = TraceEvent();
+            f.ev.level = l;
+            f.ev.S = S.size;
+            f.ev.B = B;
+            f.ev.start = instr->trace->now();
+        }
+        f.sets.emplace(arenas[l]->get());
+        if (l <= 0) return;
+
+        Frame::Sets& st = *f.sets;
+        find_pivots_into(graph, dist, S, B, std::max(1, params.k), params.p_limit,
+                         arenas[l]->get(), st.P, st.W, instr, par.get());
+        f.ev.P = st.P.size();
+        f.ev.W = st.W.size();
+        work += (std::int64_t)st.W.size();
+
+        // Exponentes acotados: con parámetros ajustados l*t puede pasar de 31
+        int M = 1 << std::min(30, std::max(0, (l - 1) * params.t));
+        int block_size = params.block_size > 0 ? params.block_size
+                                                : std::max(1, std::min((int)st.P.size(), 64));
+        if (!D[l]) D[l].emplace(M, B, block_size);
+        else D[l]->reset(M, B, block_size);
+
+        for (Node x : st.P) {
+            D[l]->insert(x, dist[x]);
+        }
+
+        f.B_prime_last = B;
+        if (!st.P.empty()) {
+            f.B_prime_last = std::numeric_limits<double>::infinity();
+            for (Node x : st.P) {
+                f.B_prime_last = std::min<double>(f.B_prime_last, dist[x]);
+            }
         }
-        
-        auto [B_prime_sub, Ui] = bmssp(graph, dist, edges, l - 1, Bi, Si, n, instr);
-        B_prime_sub_values.push_back(B_prime_sub);
-        
-        U.insert(Ui.begin(), Ui.end());
-        
-        std::vector<std::pair<Node, Weight>> K_for_batch;
+        f.limit = (long long)params.k << std::min(40, l * std::max(1, params.t));
+    }
+
+    // Cierra el marco; su resultado ya está en out[f.out_begin, out.size())
+    double leave(Frame& f, double B_prime) {
+#if INSTRUMENTATION_LEVEL >= 2
+        int slot = std::min(std::max(0, f.level), MAX_LEVELS - 1);
+        instr->level_seconds[slot] +=
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - f.t0).count();
+        instr->level_calls[slot]++;
+#endif
+        if (instr->trace) {
+            f.ev.U = out.size() - f.out_begin;
+            f.ev.B_prime = B_prime;
+            f.ev.elapsed = instr->trace->now() - f.ev.start;
+            instr->trace->record(f.ev);
+        }
+        f.sets.reset();
+        arenas[f.level]->release();
+        return B_prime;
+    }
+
+    // Incorpora el resultado (B', Ui) del hijo al marco f y relaja sus
+    // aristas. false si el token pide parar (antes o a medias): el marco ya
+    // no extrae, así que Ui debe quedarse en out como parte de su resultado,
+    // sin pasar entera por U ni relajar el resto de sus aristas
+    bool absorb(Frame& f, double B_prime_sub, NodeSpan Ui) {
+        Frame::Sets& st = *f.sets;
+        f.B_prime_last = B_prime_sub;
+        if (stopped) return false;
+
+        INSTR_PHASE(instr, Phase::BATCH_RELAX);
+        DataStructureD& Dl = *D[f.level];
+        K_for_batch.clear();
         for (Node u : Ui) {
+            // Ui puede ser grande en los niveles altos: se consulta por nodo
+            if (poll.stop(work + 1)) {
+                stopped = true;
+                return false;
+            }
+            work = 0;
+            st.U.insert(u);
             Weight du = dist[u];
             if (!std::isfinite(du)) continue;
-            
-            if (graph.find(u) != graph.end()) {
-                for (const auto& [v, w_uv] : graph.at(u)) {
-                    instr->relaxations++;
+
+            auto it = graph.find(u);
+            if (it != graph.end()) {
+                work += (std::int64_t)it->second.size();
+                for (const auto& [v, w_uv] : it->second) {
+                    INSTR_ADD(instr, relaxations, 1);
                     Weight newd = du + w_uv;
                     if (newd <= dist[v]) {
                         dist[v] = newd;
-                        if (Bi <= newd && newd < B) {
-                            D.insert(v, newd);
-                        } else if (B_prime_sub <= newd && newd < Bi) {
+                        if (f.Bi <= newd && newd < f.B) {
+                            Dl.insert(v, newd);
+                        } else if (B_prime_sub <= newd && newd < f.Bi) {
                             K_for_batch.push_back({v, newd});
                         }
                     }
                 }
             }
         }
-        
-        for (Node x : Si) {
+
+        for (Node x : f.Si) {
             Weight dx = dist[x];
-            if (B_prime_sub <= dx && dx < Bi) {
+            if (B_prime_sub <= dx && dx < f.Bi) {
                 K_for_batch.push_back({x, dx});
             }
         }
-        
+
         if (!K_for_batch.empty()) {
-            D.batch_prepend(K_for_batch);
+            Dl.batch_prepend(K_for_batch);
+        }
+        return true;
+    }
+
+    // Una iteración del bucle del marco f (l > 0): extrae un bloque de D.
+    // true = hay que bajar al hijo con S = f.Si; false = el marco terminó,
+    // con D vacía (ejecución completa) o con |U| >= k·2^(l·t) (parcial).
+    // Cada pull saca al menos un nodo de D, así que el bucle siempre acaba.
+    bool next_pull(Frame& f) {
+        DataStructureD& Dl = *D[f.level];
+        if (Dl.empty()) return false;
+        // Parada por el token: se cierra el marco como en la ejecución parcial
+        if (poll.stop(work + 1)) {
+            stopped = true;
+            return false;
         }
+        work = 0;
+        if ((long long)f.sets->U.size() >= f.limit) {
+            f.partial = true;
+            f.ev.partial = true;
+            INSTR_ADD(instr, partial_calls, 1);
+            return false;
+        }
+        INSTR_PHASE(instr, Phase::D_PULL);
+        f.Bi = Dl.pull_into(f.Si);
+        f.ev.pulls++;
+        return true;
+    }
+
+    // B' = min(B'_i, B) y U_final = U ∪ {x ∈ W : d(x) < B'}, escrito al final de out
+    double finish(Frame& f) {
+        Frame::Sets& st = *f.sets;
+        double B_prime_final = std::min(f.B_prime_last, f.B);
+        out.insert(out.end(), st.U.begin(), st.U.end());
+        for (Node x : st.W) {
+            if (dist[x] < B_prime_final && st.U.find(x) == st.U.end()) {
+                out.push_back(x);
+            }
+        }
+        return leave(f, B_prime_final);
+    }
+
+public:
+    std::vector<Node> out;  // buffer compartido de resultados
+
+    // Las arenas por nivel empiezan en un bloque de mem y crecen también desde mem
+    BmsspDriver(const Graph& g, std::unordered_map<Node, Weight>& d,
+                const BmsspParams& p, int levels, Instrument* in, std::pmr::memory_resource* mem,
+                CancelToken* cancel)
+        : graph(g), dist(d), params(p), instr(in), poll(cancel) {
+        int L = std::max(0, levels);
+        frames.resize(L + 1);
+        D.resize(L + 1);
+        for (int l = 0; l <= L; ++l) {
+            arenas.emplace_back(new LevelArena(ARENA_BYTES, mem));
+        }
+        if (p.parallel && ThreadPool::global().concurrency() > 1) {
+            par = std::make_unique<ParallelPivots>(g, d, ThreadPool::global());
+            if (!par->usable()) par.reset();
+        }
+    }
+
+    // true si la última run() paró por el token (no si lo hizo otra búsqueda
+    // anterior con el mismo token)
+    bool was_stopped() const { return stopped; }
+
+    // bmssp(levels, B, S) sin recursión; el resultado U queda en out
+    double run(int levels, double B, NodeSpan S) {
+        out.clear();
+        int top = std::max(0, levels);
+        int cur = top;
+        enter(cur, B, S);
+        double child_B_prime = 0.0;
+
+        while (true) {
+            Frame& f = frames[cur];
+            double B_prime;
+
+            if (cur == 0) {
+                B_prime = leave(f, basecase_into(graph, dist, f.B, f.S, params.k,
+                                                 arenas[0]->get(), out, instr));
+                work += (std::int64_t)(out.size() - f.out_begin);
+            } else {
+                if (f.waiting_child) {
+                    Frame& child = frames[cur - 1];
+                    NodeSpan Ui{out.data() + child.out_begin, out.size() - child.out_begin};
+                    // Tras una parada Ui se queda en out y la vuelta atrás no
+                    // recorre el resultado una vez por nivel (un nodo puede
+                    // repetirse en out)
+                    if (absorb(f, child_B_prime, Ui)) out.resize(child.out_begin);  // Ui ya está en U
+                    f.waiting_child = false;
+                }
+                if (next_pull(f)) {
+                    f.waiting_child = true;
+                    enter(cur - 1, f.Bi, NodeSpan{f.Si.data(), f.Si.size()});
+                    cur--;
+                    continue;
+                }
+                B_prime = finish(f);
+            }
+
+            if (cur == top) return B_prime;
+            child_B_prime = B_prime;
+            cur++;
+        }
+    }
+};
+
+std::pair<double, std::unordered_set<Node>> run_bmssp(
+    const Graph& graph,
+    std::unordered_map<Node, Weight>& dist,
+    const BmsspParams& params,
+    int levels, double B,
+    const std::unordered_set<Node>& S,
+    Instrument* instr,
+    std::pmr::memory_resource* mem,
+    CancelToken* cancel) {
+
+    std::vector<Node> s(S.begin(), S.end());
+    BmsspDriver driver(graph, dist, params, levels, instr, mem ? mem : std::pmr::get_default_resource(), cancel);
+    double B_prime = driver.run(levels, B, NodeSpan{s.data(), s.size()});
+    return {B_prime, std::unordered_set<Node>(driver.out.begin(), driver.out.end())};
+}
+
+}  // namespace
+
+std::pair<std::unordered_set<Node>, std::unordered_set<Node>> find_pivots(
+    const Graph& graph,
+    std::unordered_map<Node, Weight>& dist,
+    const std::unordered_set<Node>& S,
+    double B, int n, int k_steps, int p_limit,
+    Instrument* instr) {
+
+    (void)n;
+    Instrument local_instr;
+    if (!instr) instr = &local_instr;
+
+    std::vector<Node> s(S.begin(), S.end());
+    NodeVec P;
+    NodeSet W;
+    find_pivots_into(graph, dist, NodeSpan{s.data(), s.size()}, B, k_steps, p_limit,
+                     std::pmr::get_default_resource(), P, W, instr);
+    return {std::unordered_set<Node>(P.begin(), P.end()), std::unordered_set<Node>(W.begin(), W.end())};
+}
+
+std::pair<double, std::unordered_set<Node>> basecase(
+    const Graph& graph,
+    std::unordered_map<Node, Weight>& dist,
+    double B,
+    const std::unordered_set<Node>& S,
+    int k,
+    Instrument* instr) {
+
+    Instrument local_instr;
+    if (!instr) instr = &local_instr;
+
+    std::vector<Node> s(S.begin(), S.end());
+    std::vector<Node> U;
+    double B_prime = basecase_into(graph, dist, B, NodeSpan{s.data(), s.size()}, k,
+                                   std::pmr::get_default_resource(), U, instr);
+    return {B_prime, std::unordered_set<Node>(U.begin(), U.end())};
+}
+
+namespace {
+
+// Fórmulas del artículo con logaritmo en base 2: t = ⌊log^(2/3) n⌋,
+// k = ⌊log^(1/3) n⌋ y l = ⌈log n / t⌉, de modo que k·2^(l·t) >= n y la
+// llamada inicial no puede acabar en ejecución parcial por tamaño
+double log2_n(int n) { return std::log2((double)std::max(4, n)); }
+int default_t(int n) { return std::max(1, (int)std::floor(std::pow(log2_n(n), 2.0 / 3.0))); }
+int default_k(int n) { return std::max(2, (int)std::floor(std::pow(log2_n(n), 1.0 / 3.0))); }
+
+}  // namespace
+
+int bmssp_default_levels(int n) {
+    return std::max(1, (int)std::ceil(log2_n(n) / default_t(n)));
+}
+
+BmsspParams bmssp_resolve_params(int n, const BmsspParams& p) {
+    BmsspParams r = p;
+    if (r.t <= 0) r.t = default_t(n);
+    if (r.k <= 0) r.k = default_k(n);
+    if (r.levels <= 0) r.levels = std::max(1, (int)std::ceil(log2_n(n) / r.t));
+    // p_limit y block_size <= 0 se mantienen: sin tope de pivotes y bloque
+    // dependiente de |P| en cada llamada
+    return r;
+}
+
+std::pair<double, std::unordered_set<Node>> bmssp(
+    const Graph& graph,
+    std::unordered_map<Node, Weight>& dist,
+    const std::vector<Edge>& edges,
+    int l, double B,
+    const std::unordered_set<Node>& S,
+    int n,
+    Instrument* instr) {
+
+    (void)edges;
+    Instrument local_instr;
+    if (!instr) instr = &local_instr;
+    return run_bmssp(graph, dist, bmssp_resolve_params(n), std::max(0, l), B, S, instr, nullptr, nullptr);
+}
+
+std::pair<double, std::unordered_set<Node>> bmssp(
+    const Graph& graph,
+    std::unordered_map<Node, Weight>& dist,
+    const std::vector<Edge>& edges,
+    const BmsspParams& params,
+    double B,
+    const std::unordered_set<Node>& S,
+    int n,
+    Instrument* instr,
+    std::pmr::memory_resource* mem,
+    CancelToken* cancel) {
+
+    (void)edges;
+    Instrument local_instr;
+    if (!instr) instr = &local_instr;
+    BmsspParams resolved = bmssp_resolve_params(n, params);
+    return run_bmssp(graph, dist, resolved, resolved.levels, B, S, instr, mem, cancel);
+}
+
+BmsspOutcome bmssp_complete(
+    const Graph& graph,
+    std::unordered_map<Node, Weight>& dist,
+    const BmsspParams& params,
+    double B,
+    const std::unordered_set<Node>& S,
+    int n,
+    Instrument* instr,
+    std::pmr::memory_resource* mem,
+    CancelToken* cancel) {
+
+    Instrument local_instr;
+    if (!instr) instr = &local_instr;
+    if (!mem) mem = std::pmr::get_default_resource();
+    BmsspParams resolved = bmssp_resolve_params(n, params);
+
+    // U no hace falta aquí: se llama al driver sin construir el conjunto
+    // El estado sale de lo que pasó en esta llamada, no de cancel->stopped():
+    // un token reutilizado puede traer la parada de una consulta anterior
+    BmsspOutcome outcome;
+    std::vector<Node> s(S.begin(), S.end());
+    bool stopped = false;
+    {
+        BmsspDriver driver(graph, dist, resolved, resolved.levels, instr, mem, cancel);
+        outcome.B_prime = driver.run(resolved.levels, B, NodeSpan{s.data(), s.size()});
+        stopped = driver.was_stopped();
     }
-    
-    double B_prime_final = B_prime_initial;
-    if (!B_prime_sub_values.empty()) {
-        B_prime_final = std::min(B_prime_initial,
-                                 *std::min_element(B_prime_sub_values.begin(),
-                                                  B_prime_sub_values.end()));
+    outcome.partial = outcome.B_prime < B;
+    if (stopped) {
+        outcome.status = cancel->status();
+        return outcome;
     }
-    
-    std::unordered_set<Node> U_final = U;
-    for (Node x : W) {
-        if (dist[x] < B_prime_final) {
-            U_final.insert(x);
+    if (!outcome.partial) return outcome;
+
+    // Los nodos con d < B' son completos y sus aristas ya se relajaron, así
+    // que las etiquetas en [B', B) son cotas superiores válidas de la frontera
+    // La pasada por dist es O(n) y también consulta el token; si para en
+    // ella, B' sigue siendo el del driver
+    CancelPoll poll(cancel);
+    std::pmr::vector<PackedKey> heap(mem);
+    for (const auto& [v, d] : dist) {
+        if (poll.stop()) {
+            outcome.status = cancel->status();
+            return outcome;
         }
+        if (outcome.B_prime <= d && d < B) heap.push_back(pack_key(d, v));
     }
-    
-    return {B_prime_final, U_final};
-}
\ No newline at end of file
+    std::make_heap(heap.begin(), heap.end(), std::greater<PackedKey>());
+    INSTR_ADD(instr, heap_ops, heap.size());
+
+    double last_settled = outcome.B_prime;
+    std::int64_t work = (std::int64_t)heap.size();  // make_heap
+    while (!heap.empty()) {
+        if (poll.stop(work)) {
+            // Todo nodo con d menor que la menor distancia con los bits de la
+            // última clave extraída ya está fijado (ver monotone_floor)
+            outcome.status = cancel->status();
+            break;
+        }
+        work = 1;
+        std::pop_heap(heap.begin(), heap.end(), std::greater<PackedKey>());
+        PackedKey key = heap.back();
+        heap.pop_back();
+        INSTR_ADD(instr, heap_ops, 1);
+
+        Node u = key_node(key);
+        Weight d_u = dist[u];
+        if (key_bits(key) > monotone_bits(d_u)) {
+            INSTR_ADD(instr, stale_pops, 1);
+            continue;
+        }
+        last_settled = std::max(outcome.B_prime, monotone_floor(key_bits(key)));
+        outcome.fallback_settled++;
+        INSTR_ADD(instr, settled, 1);
+
+        auto it = graph.find(u);
+        if (it == graph.end()) continue;
+        work += (std::int64_t)it->second.size();
+        for (const auto& [v, w] : it->second) {
+            INSTR_ADD(instr, relaxations, 1);
+            Weight nd = d_u + w;
+            if (nd < B) {
+                Weight& dv = dist[v];
+                if (nd < dv) {
+                    dv = nd;
+                    heap.push_back(pack_key(nd, v));
+                    std::push_heap(heap.begin(), heap.end(), std::greater<PackedKey>());
+                    INSTR_ADD(instr, heap_ops, 1);
+                    INSTR_HEAP(instr, heap.size());
+                }
+            }
+        }
+    }
+    instr->fallback_settled += outcome.fallback_settled;
+    if (outcome.status != SearchStatus::COMPLETE) outcome.B_prime = last_settled;
+    return outcome;
+}
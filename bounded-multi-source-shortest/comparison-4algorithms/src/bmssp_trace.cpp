@@ -0,0 +1,88 @@
+#include "./../include/bmssp_trace.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// JSON no admite infinito: los límites no acotados se escriben como null
+void write_bound(std::ostream& os, double b) {
+    if (std::isfinite(b)) os << b;
+    else os << "null";
+}
+
+}  // namespace
+
+BmsspTrace::BmsspTrace(size_t capacity)
+    : ring(std::max<size_t>(1, capacity)), origin(std::chrono::steady_clock::now()) {}
+
+double BmsspTrace::now() const {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - origin).count();
+}
+
+void BmsspTrace::record(const TraceEvent& ev) {
+    ring[head] = ev;
+    head = (head + 1) % ring.size();
+    if (stored < ring.size()) stored++;
+    total++;
+
+    size_t l = (size_t)std::max(0, ev.level);
+    if (summary.size() <= l) summary.resize(l + 1);
+    TraceLevelSummary& s = summary[l];
+    s.calls++;
+    s.sum_S += ev.S; s.sum_P += ev.P; s.sum_W += ev.W; s.sum_U += ev.U;
+    s.max_S = std::max(s.max_S, ev.S);
+    s.max_U = std::max(s.max_U, ev.U);
+    s.pulls += ev.pulls;
+    if (ev.partial) s.partial++;
+    s.seconds += ev.elapsed;
+}
+
+void BmsspTrace::clear() {
+    head = stored = total = 0;
+    summary.clear();
+    origin = std::chrono::steady_clock::now();
+}
+
+std::vector<TraceEvent> BmsspTrace::events() const {
+    std::vector<TraceEvent> out;
+    out.reserve(stored);
+    size_t first = (head + ring.size() - stored) % ring.size();
+    for (size_t i = 0; i < stored; ++i) out.push_back(ring[(first + i) % ring.size()]);
+    return out;
+}
+
+void BmsspTrace::write_chrome_trace(std::ostream& os) const {
+    auto old_precision = os.precision(9);
+    os << "{\"displayTimeUnit\": \"ms\", \"otherData\": {\"recorded\": " << total
+       << ", \"dropped\": " << dropped() << "},\n\"traceEvents\": [\n";
+    std::vector<TraceEvent> evs = events();
+    for (size_t i = 0; i < evs.size(); ++i) {
+        const TraceEvent& e = evs[i];
+        // ts y dur en microsegundos
+        os << "  {\"name\": \"bmssp L" << e.level << "\", \"cat\": \"bmssp\", \"ph\": \"X\""
+           << ", \"pid\": 0, \"tid\": 0, \"ts\": " << e.start * 1e6 << ", \"dur\": " << e.elapsed * 1e6
+           << ", \"args\": {\"level\": " << e.level << ", \"S\": " << e.S << ", \"P\": " << e.P
+           << ", \"W\": " << e.W << ", \"U\": " << e.U << ", \"pulls\": " << e.pulls << ", \"B\": ";
+        write_bound(os, e.B);
+        os << ", \"B_prime\": ";
+        write_bound(os, e.B_prime);
+        os << ", \"partial\": " << (e.partial ? "true" : "false") << "}}"
+           << (i + 1 < evs.size() ? "," : "") << "\n";
+    }
+    os << "]}\n";
+    os.precision(old_precision);
+}
+
+void BmsspTrace::write_level_summary(std::ostream& os) const {
+    auto old_precision = os.precision(9);
+    os << "level,calls,mean_S,max_S,mean_P,mean_W,mean_U,max_U,pulls,partial,seconds\n";
+    for (size_t l = 0; l < summary.size(); ++l) {
+        const TraceLevelSummary& s = summary[l];
+        if (!s.calls) continue;
+        double c = (double)s.calls;
+        os << l << "," << s.calls << "," << s.sum_S / c << "," << s.max_S << "," << s.sum_P / c
+           << "," << s.sum_W / c << "," << s.sum_U / c << "," << s.max_U << "," << s.pulls
+           << "," << s.partial << "," << s.seconds << "\n";
+    }
+    os.precision(old_precision);
+}
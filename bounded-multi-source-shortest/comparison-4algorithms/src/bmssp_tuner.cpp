@@ -0,0 +1,232 @@
+#include "./../include/bmssp_tuner.h"
+#include "./../include/dijkstra.h"
+#include "./../include/validation.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <tuple>
+
+namespace {
+
+std::uint64_t mix64(std::uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+auto params_key(const BmsspParams& p) {
+    return std::make_tuple(p.levels, p.t, p.k, p.p_limit, p.block_size);
+}
+
+// Menos errores primero; a igualdad, menos tiempo medio
+bool better(const TuneCandidate& a, const TuneCandidate& b) {
+    if (a.mismatches != b.mismatches) return a.mismatches < b.mismatches;
+    return a.mean_seconds() < b.mean_seconds();
+}
+
+class Evaluator {
+private:
+    const Graph& graph;
+    const std::vector<Edge>& edges;
+    std::vector<Node> sources;
+    std::vector<std::unordered_map<Node, Weight>> reference;  // Dijkstra por fuente
+    ValidationOptions vopt;
+    std::unordered_map<Node, Weight> dist;
+    int n;
+
+public:
+    size_t runs = 0;
+
+    Evaluator(const Graph& g, const std::vector<Edge>& e, const TuneOptions& opt)
+        : graph(g), edges(e), n((int)g.size()) {
+        std::vector<Node> nodes;
+        nodes.reserve(g.size());
+        for (const auto& [u, _] : g) nodes.push_back(u);
+        std::sort(nodes.begin(), nodes.end());
+        std::mt19937 rng(opt.seed);
+        for (int i = 0; i < opt.samples && !nodes.empty(); ++i) {
+            sources.push_back(nodes[rng() % nodes.size()]);
+            reference.push_back(dijkstra(g, sources.back()));
+        }
+        vopt.tolerance = opt.tolerance;
+        vopt.max_report = 0;
+    }
+
+    int samples() const { return (int)sources.size(); }
+
+    // Mide c sobre las fuentes [c.evaluated, upto)
+    void run(TuneCandidate& c, int upto) {
+        const Weight INF = std::numeric_limits<Weight>::infinity();
+        for (int i = c.evaluated; i < std::min(upto, samples()); ++i) {
+            dist.clear();
+            dist.reserve(graph.size());
+            for (const auto& [u, _] : graph) dist[u] = INF;
+            dist[sources[i]] = 0.0;
+
+            auto t0 = std::chrono::steady_clock::now();
+            bmssp(graph, dist, edges, c.params, INF, {sources[i]}, n);
+            auto t1 = std::chrono::steady_clock::now();
+            c.seconds += std::chrono::duration<double>(t1 - t0).count();
+            c.mismatches += compare_all("bmssp", reference[i], dist, vopt).mismatches;
+            c.evaluated++;
+            runs++;
+        }
+    }
+};
+
+}  // namespace
+
+std::string graph_fingerprint(const Graph& graph) {
+    // Suma de hashes por arista: no depende del orden del unordered_map
+    std::uint64_t h = 0;
+    size_t m = 0;
+    for (const auto& [u, adj] : graph) {
+        h += mix64((std::uint64_t)(std::uint32_t)u * 0x9e3779b97f4a7c15ULL);
+        for (const auto& [v, w] : adj) {
+            // Bits del peso como double: la huella no depende de WEIGHT_FLOAT
+            double wd = w;
+            std::uint64_t wb;
+            std::memcpy(&wb, &wd, sizeof(wb));
+            h += mix64(((std::uint64_t)(std::uint32_t)u << 32 | (std::uint32_t)v) ^ mix64(wb));
+            m++;
+        }
+    }
+    std::ostringstream os;
+    os << "n" << graph.size() << "_m" << m << "_" << std::hex << h;
+    return os.str();
+}
+
+std::vector<BmsspParams> default_search_space(int n) {
+    BmsspParams base = bmssp_resolve_params(n);
+    std::set<int> levels = {std::max(1, base.levels - 1), base.levels, base.levels + 1};
+    std::set<int> ts = {std::max(1, base.t - 1), base.t, base.t + 1};
+    std::set<int> ks = {std::max(2, base.k - 1), base.k, base.k + 1, 2 * base.k};
+    const int p_limits[] = {0, 4, 64};     // 0 = sin tope
+    const int blocks[] = {0, 16, 256};     // 0 = min(|P|, 64)
+
+    std::vector<BmsspParams> space;
+    std::set<std::tuple<int, int, int, int, int>> seen;
+    for (int l : levels)
+        for (int t : ts)
+            for (int k : ks)
+                for (int pl : p_limits)
+                    for (int bs : blocks) {
+                        BmsspParams p;
+                        p.levels = l; p.t = t; p.k = k; p.p_limit = pl; p.block_size = bs;
+                        p = bmssp_resolve_params(n, p);
+                        if (seen.insert(params_key(p)).second) space.push_back(p);
+                    }
+    return space;
+}
+
+TuneResult tune_bmssp(const Graph& graph, const std::vector<Edge>& edges,
+                      const std::vector<BmsspParams>& space, const TuneOptions& opt) {
+    TuneResult result;
+    result.fingerprint = graph_fingerprint(graph);
+    Evaluator eval(graph, edges, opt);
+    int n = (int)graph.size();
+
+    std::vector<TuneCandidate> alive;
+    for (const auto& p : space) {
+        TuneCandidate c;
+        c.params = bmssp_resolve_params(n, p);
+        alive.push_back(c);
+    }
+    result.candidates = alive.size();
+
+    result.baseline.params = bmssp_resolve_params(n);
+    eval.run(result.baseline, eval.samples());
+    if (alive.empty() || eval.samples() == 0) {
+        result.best = result.baseline;
+        result.runs = eval.runs;
+        return result;
+    }
+
+    if (opt.method == TuneMethod::GRID) {
+        for (auto& c : alive) eval.run(c, eval.samples());
+        std::sort(alive.begin(), alive.end(), better);
+    } else {
+        // Todas las configuraciones con pocas fuentes; las mejores 1/eta
+        // pasan a la siguiente ronda con eta veces más fuentes
+        int eta = std::max(2, opt.eta);
+        int budget = 1;
+        while (alive.size() > 1) {
+            for (auto& c : alive) eval.run(c, budget);
+            std::sort(alive.begin(), alive.end(), better);
+            if (budget >= eval.samples()) break;
+            alive.resize(std::max<size_t>(1, alive.size() / eta));
+            budget = std::min(eval.samples(), budget * eta);
+        }
+        eval.run(alive.front(), eval.samples());
+    }
+
+    result.best = alive.front();
+    // Sin mejora frente a los valores por defecto se conservan éstos
+    if (!better(result.best, result.baseline)) result.best = result.baseline;
+    result.runs = eval.runs;
+    return result;
+}
+
+bool load_tuned_params(const std::string& path, const std::string& fingerprint, BmsspParams& out) {
+    std::ifstream in(path);
+    if (!in) return false;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream ls(line);
+        std::string fp;
+        BmsspParams p;
+        if (!(ls >> fp >> p.levels >> p.t >> p.k >> p.p_limit >> p.block_size)) continue;
+        if (fp == fingerprint) {
+            out = p;
+            return true;
+        }
+    }
+    return false;
+}
+
+void save_tuned_params(const std::string& path, const std::string& fingerprint, const BmsspParams& params) {
+    // Reescribe el fichero sustituyendo la línea de esta huella
+    std::vector<std::string> lines;
+    {
+        std::ifstream in(path);
+        std::string line;
+        while (std::getline(in, line)) {
+            std::istringstream ls(line);
+            std::string fp;
+            if ((ls >> fp) && fp == fingerprint) continue;
+            if (!line.empty()) lines.push_back(line);
+        }
+    }
+    if (lines.empty()) lines.push_back("# huella levels t k p_limit block_size");
+
+    std::ostringstream entry;
+    entry << fingerprint << " " << params.levels << " " << params.t << " " << params.k << " "
+          << params.p_limit << " " << params.block_size;
+    lines.push_back(entry.str());
+
+    std::ofstream out(path);
+    if (!out) throw std::runtime_error("cannot write tuning database: " + path);
+    for (const auto& l : lines) out << l << "\n";
+}
+
+std::string params_to_string(const BmsspParams& p) {
+    std::ostringstream os;
+    os << "levels=" << p.levels << " t=" << p.t << " k=" << p.k << " p_limit=";
+    if (p.p_limit > 0) os << p.p_limit;
+    else os << "none";
+    os << " block_size=";
+    if (p.block_size > 0) os << p.block_size;
+    else os << "auto";
+    return os.str();
+}
@@ -0,0 +1,66 @@
+#include "./../include/csr_graph.h"
+#include <algorithm>
+#include <cmath>
+
+Graph csr_to_graph(const CsrGraph& csr) {
+    int n = csr.num_nodes();
+    Graph graph;
+    graph.reserve(n);
+    for (Node u = 0; u < n; ++u) {
+        auto& adj = graph[u];
+        adj.reserve(csr.degree(u));
+        for (std::size_t e = csr.offsets[u]; e < csr.offsets[u + 1]; ++e) {
+            adj.push_back({csr.targets[e], csr.weights[e]});
+        }
+    }
+    return graph;
+}
+
+std::vector<Edge> csr_to_edges(const CsrGraph& csr) {
+    std::vector<Edge> edges;
+    edges.reserve(csr.num_edges());
+    for (Node u = 0; u < csr.num_nodes(); ++u) {
+        for (std::size_t e = csr.offsets[u]; e < csr.offsets[u + 1]; ++e) {
+            edges.push_back({u, csr.targets[e], csr.weights[e]});
+        }
+    }
+    return edges;
+}
+
+template <class W>
+BasicCsrGraph<W> cast_weights(const CsrGraph& csr, double scale, WeightCastReport* report) {
+    using T = WeightTraits<W>;
+    WeightCastReport local_report;
+    if (!report) report = &local_report;
+    *report = WeightCastReport();
+
+    BasicCsrGraph<W> out;
+    out.offsets = csr.offsets;
+    out.targets = csr.targets;
+    out.scale = scale;
+    out.weights.resize(csr.weights.size());
+
+    double max_w = 0.0;
+    for (std::size_t e = 0; e < csr.weights.size(); ++e) {
+        double x = csr.weights[e];
+        W w = T::from_double(x, scale);
+        out.weights[e] = w;
+        double back = T::to_double(w, scale);
+        double err = std::fabs(back - x);
+        report->max_abs_error = std::max(report->max_abs_error, err);
+        if (x != 0.0) report->max_rel_error = std::max(report->max_rel_error, err / std::fabs(x));
+        if (x > 0.0 && back == 0.0) report->zeroed++;
+        max_w = std::max(max_w, x);
+    }
+
+    report->path_bound = std::max(0, csr.num_nodes() - 1) * max_w;
+    double limit = T::to_double(T::inf() - 1, scale);
+    report->path_may_overflow = report->path_bound > limit;
+    // Error relativo acumulado de sumar hasta n-1 pesos redondeados
+    report->path_may_lose_precision = T::epsilon() * std::max(0, csr.num_nodes() - 1) > 1e-3;
+    return out;
+}
+
+template BasicCsrGraph<double> cast_weights<double>(const CsrGraph&, double, WeightCastReport*);
+template BasicCsrGraph<float> cast_weights<float>(const CsrGraph&, double, WeightCastReport*);
+template BasicCsrGraph<Fixed32> cast_weights<Fixed32>(const CsrGraph&, double, WeightCastReport*);
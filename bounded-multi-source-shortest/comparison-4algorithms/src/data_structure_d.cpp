@@ -1,13 +1,16 @@
 #include "./../include/data_structure_d.h"
 #include <algorithm>
+#include <cstdint>
+#include <functional>
 #include <stdexcept>
 
 void DataStructureD::cleanup() {
     while (!heap.empty()) {
-        auto [key, v] = heap.top();
-        auto it = best.find(v);
-        if (it == best.end() || it->second != key) {
-            heap.pop();
+        PackedKey key = heap.front();
+        auto it = best.find(key_node(key));
+        if (it == best.end() || monotone_bits(it->second) != key_bits(key)) {
+            std::pop_heap(heap.begin(), heap.end(), std::greater<PackedKey>());
+            heap.pop_back();
         } else {
             break;
         }
@@ -19,11 +22,20 @@ DataStructureD::DataStructureD(int M, double B_upper, int block_size)
     this->block_size = (block_size > 0) ? block_size : std::max(1, M / 8);
 }
 
+void DataStructureD::reset(int M, double B_upper, int block_size) {
+    heap.clear();
+    best.clear();
+    this->M = std::max(1, M);
+    this->B_upper = B_upper;
+    this->block_size = (block_size > 0) ? block_size : std::max(1, M / 8);
+}
+
 void DataStructureD::insert(Node v, Weight key) {
     auto it = best.find(v);
     if (it == best.end() || key < it->second) {
         best[v] = key;
-        heap.push({key, v});
+        heap.push_back(pack_key(key, v));
+        std::push_heap(heap.begin(), heap.end(), std::greater<PackedKey>());
     }
 }
 
@@ -39,24 +51,49 @@ bool DataStructureD::empty() {
 }
 
 std::pair<Weight, std::unordered_set<Node>> DataStructureD::pull() {
+    std::vector<Node> block;
+    Weight Bi = pull_into(block);
+    return {Bi, std::unordered_set<Node>(block.begin(), block.end())};
+}
+
+Weight DataStructureD::pull_into(std::vector<Node>& out) {
     cleanup();
     if (heap.empty()) {
         throw std::runtime_error("pull from empty D");
     }
     
-    Weight Bi = heap.top().first;
-    std::unordered_set<Node> Si;
-    
-    while (!heap.empty() && (int)Si.size() < block_size) {
-        auto [key, v] = heap.top();
-        heap.pop();
+    out.clear();
+    std::uint32_t last_bits = 0;
+    auto take_front = [&]() {
+        PackedKey key = heap.front();
+        std::pop_heap(heap.begin(), heap.end(), std::greater<PackedKey>());
+        heap.pop_back();
         
+        Node v = key_node(key);
         auto it = best.find(v);
-        if (it != best.end() && it->second == key) {
-            Si.insert(v);
+        if (it != best.end() && monotone_bits(it->second) == key_bits(key)) {
+            out.push_back(v);
+            last_bits = key_bits(key);
             best.erase(it);
         }
+    };
+    while (!heap.empty() && (int)out.size() < block_size) {
+        take_front();
     }
     
-    return {Bi, Si};
-}
\ No newline at end of file
+    // Los empates con el último extraído van en el mismo bloque: así toda
+    // clave que queda en D es estrictamente mayor que las del bloque, y el
+    // nodo empatado no queda fuera de la cota Bi del hijo ni de D
+    cleanup();
+    while (!heap.empty() && key_bits(heap.front()) == last_bits) {
+        take_front();
+        cleanup();
+    }
+    
+    // Cota que separa el bloque de lo que queda: la menor distancia con los
+    // bits de la cima o B_upper si D se vació. La clave exacta de la cima no
+    // sirve: otra entrada con sus mismos bits puede tener una menor, y quedaría
+    // por debajo de la cota del hijo sin estar en su S
+    if (heap.empty()) return B_upper;
+    return monotone_floor(key_bits(heap.front()));
+}
@@ -0,0 +1,115 @@
+#include "./../include/degree_reduction.h"
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Ciclo de un vértice reducido: posición 0 = el propio vértice, las
+// posiciones 1..deg-1 son ids consecutivos desde first
+struct Cycle {
+    Node first = 0;
+    int out = 0;      // las aristas de salida ocupan las posiciones [0, out)
+    int deg = 0;
+    int in_used = 0;  // aristas de entrada ya colocadas a partir de out
+
+    Node slot(Node self, int i) const { return i == 0 ? self : first + (i - 1); }
+};
+
+}  // namespace
+
+DegreeReduction reduce_degree(const Graph& graph, int max_degree) {
+    if (max_degree < 2) {
+        throw std::runtime_error("degree reduction needs max_degree >= 2, got " + std::to_string(max_degree));
+    }
+    auto t0 = std::chrono::steady_clock::now();
+    DegreeReduction r;
+
+    std::unordered_map<Node, int> indeg;
+    indeg.reserve(graph.size());
+    for (const auto& [u, adj] : graph) {
+        indeg[u];
+        r.max_original = std::max(r.max_original, u);
+        r.original_edges += adj.size();
+        for (const auto& [v, _] : adj) {
+            indeg[v]++;
+            r.max_original = std::max(r.max_original, v);
+        }
+    }
+    r.original_nodes = indeg.size();
+
+    // Ids nuevos en orden de id de vértice: el resultado no depende del
+    // orden del unordered_map
+    std::vector<Node> nodes;
+    nodes.reserve(indeg.size());
+    for (const auto& [u, _] : indeg) nodes.push_back(u);
+    std::sort(nodes.begin(), nodes.end());
+
+    std::unordered_map<Node, Cycle> cycles;
+    long long next = (long long)r.max_original + 1;
+    for (Node u : nodes) {
+        auto it = graph.find(u);
+        int out = it == graph.end() ? 0 : (int)it->second.size();
+        int deg = out + indeg[u];
+        if (deg <= max_degree) continue;
+        Cycle c;
+        c.first = (Node)next;
+        c.out = out;
+        c.deg = deg;
+        cycles.emplace(u, c);
+        next += deg - 1;
+        if (next - 1 > std::numeric_limits<Node>::max()) {
+            throw std::runtime_error("degree reduction: node ids overflow");
+        }
+    }
+    r.reduced_vertices = cycles.size();
+
+    Graph& g = r.graph;
+    g.reserve((size_t)(next - r.max_original - 1) + nodes.size());
+    for (Node u : nodes) {
+        auto cit = cycles.find(u);
+        if (cit == cycles.end()) {
+            g[u];
+            continue;
+        }
+        const Cycle& c = cit->second;
+        for (int i = 0; i < c.deg; ++i) {
+            g[c.slot(u, i)].push_back({c.slot(u, (i + 1) % c.deg), (Weight)0});
+        }
+    }
+
+    for (Node u : nodes) {
+        auto it = graph.find(u);
+        if (it == graph.end()) continue;
+        auto cu = cycles.find(u);
+        const auto& adj = it->second;
+        for (size_t j = 0; j < adj.size(); ++j) {
+            auto [v, w] = adj[j];
+            Node from = cu == cycles.end() ? u : cu->second.slot(u, (int)j);
+            Node to = v;
+            auto cv = cycles.find(v);
+            if (cv != cycles.end()) {
+                Cycle& c = cv->second;
+                to = c.slot(v, c.out + c.in_used++);
+            }
+            g[from].push_back({to, w});
+        }
+    }
+
+    for (const auto& [_, adj] : g) r.edges += adj.size();
+    r.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return r;
+}
+
+std::unordered_map<Node, Weight> map_back_distances(const DegreeReduction& reduction,
+                                                    const std::unordered_map<Node, Weight>& dist) {
+    std::unordered_map<Node, Weight> out;
+    out.reserve(reduction.original_nodes);
+    for (const auto& [u, d] : dist) {
+        if (u <= reduction.max_original) out.emplace(u, d);
+    }
+    return out;
+}
@@ -1,44 +1,141 @@
 #include "./../include/dijkstra.h"
+#include "./../include/instrumentation.h"
+#include "./../include/packed_key.h"
 #include <queue>
 #include <limits>
 
 std::unordered_map<Node, Weight> dijkstra(
-    const Graph& graph, Node source, Instrument* instr) {
+    const Graph& graph, Node source, Instrument* instr, std::pmr::memory_resource* mem, CancelToken* cancel) {
     
     Instrument local_instr;
     if (!instr) instr = &local_instr;
     
+    // La pasada O(n) también consulta el token: en grafos grandes tarda más
+    // que un plazo corto. Reservar evita los rehash, que eran la mayor parte
+    // de su coste.
+    CancelPoll poll(cancel);
     std::unordered_map<Node, Weight> dist;
+    dist.reserve(graph.size());
     for (const auto& [node, _] : graph) {
+        if (poll.stop()) {
+            dist[source] = 0.0;
+            return dist;
+        }
         dist[node] = std::numeric_limits<Weight>::infinity();
     }
     dist[source] = 0.0;
     
-    using PQPair = std::pair<Weight, Node>;
-    std::priority_queue<PQPair, std::vector<PQPair>, std::greater<PQPair>> heap;
+    // Claves empaquetadas (packed_key.h): la distancia exacta está en dist y
+    // una entrada es vigente mientras sus bits coincidan con los de dist[u].
+    // Si dos distancias comparten bits, u puede procesarse dos veces; cada
+    // mejora estricta vuelve a encolar, así que el resultado sigue siendo exacto.
+    if (!mem) mem = std::pmr::get_default_resource();
+    std::priority_queue<PackedKey, std::pmr::vector<PackedKey>, std::greater<PackedKey>> heap{
+        std::greater<PackedKey>(), std::pmr::vector<PackedKey>(mem)};
     
-    heap.push({0.0, source});
-    instr->heap_ops++;
+    heap.push(pack_key(0.0, source));
+    INSTR_ADD(instr, heap_ops, 1);
     
+    std::int64_t work = 1;  // extracción y aristas de la anterior
     while (!heap.empty()) {
-        auto [d_u, u] = heap.top();
+        if (poll.stop(work)) break;
+        work = 1;
+        PackedKey key = heap.top();
         heap.pop();
-        instr->heap_ops++;
+        INSTR_ADD(instr, heap_ops, 1);
         
-        if (d_u > dist[u]) continue;
+        Node u = key_node(key);
+        Weight d_u = dist[u];
+        if (key_bits(key) > monotone_bits(d_u)) {
+            INSTR_ADD(instr, stale_pops, 1);
+            continue;
+        }
+        INSTR_ADD(instr, settled, 1);
         
-        if (graph.find(u) != graph.end()) {
-            for (const auto& [v, w] : graph.at(u)) {
-                instr->relaxations++;
+        auto it = graph.find(u);
+        if (it != graph.end()) {
+            work += (std::int64_t)it->second.size();
+            for (const auto& [v, w] : it->second) {
+                INSTR_ADD(instr, relaxations, 1);
                 Weight alt = d_u + w;
                 if (alt < dist[v]) {
                     dist[v] = alt;
-                    heap.push({alt, v});
-                    instr->heap_ops++;
+                    heap.push(pack_key(alt, v));
+                    INSTR_ADD(instr, heap_ops, 1);
+                    INSTR_HEAP(instr, heap.size());
                 }
             }
         }
     }
     
     return dist;
-}
\ No newline at end of file
+}
+template <class G>
+std::vector<typename G::weight_type> dijkstra_indexed(
+    const G& graph, Node source, Instrument* instr, std::pmr::memory_resource* mem, CancelToken* cancel) {
+    using W = typename G::weight_type;
+    using T = WeightTraits<W>;
+    Instrument local_instr;
+    if (!instr) instr = &local_instr;
+
+    int n = graph.num_nodes();
+    std::vector<W> dist((std::size_t)n, T::inf());
+    if (source < 0 || source >= n) return dist;
+    dist[source] = W(0);
+
+    // Con float/Fixed32 cada entrada ocupa 8 bytes en lugar de 16
+    using PQPair = std::pair<W, Node>;
+    if (!mem) mem = std::pmr::get_default_resource();
+    std::priority_queue<PQPair, std::pmr::vector<PQPair>, std::greater<PQPair>> heap{
+        std::greater<PQPair>(), std::pmr::vector<PQPair>(mem)};
+
+    heap.push({W(0), source});
+    INSTR_ADD(instr, heap_ops, 1);
+
+    CancelPoll poll(cancel);
+    std::int64_t work = 1;  // extracción y aristas de la anterior
+    while (!heap.empty()) {
+        if (poll.stop(work)) break;
+        work = 1;
+        auto [d_u, u] = heap.top();
+        heap.pop();
+        INSTR_ADD(instr, heap_ops, 1);
+
+        if (d_u > dist[u]) {
+            INSTR_ADD(instr, stale_pops, 1);
+            continue;
+        }
+        INSTR_ADD(instr, settled, 1);
+
+        graph.for_each_out(u, [&](Node v, W w) {
+            INSTR_ADD(instr, relaxations, 1);
+            ++work;
+            W alt = T::add(d_u, w);
+            if (alt < dist[v]) {
+                dist[v] = alt;
+                heap.push({alt, v});
+                INSTR_ADD(instr, heap_ops, 1);
+                INSTR_HEAP(instr, heap.size());
+            }
+        });
+    }
+
+    return dist;
+}
+
+template <class W>
+std::vector<W> dijkstra_csr(
+    const BasicCsrGraph<W>& graph, Node source, Instrument* instr, std::pmr::memory_resource* mem,
+    CancelToken* cancel) {
+    return dijkstra_indexed(graph, source, instr, mem, cancel);
+}
+
+template std::vector<Weight> dijkstra_indexed<GridGraph>(
+    const GridGraph&, Node, Instrument*, std::pmr::memory_resource*, CancelToken*);
+
+template std::vector<double> dijkstra_csr<double>(
+    const BasicCsrGraph<double>&, Node, Instrument*, std::pmr::memory_resource*, CancelToken*);
+template std::vector<float> dijkstra_csr<float>(
+    const BasicCsrGraph<float>&, Node, Instrument*, std::pmr::memory_resource*, CancelToken*);
+template std::vector<Fixed32> dijkstra_csr<Fixed32>(
+    const BasicCsrGraph<Fixed32>&, Node, Instrument*, std::pmr::memory_resource*, CancelToken*);
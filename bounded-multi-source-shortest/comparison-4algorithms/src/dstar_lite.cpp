@@ -1,184 +1,269 @@
 #include "./../include/dstar_lite.h"
+#include "./../include/instrumentation.h"
+#include "./../include/csr_graph.h"
+#include "./../include/grid_graph.h"
 #include <queue>
 #include <limits>
 #include <cmath>
 #include <algorithm>
 
-DStarLite::DStarLite(const Graph& g, Node s, Node g_goal, const HeuristicFunction& h, Instrument* instr)
-    : graph(g), start(s), goal(g_goal), heuristic(h), instrument(instr), km(0.0) {
+namespace {
+
+const Weight INF = std::numeric_limits<Weight>::infinity();
+
+}  // namespace
+
+template <class G>
+BasicDStarLite<G>::BasicDStarLite(const G& g, Predecessors<G>& p, Node s, Node g_goal, const HeuristicFunction& h,
+                                  Instrument* instr, std::pmr::memory_resource* mem, CancelToken* cancel_token)
+    : graph(g), start(s), goal(g_goal), heuristic(h), instrument(instr),
+      memory(mem ? mem : std::pmr::get_default_resource()),
+      g_cost(g, INF, memory),
+      rhs_cost(g, INF, memory),
+      h_cost(g, -1.0, memory),
+      preds(p),
+      open_list(std::greater<DStarLiteNode>(), std::pmr::vector<DStarLiteNode>(memory)),
+      open_key(g, Key(INF, INF), memory), km(0.0), closed(memory), incons(memory), cancel(cancel_token) {
     initialize();
 }
 
-void DStarLite::initialize() {
-    Instrument local_instr;
-    if (!instrument) instrument = &local_instr;
-    
-    // Optimización: reservar espacio para evitar reallocaciones
-    g_cost.reserve(graph.size());
-    rhs_cost.reserve(graph.size());
-    h_cost.reserve(graph.size());
-    
-    // Inicializar costos
-    for (const auto& [node, _] : graph) {
-        g_cost[node] = std::numeric_limits<Weight>::infinity();
-        rhs_cost[node] = std::numeric_limits<Weight>::infinity();
-        h_cost[node] = heuristic(node, goal);
-    }
+template <class G>
+void BasicDStarLite<G>::initialize() {
+    if (!instrument) instrument = &local_instrument;
     
+    // g y rhs ya empiezan en infinito; h se rellena al primer uso
     rhs_cost[goal] = 0.0;
-    auto key = calculate_key(goal);
-    open_list.push(DStarLiteNode(goal, key.first, rhs_cost[goal], key.first));
-    open_set.insert(goal);
-    instrument->heap_ops++;
+    push_open(goal);
+}
+
+template <class G>
+Weight BasicDStarLite<G>::h(Node u) {
+    Weight& h_u = h_cost[u];
+    if (h_u < 0) h_u = heuristic(start, u);
+    return h_u;
 }
 
-std::pair<Weight, Weight> DStarLite::calculate_key(Node u) {
-    Weight g_val = std::min(g_cost[u], rhs_cost[u]);
-    return std::make_pair(g_val + h_cost[u] + km, g_val);
+template <class G>
+typename BasicDStarLite<G>::Key BasicDStarLite<G>::calculate_key(Node u) {
+    // Sobreconsistente: h pesa epsilon; con epsilon = 1, la clave de D*-lite
+    Weight g_val = g_cost.get(u), rhs_val = rhs_cost.get(u);
+    if (g_val > rhs_val) return Key(rhs_val + (Weight)epsilon * h(u) + km, rhs_val);
+    return Key(g_val + h(u) + km, g_val);
 }
 
-void DStarLite::update_vertex(Node u) {
+template <class G>
+void BasicDStarLite<G>::push_open(Node u) {
+    Key key = calculate_key(u);
+    open_key[u] = key;
+    open_list.push(DStarLiteNode(u, key.second, rhs_cost.get(u), key.first));
+    INSTR_ADD(instrument, heap_ops, 1);
+    INSTR_HEAP(instrument, open_list.size());
+}
+
+template <class G>
+void BasicDStarLite<G>::update_vertex(Node u) {
     if (u != goal) {
-        Weight min_rhs = std::numeric_limits<Weight>::infinity();
-        
-        if (graph.find(u) != graph.end()) {
-            for (const auto& [v, w] : graph.at(u)) {
-                instrument->relaxations++;
-                Weight cost = g_cost[v] + w;
-                min_rhs = std::min(min_rhs, cost);
-            }
-        }
-        
+        Weight min_rhs = INF;
+        for_each_out(graph, u, [&](Node v, Weight w) {
+            INSTR_ADD(instrument, relaxations, 1);
+            ++work;
+            min_rhs = std::min(min_rhs, g_cost.get(v) + w);
+        });
         rhs_cost[u] = min_rhs;
     }
     
-    // Remover de open_list si está presente
-    if (open_set.find(u) != open_set.end()) {
-        open_set.erase(u);
-        // Recrear priority_queue sin el nodo u
-        std::priority_queue<DStarLiteNode, std::vector<DStarLiteNode>, std::greater<DStarLiteNode>> new_queue;
-        std::unordered_set<Node> new_set;
-        
-        while (!open_list.empty()) {
-            DStarLiteNode node = open_list.top();
-            open_list.pop();
-            if (node.node != u) {
-                new_queue.push(node);
-                new_set.insert(node.node);
-            }
-        }
-        
-        open_list = std::move(new_queue);
-        open_set = std::move(new_set);
+    // La entrada anterior de u, si la hay, queda obsoleta. Un nodo cerrado
+    // en esta iteración no vuelve a OPEN: espera en INCONS
+    const bool consistent = g_cost.get(u) == rhs_cost.get(u);
+    if (!consistent && (closed.empty() || !closed.count(u))) {
+        push_open(u);
+        return;
     }
-    
-    // Agregar a open_list si g != rhs
-    if (g_cost[u] != rhs_cost[u]) {
-        auto key_pair = calculate_key(u);
-        Weight key = key_pair.first;
-        open_list.push(DStarLiteNode(u, key, rhs_cost[u], key));
-        open_set.insert(u);
-        instrument->heap_ops++;
+    if (open_key.get(u).first != INF) open_key[u] = Key(INF, INF);
+    if (!consistent) incons.insert(u);
+}
+
+template <class G>
+void BasicDStarLite<G>::reopen() {
+    // Las entradas vigentes vuelven con la clave de ahora, junto con INCONS
+    OpenQueue old{std::greater<DStarLiteNode>(), std::pmr::vector<DStarLiteNode>(memory)};
+    old.swap(open_list);
+    for (; !old.empty(); old.pop()) {
+        const DStarLiteNode e = old.top();
+        if (open_key.get(e.node) == Key(e.f_cost, e.g_cost)) push_open(e.node);
     }
+    for (Node u : incons) {
+        if (g_cost.get(u) != rhs_cost.get(u)) push_open(u);
+    }
+    incons.clear();
+    closed.clear();
+    rekey = false;
+}
+
+template <class G>
+void BasicDStarLite<G>::set_epsilon(double eps) {
+    epsilon = eps;
+    rekey = true;
 }
 
-void DStarLite::compute_shortest_path() {
+template <class G>
+void BasicDStarLite<G>::move_start(Node s) {
+    if (s == start) return;
+    start = s;
+    h_cost.fill(-1.0);
+    rekey = true;
+}
+
+template <class G>
+bool BasicDStarLite<G>::compute_shortest_path(BudgetMeter* meter) {
+    if (rekey) reopen();
+    CancelPoll poll(cancel);
+    interrupted = false;
+    work = 1;
     while (!open_list.empty()) {
-        DStarLiteNode current = open_list.top();
+        if (poll.stop(work)) {
+            interrupted = true;
+            return false;
+        }
+        work = 1;
+        const DStarLiteNode top = open_list.top();
+        const Node u = top.node;
+        const Key k_old(top.f_cost, top.g_cost);
+        if (open_key.get(u) != k_old) {
+            open_list.pop();
+            INSTR_ADD(instrument, stale_pops, 1);
+            continue;
+        }
+        // Termina cuando start es consistente y ninguna clave abierta es menor
+        if (!(k_old < calculate_key(start)) && rhs_cost.get(start) == g_cost.get(start)) break;
+        if (meter && !meter->expand()) return false;
         open_list.pop();
-        instrument->heap_ops++;
-        
-        Node u = current.node;
-        Weight k_old = current.f_cost;
-        auto k_new_pair = calculate_key(u);
-        Weight k_new = k_new_pair.first;
+        INSTR_ADD(instrument, heap_ops, 1);
         
+        Key k_new = calculate_key(u);
         if (k_old < k_new) {
-            open_list.push(DStarLiteNode(u, k_new, rhs_cost[u], k_new));
-            instrument->heap_ops++;
+            push_open(u);
             continue;
         }
+        open_key[u] = Key(INF, INF);
         
-        if (g_cost[u] > rhs_cost[u]) {
-            g_cost[u] = rhs_cost[u];
-            
-            if (graph.find(u) != graph.end()) {
-                for (const auto& [v, w] : graph.at(u)) {
-                    update_vertex(v);
-                }
-            }
+        if (g_cost.get(u) > rhs_cost.get(u)) {
+            g_cost[u] = rhs_cost.get(u);
+            if (epsilon > 1.0) closed.insert(u);
+            INSTR_ADD(instrument, settled, 1);
+            preds.for_each(u, [this](Node p) { update_vertex(p); });
         } else {
-            g_cost[u] = std::numeric_limits<Weight>::infinity();
-            
-            if (graph.find(u) != graph.end()) {
-                for (const auto& [v, w] : graph.at(u)) {
-                    update_vertex(v);
-                }
-            }
+            g_cost[u] = INF;
+            preds.for_each(u, [this](Node p) { update_vertex(p); });
             update_vertex(u);
         }
-        
-        if (u == start) {
-            break;
-        }
     }
+    return true;
 }
 
-std::unordered_map<Node, Weight> DStarLite::find_path() {
-    compute_shortest_path();
-    
-    // Reconstruir camino desde start hasta goal
-    std::unordered_map<Node, Weight> dist;
+template <class G>
+bool BasicDStarLite<G>::path(std::vector<Node>& nodes, Weight& cost) const {
+    // El tope de pasos evita ciclos si algún g aún no es consistente
+    nodes.clear();
+    cost = 0;
     Node current = start;
-    
-    while (current != goal && g_cost[current] != std::numeric_limits<Weight>::infinity()) {
-        dist[current] = g_cost[current];
-        
+    nodes.push_back(current);
+    for (std::size_t steps = node_count(graph); current != goal && g_cost.get(current) != INF && steps > 0; --steps) {
         Node next = current;
-        Weight min_cost = std::numeric_limits<Weight>::infinity();
-        
-        if (graph.find(current) != graph.end()) {
-            for (const auto& [v, w] : graph.at(current)) {
-                Weight cost = g_cost[v] + w;
-                if (cost < min_cost) {
-                    min_cost = cost;
-                    next = v;
-                }
+        Weight min_cost = INF, step = INF;
+        for_each_out(graph, current, [&](Node v, Weight w) {
+            Weight c = g_cost.get(v) + w;
+            if (c < min_cost) {
+                min_cost = c;
+                step = w;
+                next = v;
             }
-        }
-        
-        if (next == current) break; // No hay camino válido
+        });
+        if (next == current) break;  // No hay camino válido
+        cost += step;
         current = next;
+        nodes.push_back(current);
     }
-    
-    if (current == goal) {
-        dist[goal] = g_cost[goal];
+    return current == goal;
+}
+
+template <class G>
+std::unordered_map<Node, Weight> BasicDStarLite<G>::find_path() {
+    // Camino desde start con el g de cada nodo; goal solo si se alcanza
+    std::unordered_map<Node, Weight> dist;
+    if (!compute_shortest_path()) return dist;
+    std::vector<Node> nodes;
+    Weight cost;
+    path(nodes, cost);
+    for (Node u : nodes) {
+        if (g_cost.get(u) != INF) dist[u] = g_cost.get(u);
     }
-    
     return dist;
 }
 
-void DStarLite::update_graph(const std::vector<Edge>& changed_edges) {
-    km += heuristic(start, goal);
-    
+template <class G>
+void BasicDStarLite<G>::update_graph(const std::vector<Edge>& changed_edges) {
+    // rhs(from) depende del coste de from -> to
     for (const auto& edge : changed_edges) {
+        preds.add(edge.from, edge.to);
         update_vertex(edge.from);
     }
 }
 
-std::unordered_map<Node, Weight> DStarLite::replan() {
-    compute_shortest_path();
+template <class G>
+std::unordered_map<Node, Weight> BasicDStarLite<G>::replan() {
     return find_path();
 }
 
+template class BasicDStarLite<Graph>;
+template class BasicDStarLite<CsrGraph>;
+template class BasicDStarLite<GridGraph>;
+
 // Función wrapper para compatibilidad
+template <class G>
 std::unordered_map<Node, Weight> dstar_lite(
-    const Graph& graph, 
-    Node source, 
+    const G& graph,
+    Predecessors<G>& preds,
+    Node source,
     Node target,
     const HeuristicFunction& heuristic,
-    Instrument* instr) {
+    Instrument* instr,
+    std::pmr::memory_resource* mem,
+    CancelToken* cancel) {
     
-    DStarLite planner(graph, source, target, heuristic, instr);
+    BasicDStarLite<G> planner(graph, preds, source, target, heuristic, instr, mem, cancel);
     return planner.find_path();
 }
+
+template <class G>
+std::unordered_map<Node, Weight> dstar_lite(
+    const G& graph,
+    Node source,
+    Node target,
+    const HeuristicFunction& heuristic,
+    Instrument* instr,
+    std::pmr::memory_resource* mem,
+    CancelToken* cancel) {
+
+    Predecessors<G> preds(graph, mem);
+    return dstar_lite(graph, preds, source, target, heuristic, instr, mem, cancel);
+}
+
+template std::unordered_map<Node, Weight> dstar_lite<Graph>(
+    const Graph&, Predecessors<Graph>&, Node, Node, const HeuristicFunction&, Instrument*,
+    std::pmr::memory_resource*, CancelToken*);
+template std::unordered_map<Node, Weight> dstar_lite<CsrGraph>(
+    const CsrGraph&, Predecessors<CsrGraph>&, Node, Node, const HeuristicFunction&, Instrument*,
+    std::pmr::memory_resource*, CancelToken*);
+template std::unordered_map<Node, Weight> dstar_lite<GridGraph>(
+    const GridGraph&, Predecessors<GridGraph>&, Node, Node, const HeuristicFunction&, Instrument*,
+    std::pmr::memory_resource*, CancelToken*);
+template std::unordered_map<Node, Weight> dstar_lite<Graph>(
+    const Graph&, Node, Node, const HeuristicFunction&, Instrument*, std::pmr::memory_resource*,
+    CancelToken*);
+template std::unordered_map<Node, Weight> dstar_lite<CsrGraph>(
+    const CsrGraph&, Node, Node, const HeuristicFunction&, Instrument*, std::pmr::memory_resource*,
+    CancelToken*);
+template std::unordered_map<Node, Weight> dstar_lite<GridGraph>(
+    const GridGraph&, Node, Node, const HeuristicFunction&, Instrument*, std::pmr::memory_resource*,
+    CancelToken*);
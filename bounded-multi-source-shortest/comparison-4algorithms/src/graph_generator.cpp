@@ -1,229 +1,405 @@
 #include "./../include/graph_generator.h"
-#include <random>
+#include "./../include/philox.h"
+#include "./../include/thread_pool.h"
 #include <algorithm>
-#include <unordered_set>
-#include <numeric>
-
-static inline void ensure_node(Graph& G, Node u) {
-    if (!G.count(u)) G[u] = std::vector<std::pair<Node, Weight>>{};
+#include <atomic>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <memory_resource>
+#include <thread>
+
+// Todos los generadores emiten CSR directamente. Los nodos origen se reparten
+// en bloques de tamaño fijo y cada bloque usa su propio stream Philox, de modo
+// que el grafo generado es idéntico para cualquier número de hilos.
+
+namespace {
+
+const int NODE_BLOCK = 1 << 12;
+const std::size_t EDGE_BLOCK = 1 << 16;
+
+// Identificadores de stream por generador, para no reutilizar secuencias
+enum : uint64_t {
+    SALT_RANDOM_M = 1, SALT_ER, SALT_BA, SALT_WS, SALT_GRID, SALT_DAG, SALT_GRID_CELL,
+    SALT_GRID_OCCUPANCY
+};
+
+inline uint64_t stream_id(uint64_t salt, uint64_t block) {
+    return (salt << 48) | block;
 }
-static inline void add_edge(Graph& G, std::vector<Edge>& E, Node u, Node v, Weight w) {
-    ensure_node(G,u); ensure_node(G,v);
-    G[u].push_back({v,w});
-    E.push_back({u,v,w});
+
+int resolve_threads(int threads) {
+    if (threads > 0) return threads;
+    return std::max(1, (int)std::thread::hardware_concurrency());
 }
 
-std::pair<Graph, std::vector<Edge>> generate_sparse_directed_graph(
-    int n, int m, double max_w, unsigned seed) {
-    
-    std::mt19937 rng(seed);
-    std::uniform_real_distribution<double> weight_dist(1.0, max_w);
-    std::uniform_int_distribution<int> node_dist(0, n - 1);
-    
-    Graph graph;
-    std::vector<Edge> edges;
-    
-    for (int i = 0; i < n; ++i) {
-        graph[i] = std::vector<std::pair<Node, Weight>>();
-    }
-    
-
-    for (int i = 1; i < n; ++i) {
-        std::uniform_int_distribution<int> prev_dist(0, i - 1);
-        int u = prev_dist(rng);
-        double w = weight_dist(rng);
-        graph[u].push_back({i, w});
-        edges.push_back({u, i, w});
-    }
-    
-    int remaining = std::max(0, m - (n - 1));
-    for (int i = 0; i < remaining; ++i) {
-        int u = node_dist(rng);
-        int v = node_dist(rng);
-        double w = weight_dist(rng);
-        graph[u].push_back({v, w});
-        edges.push_back({u, v, w});
+void parallel_for_blocks(std::size_t blocks, int threads, const std::function<void(std::size_t)>& fn) {
+    threads = (int)std::min<std::size_t>(resolve_threads(threads), blocks);
+    if (threads <= 1) {
+        for (std::size_t b = 0; b < blocks; ++b) fn(b);
+        return;
     }
-    
-    return {graph, edges};
+    // threads carriles sobre el pool global que toman bloques de un contador
+    std::atomic<std::size_t> next{0};
+    auto worker = [&]() {
+        for (std::size_t b = next++; b < blocks; b = next++) fn(b);
+    };
+    TaskGroup group;
+    for (int t = 1; t < threads; ++t) group.run(worker);
+    worker();
+    group.wait();
 }
 
-std::pair<Graph, std::vector<Edge>> generate_er_directed(
-    int n, double p, double max_w, unsigned seed) 
-{
-    Graph G; std::vector<Edge> E; G.reserve(n);
-    std::mt19937 rng(seed);
-    std::uniform_real_distribution<double> U(0.0,1.0);
-    std::uniform_real_distribution<double> W(1.0, max_w);
+// Adyacencias de un bloque de nodos origen consecutivos. Los vectores crecen
+// arista a arista desde una arena propia del bloque (solo la usa un hilo),
+// que se libera entera al copiar el bloque al CSR.
+struct SourceBlock {
+    std::pmr::monotonic_buffer_resource arena;
+    std::pmr::vector<std::size_t> degree{&arena};
+    std::pmr::vector<Node> targets{&arena};
+    std::pmr::vector<Weight> weights{&arena};
+};
+
+// emit(u, rng, targets, weights) añade las aristas salientes de u en orden.
+// Los bloques se concatenan en orden de nodo, así que el resultado ya es CSR.
+template <class EmitSource>
+CsrGraph build_by_source(int n, unsigned seed, uint64_t salt, int threads, EmitSource emit) {
+    CsrGraph csr;
+    n = std::max(0, n);
+    csr.offsets.assign((std::size_t)n + 1, 0);
+    std::size_t blocks = ((std::size_t)n + NODE_BLOCK - 1) / NODE_BLOCK;
+    std::vector<std::unique_ptr<SourceBlock>> parts(blocks);
+
+    parallel_for_blocks(blocks, threads, [&](std::size_t b) {
+        Philox4x32 rng(seed, stream_id(salt, b));
+        parts[b].reset(new SourceBlock());
+        SourceBlock& part = *parts[b];
+        Node first = (Node)(b * NODE_BLOCK);
+        Node last = std::min<Node>(n, first + NODE_BLOCK);
+        part.degree.resize(last - first);
+        for (Node u = first; u < last; ++u) {
+            std::size_t before = part.targets.size();
+            emit(u, rng, part.targets, part.weights);
+            part.degree[u - first] = part.targets.size() - before;
+        }
+    });
 
-    for (int u=0; u<n; ++u) ensure_node(G,u);
-    for (int u=0; u<n; ++u) for (int v=0; v<n; ++v) if (u!=v)
-        if (U(rng) < p) add_edge(G,E,u,v,W(rng));
-    return {G,E};
+    for (std::size_t b = 0; b < blocks; ++b) {
+        Node first = (Node)(b * NODE_BLOCK);
+        for (std::size_t i = 0; i < parts[b]->degree.size(); ++i) {
+            csr.offsets[first + i + 1] = csr.offsets[first + i] + parts[b]->degree[i];
+        }
+    }
+    csr.targets.resize(csr.offsets[n]);
+    csr.weights.resize(csr.offsets[n]);
+
+    parallel_for_blocks(blocks, threads, [&](std::size_t b) {
+        SourceBlock& part = *parts[b];
+        std::size_t base = csr.offsets[b * NODE_BLOCK];
+        std::copy(part.targets.begin(), part.targets.end(), csr.targets.begin() + base);
+        std::copy(part.weights.begin(), part.weights.end(), csr.weights.begin() + base);
+        parts[b].reset();
+    });
+    return csr;
 }
 
-std::pair<Graph, std::vector<Edge>> generate_ba_directed(
-    int n, int attach, double max_w, unsigned seed) 
-{
-    Graph G; std::vector<Edge> E; G.reserve(n);
-    if (n<=0) return {G,E};
-
-    std::mt19937 rng(seed);
-    std::uniform_real_distribution<double> W(1.0, max_w);
-
-
-    auto add = [&](int u, int v) {
-        add_edge(G, E, u, v, W(rng));
-    };
-
-
-    int init = std::min(n, std::max(2, attach+1));
-    for (int u=0; u<init; ++u) ensure_node(G,u);
-    for (int u=0; u<init; ++u)
-        for (int v=0; v<init; ++v)
-            if (u!=v) add(u, v);
+// Salto geométrico: número de candidatos descartados antes del siguiente
+// éxito de un Bernoulli(p). Evita sortear cada par (u, v) por separado.
+inline long long geometric_skip(Philox4x32& rng, double log_q) {
+    double r = std::log1p(-rng.uniform01()) / log_q;
+    return r >= 9.0e18 ? (long long)9.0e18 : (long long)r;
+}
 
+CsrGraph csr_random_m(int n, int m, double max_w, unsigned seed, int threads) {
+    CsrGraph csr;
+    if (n <= 0) return csr;
+
+    // Árbol aleatorio (conectividad desde 0) + aristas uniformes extra. Los
+    // orígenes son aleatorios, así que se generan por bloques de aristas y se
+    // colocan con un counting sort secuencial que preserva el orden.
+    std::size_t tree = (std::size_t)n - 1;
+    std::size_t total = tree + (std::size_t)std::max(0, m - (n - 1));
+    std::size_t blocks = (total + EDGE_BLOCK - 1) / EDGE_BLOCK;
+    std::vector<std::vector<Edge>> parts(blocks);
+
+    parallel_for_blocks(blocks, threads, [&](std::size_t b) {
+        Philox4x32 rng(seed, stream_id(SALT_RANDOM_M, b));
+        std::size_t first = b * EDGE_BLOCK;
+        std::size_t last = std::min(total, first + EDGE_BLOCK);
+        auto& out = parts[b];
+        out.reserve(last - first);
+        for (std::size_t i = first; i < last; ++i) {
+            Node u, v;
+            if (i < tree) {
+                v = (Node)(i + 1);
+                u = (Node)rng.below((uint32_t)v);
+            } else {
+                u = (Node)rng.below((uint32_t)n);
+                v = (Node)rng.below((uint32_t)n);
+            }
+            out.push_back({u, v, (Weight)rng.uniform(1.0, max_w)});
+        }
+    });
+
+    csr.offsets.assign((std::size_t)n + 1, 0);
+    for (const auto& part : parts)
+        for (const Edge& e : part) csr.offsets[e.from + 1]++;
+    for (int u = 0; u < n; ++u) csr.offsets[u + 1] += csr.offsets[u];
+
+    csr.targets.resize(total);
+    csr.weights.resize(total);
+    std::vector<std::size_t> cursor(csr.offsets.begin(), csr.offsets.end() - 1);
+    for (auto& part : parts) {
+        for (const Edge& e : part) {
+            std::size_t pos = cursor[e.from]++;
+            csr.targets[pos] = e.to;
+            csr.weights[pos] = e.weight;
+        }
+        part = std::vector<Edge>();
+    }
+    return csr;
+}
 
-    std::vector<int> targets; 
-    targets.reserve((int)E.size()*2);
+CsrGraph csr_er(int n, double p, double max_w, unsigned seed, int threads) {
+    double log_q = std::log1p(-std::min(p, 1.0 - 1e-12));
+    long long candidates = n - 1;
+    return build_by_source(n, seed, SALT_ER, threads,
+        [&](Node u, Philox4x32& rng, std::pmr::vector<Node>& tgt, std::pmr::vector<Weight>& w) {
+            if (p <= 0.0) return;
+            // candidato c -> destino v, saltando el lazo u -> u
+            for (long long c = geometric_skip(rng, log_q); c < candidates;
+                 c += 1 + geometric_skip(rng, log_q)) {
+                tgt.push_back((Node)(c < u ? c : c + 1));
+                w.push_back(rng.uniform(1.0, max_w));
+            }
+        });
+}
 
-    for (const auto& ed : E) {
-        targets.push_back(ed.from);
-        targets.push_back(ed.to);  
+CsrGraph csr_ba(int n, int attach, double max_w, unsigned seed) {
+    // La conexión preferencial depende de todas las aristas anteriores y no
+    // se paraleliza; los orígenes salen en orden creciente, así que las
+    // aristas se escriben directamente en CSR.
+    CsrGraph csr;
+    if (n <= 0) return csr;
+    Philox4x32 rng(seed, stream_id(SALT_BA, 0));
+    csr.offsets.assign((std::size_t)n + 1, 0);
+
+    int init = std::min(n, std::max(2, attach + 1));
+    std::size_t max_edges = (std::size_t)init * (init - 1) + (std::size_t)(n - init) * std::max(0, attach);
+    csr.targets.reserve(max_edges);
+    csr.weights.reserve(max_edges);
+    std::vector<Node> endpoints;
+    endpoints.reserve((std::size_t)init * init * 2 + (std::size_t)n * std::max(0, attach) * 2);
+
+    for (int u = 0; u < init; ++u) {
+        for (int v = 0; v < init; ++v) {
+            if (u == v) continue;
+            csr.targets.push_back(v);
+            csr.weights.push_back(rng.uniform(1.0, max_w));
+            endpoints.push_back(u);
+            endpoints.push_back(v);
+        }
+        csr.offsets[u + 1] = csr.targets.size();
     }
 
-    std::uniform_int_distribution<int> R(0, std::max(0,(int)targets.size()-1));
-
+    std::vector<Node> chosen;
     for (int u = init; u < n; ++u) {
-        ensure_node(G,u);
-        std::unordered_set<int> chosen;
-        for (int k=0; k<attach && !targets.empty(); ++k) {
-            int v = targets[R(rng)];
-        
+        chosen.clear();
+        for (int k = 0; k < attach && !endpoints.empty(); ++k) {
+            Node v = endpoints[rng.below((uint32_t)endpoints.size())];
             int guard = 0;
-            while ((v == u || chosen.count(v)) && guard++ < 32) {
-                v = targets[R(rng)];
+            while ((v == u || std::find(chosen.begin(), chosen.end(), v) != chosen.end()) && guard++ < 32) {
+                v = endpoints[rng.below((uint32_t)endpoints.size())];
             }
-            chosen.insert(v);
+            if (v != u && std::find(chosen.begin(), chosen.end(), v) == chosen.end()) chosen.push_back(v);
         }
-        for (int v : chosen) {
-            add(u, v);
-        
-            targets.push_back(u);
-            targets.push_back(v);
+        for (Node v : chosen) {
+            csr.targets.push_back(v);
+            csr.weights.push_back(rng.uniform(1.0, max_w));
+            endpoints.push_back(u);
+            endpoints.push_back(v);
         }
+        csr.offsets[u + 1] = csr.targets.size();
     }
-    return {G,E};
+    return csr;
 }
 
-std::pair<Graph, std::vector<Edge>> generate_ws_directed(
-    int n, int k, double beta, double max_w, unsigned seed)
-{
-    Graph G; std::vector<Edge> E; G.reserve(n);
-    if (n<=0) return {G,E};
+CsrGraph csr_ws(int n, int k, double beta, double max_w, unsigned seed, int threads) {
+    if (k % 2) ++k;
+    k = std::max(0, std::min(k, n - 1));
+    return build_by_source(n, seed, SALT_WS, threads,
+        [&](Node u, Philox4x32& rng, std::pmr::vector<Node>& tgt, std::pmr::vector<Weight>& w) {
+            auto rewire = [&](Node to) {
+                if (rng.uniform01() < beta) {
+                    do { to = (Node)rng.below((uint32_t)n); } while (to == u);
+                }
+                tgt.push_back(to);
+                w.push_back(rng.uniform(1.0, max_w));
+            };
+            for (int d = 1; d <= k / 2; ++d) {
+                rewire((u + d) % n);
+                rewire((u - d + n) % n);
+            }
+        });
+}
 
-    std::mt19937 rng(seed);
-    std::uniform_real_distribution<double> U(0.0,1.0);
-    std::uniform_real_distribution<double> W(1.0, max_w);
-    std::uniform_int_distribution<int> R(0, n-1);
+CsrGraph csr_grid2d(int rows, int cols, bool diag, double max_w, unsigned seed, int threads) {
+    int n = (rows > 0 && cols > 0) ? rows * cols : 0;
+    const int dr4[4]={1,-1,0,0};
+    const int dc4[4]={0,0,1,-1};
+    const int dr8[8]={1,1,1,0,0,-1,-1,-1};
+    const int dc8[8]={1,0,-1,1,-1,1,0,-1};
+    const int* dr = diag ? dr8 : dr4;
+    const int* dc = diag ? dc8 : dc4;
+    int dirs = diag ? 8 : 4;
+
+    return build_by_source(n, seed, SALT_GRID, threads,
+        [&](Node u, Philox4x32& rng, std::pmr::vector<Node>& tgt, std::pmr::vector<Weight>& w) {
+            int r = u / cols, c = u % cols;
+            for (int t = 0; t < dirs; ++t) {
+                int rr = r + dr[t], cc = c + dc[t];
+                if (rr >= 0 && rr < rows && cc >= 0 && cc < cols) {
+                    tgt.push_back(rr * cols + cc);
+                    w.push_back(rng.uniform(1.0, max_w));
+                }
+            }
+        });
+}
 
-    if (k%2) ++k; k = std::min(k, n-1);
-    for (int u=0; u<n; ++u) ensure_node(G,u);
+CsrGraph csr_layered_dag(int layers, int width, double p_forward, double max_w, unsigned seed, int threads) {
+    int n = (layers > 0 && width > 0) ? layers * width : 0;
+    double p_next = std::min(p_forward, 1.0 - 1e-12);
+    double p_far = std::min(p_forward * 0.3, 1.0 - 1e-12);
+    return build_by_source(n, seed, SALT_DAG, threads,
+        [&](Node u, Philox4x32& rng, std::pmr::vector<Node>& tgt, std::pmr::vector<Weight>& w) {
+            int L = u / width;
+            for (int L2 = L + 1; L2 < layers; ++L2) {
+                double p = (L2 == L + 1 ? p_next : p_far);
+                if (p <= 0.0) continue;
+                double log_q = std::log1p(-p);
+                for (long long j = geometric_skip(rng, log_q); j < width; j += 1 + geometric_skip(rng, log_q)) {
+                    tgt.push_back(L2 * width + (Node)j);
+                    w.push_back(rng.uniform(1.0, max_w));
+                }
+            }
+        });
+}
 
-    for (int u=0; u<n; ++u) {
-        for (int d=1; d<=k/2; ++d) {
-            int v = (u + d) % n;
-            int w = (u - d + n) % n;
+std::pair<Graph, std::vector<Edge>> to_adjacency(const CsrGraph& csr) {
+    return {csr_to_graph(csr), csr_to_edges(csr)};
+}
 
-            int to = v;
-            if (U(rng) < beta) { do { to = R(rng); } while (to==u); }
-            add_edge(G,E,u,to,W(rng));
+}  // namespace
 
-            to = w;
-            if (U(rng) < beta) { do { to = R(rng); } while (to==u); }
-            add_edge(G,E,u,to,W(rng));
-        }
-    }
-    return {G,E};
+std::pair<Graph, std::vector<Edge>> generate_sparse_directed_graph(
+    int n, int m, double max_w, unsigned seed) {
+    return to_adjacency(csr_random_m(n, m, max_w, seed, 0));
 }
 
-std::pair<Graph, std::vector<Edge>> generate_grid2d_directed(
-    int rows, int cols, bool diag, double max_w, unsigned seed)
+std::pair<Graph, std::vector<Edge>> generate_er_directed(
+    int n, double p, double max_w, unsigned seed)
 {
-    Graph G; std::vector<Edge> E; G.reserve(rows*cols);
-    std::mt19937 rng(seed);
-    std::uniform_real_distribution<double> W(1.0, max_w);
+    return to_adjacency(csr_er(n, p, max_w, seed, 0));
+}
 
-    auto id = [cols](int r,int c){ return r*cols + c; };
-    auto inside = [rows,cols](int r,int c){ return r>=0 && r<rows && c>=0 && c<cols; };
+std::pair<Graph, std::vector<Edge>> generate_ba_directed(
+    int n, int attach, double max_w, unsigned seed)
+{
+    return to_adjacency(csr_ba(n, attach, max_w, seed));
+}
 
-    const int dr4[4]={1,-1,0,0};
-    const int dc4[4]={0,0,1,-1};
-    const int dr8[8]={1,1,1,0,0,-1,-1,-1};
-    const int dc8[8]={1,0,-1,1,-1,1,0,-1};
+std::pair<Graph, std::vector<Edge>> generate_ws_directed(
+    int n, int k, double beta, double max_w, unsigned seed)
+{
+    return to_adjacency(csr_ws(n, k, beta, max_w, seed, 0));
+}
 
-    for (int r=0;r<rows;++r) for (int c=0;c<cols;++c) {
-        Node u = id(r,c); ensure_node(G,u);
-        if (!diag) {
-            for (int t=0;t<4;++t){
-                int rr=r+dr4[t], cc=c+dc4[t];
-                if (inside(rr,cc)) add_edge(G,E,u,id(rr,cc),W(rng));
-            }
-        } else {
-            for (int t=0;t<8;++t){
-                int rr=r+dr8[t], cc=c+dc8[t];
-                if (inside(rr,cc)) add_edge(G,E,u,id(rr,cc),W(rng));
-            }
-        }
-    }
-    return {G,E};
+std::pair<Graph, std::vector<Edge>> generate_grid2d_directed(
+    int rows, int cols, bool diag, double max_w, unsigned seed)
+{
+    return to_adjacency(csr_grid2d(rows, cols, diag, max_w, seed, 0));
 }
 
 std::pair<Graph, std::vector<Edge>> generate_layered_dag(
     int layers, int width, double p_forward, double max_w, unsigned seed)
 {
-    Graph G; std::vector<Edge> E;
-    if (layers<=0 || width<=0) return {G,E};
-
-    std::mt19937 rng(seed);
-    std::uniform_real_distribution<double> U(0.0,1.0);
-    std::uniform_real_distribution<double> W(1.0, max_w);
-
-    int n = layers*width;
-    for (int u=0; u<n; ++u) ensure_node(G,u);
+    return to_adjacency(csr_layered_dag(layers, width, p_forward, max_w, seed, 0));
+}
 
-    auto nid = [width](int L, int i){ return L*width + i; };
+GridGraph generate_grid_implicit(int rows, int cols, bool diag, GridCostModel model,
+                                 double max_w, unsigned seed, int threads) {
+    int n = (rows > 0 && cols > 0) ? rows * cols : 0;
+    std::size_t blocks = ((std::size_t)n + NODE_BLOCK - 1) / NODE_BLOCK;
+    const Weight INF = std::numeric_limits<Weight>::infinity();
+
+    if (model == GridCostModel::CELL) {
+        std::vector<Weight> cost((std::size_t)n);
+        parallel_for_blocks(blocks, threads, [&](std::size_t b) {
+            Philox4x32 rng(seed, stream_id(SALT_GRID_CELL, b));
+            Node last = std::min<Node>(n, (Node)((b + 1) * NODE_BLOCK));
+            for (Node u = (Node)(b * NODE_BLOCK); u < last; ++u) cost[u] = rng.uniform(1.0, max_w);
+        });
+        return make_cell_grid(rows, cols, diag, std::move(cost));
+    }
 
-    for (int L=0; L<layers-1; ++L) {
-        for (int i=0; i<width; ++i) {
-            Node u = nid(L,i);
-            for (int L2=L+1; L2<layers; ++L2) {
-                double p = (L2==L+1 ? p_forward : p_forward*0.3);
-                for (int j=0; j<width; ++j) {
-                    if (U(rng) < p) add_edge(G,E,u,nid(L2,j),W(rng));
+    // Mismos streams y mismo orden de sorteo que csr_grid2d: pesos idénticos
+    // a los de generate_grid2d_directed con la misma semilla
+    int dirs = diag ? 8 : 4;
+    const int* dr = diag ? GridGraph::DR8 : GridGraph::DR4;
+    const int* dc = diag ? GridGraph::DC8 : GridGraph::DC4;
+    std::vector<Weight> planes((std::size_t)dirs * n, INF);
+    parallel_for_blocks(blocks, threads, [&](std::size_t b) {
+        Philox4x32 rng(seed, stream_id(SALT_GRID, b));
+        Node last = std::min<Node>(n, (Node)((b + 1) * NODE_BLOCK));
+        for (Node u = (Node)(b * NODE_BLOCK); u < last; ++u) {
+            int r = u / cols, c = u % cols;
+            for (int t = 0; t < dirs; ++t) {
+                int rr = r + dr[t], cc = c + dc[t];
+                if (rr >= 0 && rr < rows && cc >= 0 && cc < cols) {
+                    planes[(std::size_t)t * n + u] = rng.uniform(1.0, max_w);
                 }
             }
         }
-    }
-    return {G,E};
+    });
+    return make_plane_grid(rows, cols, diag, std::move(planes));
 }
 
-std::pair<Graph, std::vector<Edge>>
-generate_graph(GraphType type, const GraphGenOptions& opt) {
+GridGraph generate_occupancy_grid(int rows, int cols, bool diag, double obstacle_p,
+                                  unsigned seed, int threads) {
+    int n = (rows > 0 && cols > 0) ? rows * cols : 0;
+    std::size_t blocks = ((std::size_t)n + NODE_BLOCK - 1) / NODE_BLOCK;
+    std::vector<Weight> cost((std::size_t)n, 1.0);
+    parallel_for_blocks(blocks, threads, [&](std::size_t b) {
+        Philox4x32 rng(seed, stream_id(SALT_GRID_OCCUPANCY, b));
+        Node last = std::min<Node>(n, (Node)((b + 1) * NODE_BLOCK));
+        for (Node u = (Node)(b * NODE_BLOCK); u < last; ++u) {
+            if (rng.uniform01() < obstacle_p) cost[u] = std::numeric_limits<Weight>::infinity();
+        }
+    });
+    return make_cell_grid(rows, cols, diag, std::move(cost));
+}
+
+CsrGraph generate_graph_csr(GraphType type, const GraphGenOptions& opt) {
     switch (type) {
         case GraphType::RANDOM_M:
-            return generate_sparse_directed_graph(opt.n, opt.m, opt.wmax, opt.seed);
+            return csr_random_m(opt.n, opt.m, opt.wmax, opt.seed, opt.threads);
         case GraphType::ER:
-            return generate_er_directed(opt.n, opt.p, opt.wmax, opt.seed);
+            return csr_er(opt.n, opt.p, opt.wmax, opt.seed, opt.threads);
         case GraphType::BA:
-            return generate_ba_directed(opt.n, opt.attach, opt.wmax, opt.seed);
+            return csr_ba(opt.n, opt.attach, opt.wmax, opt.seed);
         case GraphType::WS:
-            return generate_ws_directed(opt.n, opt.k, opt.beta, opt.wmax, opt.seed);
+            return csr_ws(opt.n, opt.k, opt.beta, opt.wmax, opt.seed, opt.threads);
         case GraphType::GRID2D:
-            return generate_grid2d_directed(opt.rows, opt.cols, opt.diag, opt.wmax, opt.seed);
+            return csr_grid2d(opt.rows, opt.cols, opt.diag, opt.wmax, opt.seed, opt.threads);
         case GraphType::LAYERED_DAG:
-            return generate_layered_dag(opt.layers, opt.width, opt.dagp, opt.wmax, opt.seed);
+            return csr_layered_dag(opt.layers, opt.width, opt.dagp, opt.wmax, opt.seed, opt.threads);
         default:
-            return generate_sparse_directed_graph(opt.n, opt.m, opt.wmax, opt.seed);
+            return csr_random_m(opt.n, opt.m, opt.wmax, opt.seed, opt.threads);
     }
 }
+
+std::pair<Graph, std::vector<Edge>>
+generate_graph(GraphType type, const GraphGenOptions& opt) {
+    return to_adjacency(generate_graph_csr(type, opt));
+}
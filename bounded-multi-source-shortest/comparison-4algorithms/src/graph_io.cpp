@@ -0,0 +1,326 @@
+#include "./../include/graph_io.h"
+#include "./../include/thread_pool.h"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+
+const std::size_t NO_ERROR = std::numeric_limits<std::size_t>::max();
+
+// Resultado de parsear un tramo de un bloque. Los buffers están acotados por
+// el tamaño del bloque, nunca por el tamaño del archivo.
+struct ChunkResult {
+    std::vector<Edge> arcs;
+    std::vector<std::pair<Node, std::pair<double, double>>> coords;
+    long long declared_nodes = -1;
+    std::size_t error_offset = NO_ERROR;
+};
+
+inline const char* skip_blanks(const char* p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == ',' || *p == '\r')) ++p;
+    return p;
+}
+
+template <class T>
+inline bool read_number(const char*& p, const char* end, T& out) {
+    p = skip_blanks(p, end);
+    if (p < end && *p == '+') ++p;
+    auto res = std::from_chars(p, end, out);
+    if (res.ec != std::errc()) return false;
+    p = res.ptr;
+    return true;
+}
+
+inline bool read_word(const char*& p, const char* end) {
+    p = skip_blanks(p, end);
+    const char* start = p;
+    while (p < end && *p != ' ' && *p != '\t' && *p != '\r') ++p;
+    return p > start;
+}
+
+inline bool at_line_end(const char* p, const char* end) {
+    return skip_blanks(p, end) == end;
+}
+
+// "a u v w" / "p sp n m" / "c ..." (nodos DIMACS en base 1)
+bool parse_gr_line(const char* p, const char* end, ChunkResult& out) {
+    p = skip_blanks(p, end);
+    if (p == end || *p == 'c') return true;
+    char tag = *p++;
+    if (tag == 'a') {
+        long long u, v; Weight w;
+        if (!read_number(p, end, u) || !read_number(p, end, v) || !read_number(p, end, w)) return false;
+        if (u < 1 || v < 1 || u > std::numeric_limits<Node>::max() || v > std::numeric_limits<Node>::max()) return false;
+        out.arcs.push_back({(Node)(u - 1), (Node)(v - 1), w});
+        return at_line_end(p, end);
+    }
+    if (tag == 'p') {
+        long long n, m;
+        if (!read_word(p, end) || !read_number(p, end, n) || !read_number(p, end, m)) return false;
+        out.declared_nodes = n;
+        return n >= 0;
+    }
+    return false;
+}
+
+// "v id x y" / "p aux sp co n" / "c ..."
+bool parse_co_line(const char* p, const char* end, ChunkResult& out) {
+    p = skip_blanks(p, end);
+    if (p == end || *p == 'c') return true;
+    char tag = *p++;
+    if (tag == 'v') {
+        long long id; double x, y;
+        if (!read_number(p, end, id) || !read_number(p, end, x) || !read_number(p, end, y)) return false;
+        if (id < 1 || id > std::numeric_limits<Node>::max()) return false;
+        out.coords.push_back({(Node)(id - 1), {x, y}});
+        return at_line_end(p, end);
+    }
+    if (tag == 'p') {
+        long long n;
+        if (!read_word(p, end) || !read_word(p, end) || !read_word(p, end) || !read_number(p, end, n)) return false;
+        out.declared_nodes = n;
+        return n >= 0;
+    }
+    return false;
+}
+
+// "u v [w]" con espacios, tabuladores o comas; '#' y '%' son comentarios y
+// una primera línea no numérica se toma como cabecera CSV
+bool parse_edge_line(const char* p, const char* end, ChunkResult& out, Weight default_weight) {
+    p = skip_blanks(p, end);
+    if (p == end || *p == '#' || *p == '%') return true;
+    long long u, v;
+    if (!read_number(p, end, u) || !read_number(p, end, v)) return false;
+    if (u < 0 || v < 0 || u > std::numeric_limits<Node>::max() || v > std::numeric_limits<Node>::max()) return false;
+    Weight w = default_weight;
+    if (!at_line_end(p, end) && !read_number(p, end, w)) return false;
+    out.arcs.push_back({(Node)u, (Node)v, w});
+    return at_line_end(p, end);
+}
+
+template <class ParseLine>
+void parse_range(const char* begin, const char* end, std::size_t base_offset,
+                 ChunkResult& out, ParseLine parse_line) {
+    const char* line = begin;
+    while (line < end) {
+        const char* eol = std::find(line, end, '\n');
+        if (!parse_line(line, eol, out)) {
+            out.error_offset = base_offset + (std::size_t)(line - begin);
+            return;
+        }
+        line = eol + 1;
+    }
+}
+
+// Lee el archivo por bloques de opt.chunk_bytes cortados en fin de línea,
+// reparte cada bloque entre hilos y entrega los resultados en orden de
+// archivo a merge(), de modo que la salida no depende del número de hilos.
+template <class ParseLine, class Merge>
+void stream_file(const std::string& path, const ParseOptions& opt, ParseStats* stats,
+                 ParseLine parse_line, Merge merge, bool skip_csv_header) {
+    auto t0 = std::chrono::steady_clock::now();
+
+    std::ifstream in(path, std::ios::binary);
+    if (!in) throw std::runtime_error("graph_io: no se puede abrir " + path);
+
+    int threads = opt.threads > 0 ? opt.threads : (int)std::thread::hardware_concurrency();
+    threads = std::max(1, threads);
+    std::size_t chunk = std::max<std::size_t>(opt.chunk_bytes, 4096);
+
+    std::vector<char> buffer;
+    std::size_t carry = 0;
+    std::size_t file_offset = 0;
+    std::size_t total_bytes = 0;
+    bool first_line = true;
+    std::vector<ChunkResult> parts(threads);
+
+    while (true) {
+        buffer.resize(carry + chunk);
+        in.read(buffer.data() + carry, (std::streamsize)chunk);
+        std::size_t got = (std::size_t)in.gcount();
+        total_bytes += got;
+        std::size_t filled = carry + got;
+        bool eof = got < chunk;
+        if (filled == 0) break;
+
+        // Solo se procesan líneas completas; el resto pasa al siguiente bloque
+        std::size_t usable = filled;
+        if (!eof) {
+            const char* last_nl = nullptr;
+            for (std::size_t i = filled; i-- > 0;) {
+                if (buffer[i] == '\n') { last_nl = buffer.data() + i; break; }
+            }
+            if (!last_nl) {
+                carry = filled;
+                chunk *= 2;
+                continue;
+            }
+            usable = (std::size_t)(last_nl - buffer.data()) + 1;
+        }
+
+        const char* begin = buffer.data();
+        const char* end = buffer.data() + usable;
+
+        if (first_line && skip_csv_header) {
+            const char* eol = std::find(begin, end, '\n');
+            const char* p = skip_blanks(begin, eol);
+            if (p < eol && !(std::isdigit((unsigned char)*p) || *p == '#' || *p == '%' || *p == '+')) {
+                begin = std::min(end, eol + 1);
+            }
+        }
+        first_line = false;
+
+        // Cortes por hilo alineados a fin de línea
+        std::vector<const char*> cuts(threads + 1, end);
+        cuts[0] = begin;
+        for (int t = 1; t < threads; ++t) {
+            const char* c = begin + (std::size_t)(end - begin) * t / threads;
+            c = std::max(c, cuts[t - 1]);
+            c = std::find(c, end, '\n');
+            cuts[t] = (c == end) ? end : c + 1;
+        }
+
+        for (auto& part : parts) {
+            part.arcs.clear();
+            part.coords.clear();
+            part.declared_nodes = -1;
+            part.error_offset = NO_ERROR;
+        }
+        TaskGroup group;
+        for (int t = 1; t < threads; ++t) {
+            if (cuts[t] == cuts[t + 1]) continue;
+            group.run([&, t]() {
+                parse_range(cuts[t], cuts[t + 1], file_offset + (cuts[t] - buffer.data()),
+                            parts[t], parse_line);
+            });
+        }
+        parse_range(cuts[0], cuts[1], file_offset + (cuts[0] - buffer.data()), parts[0], parse_line);
+        group.wait();
+
+        for (auto& part : parts) {
+            if (part.error_offset != NO_ERROR) {
+                throw std::runtime_error("graph_io: línea mal formada en byte " +
+                                         std::to_string(part.error_offset) + " de " + path);
+            }
+            merge(part);
+        }
+
+        file_offset += usable;
+        carry = filled - usable;
+        if (carry > 0) std::copy(buffer.begin() + usable, buffer.begin() + filled, buffer.begin());
+        if (eof) break;
+    }
+
+    if (stats) {
+        stats->bytes = total_bytes;
+        stats->seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    }
+}
+
+InputFormat detect_format(const std::string& path, InputFormat requested) {
+    if (requested != InputFormat::AUTO) return requested;
+    auto dot = path.find_last_of('.');
+    if (dot != std::string::npos && path.substr(dot) == ".gr") return InputFormat::DIMACS_GR;
+    return InputFormat::EDGE_LIST;
+}
+
+}  // namespace
+
+Graph load_graph(const std::string& path, const ParseOptions& opt, ParseStats* stats) {
+    InputFormat format = detect_format(path, opt.format);
+    Graph graph;
+    std::size_t edges = 0;
+    long long declared_nodes = -1;
+
+    auto merge = [&](ChunkResult& part) {
+        if (part.declared_nodes >= 0 && declared_nodes < 0) {
+            declared_nodes = part.declared_nodes;
+            graph.reserve((std::size_t)declared_nodes);
+            for (Node u = 0; u < (Node)declared_nodes; ++u) graph[u];
+        }
+        for (const Edge& e : part.arcs) {
+            if (declared_nodes >= 0 && (e.from >= declared_nodes || e.to >= declared_nodes)) {
+                throw std::runtime_error("graph_io: arista fuera de rango en " + path);
+            }
+            graph[e.from].push_back({e.to, e.weight});
+            graph.try_emplace(e.to);
+        }
+        edges += part.arcs.size();
+    };
+
+    ParseStats local;
+    if (format == InputFormat::DIMACS_GR) {
+        stream_file(path, opt, &local,
+                    [](const char* b, const char* e, ChunkResult& out) { return parse_gr_line(b, e, out); },
+                    merge, false);
+    } else {
+        Weight dw = opt.default_weight;
+        stream_file(path, opt, &local,
+                    [dw](const char* b, const char* e, ChunkResult& out) { return parse_edge_line(b, e, out, dw); },
+                    merge, true);
+    }
+
+    if (stats) {
+        *stats = local;
+        stats->nodes = graph.size();
+        stats->edges = edges;
+    }
+    return graph;
+}
+
+Coordinates load_coordinates(const std::string& path, const ParseOptions& opt, ParseStats* stats) {
+    Coordinates coords;
+    auto merge = [&](ChunkResult& part) {
+        if (part.declared_nodes >= 0 && coords.empty()) {
+            coords.x.assign((std::size_t)part.declared_nodes, 0.0);
+            coords.y.assign((std::size_t)part.declared_nodes, 0.0);
+        }
+        for (const auto& [id, xy] : part.coords) {
+            if ((std::size_t)id >= coords.size()) {
+                coords.x.resize((std::size_t)id + 1, 0.0);
+                coords.y.resize((std::size_t)id + 1, 0.0);
+            }
+            coords.x[id] = xy.first;
+            coords.y[id] = xy.second;
+        }
+    };
+
+    ParseStats local;
+    stream_file(path, opt, &local,
+                [](const char* b, const char* e, ChunkResult& out) { return parse_co_line(b, e, out); },
+                merge, false);
+
+    if (stats) {
+        *stats = local;
+        stats->nodes = coords.size();
+    }
+    return coords;
+}
+
+double admissible_heuristic_scale(const Graph& graph, const Coordinates& coords) {
+    double scale = std::numeric_limits<double>::infinity();
+    for (const auto& [u, adj] : graph) {
+        if ((std::size_t)u >= coords.size()) continue;
+        for (const auto& [v, w] : adj) {
+            if ((std::size_t)v >= coords.size()) continue;
+            double d = std::hypot(coords.x[u] - coords.x[v], coords.y[u] - coords.y[v]);
+            if (d > 0.0) scale = std::min(scale, w / d);
+        }
+    }
+    return std::isfinite(scale) ? std::max(0.0, scale) : 0.0;
+}
+
+HeuristicFunction coordinate_heuristic(const Coordinates& coords, double scale) {
+    const Coordinates* c = &coords;
+    return [c, scale](Node a, Node b) -> Weight {
+        if ((std::size_t)a >= c->size() || (std::size_t)b >= c->size()) return 0.0;
+        return scale * std::hypot(c->x[a] - c->x[b], c->y[a] - c->y[b]);
+    };
+}
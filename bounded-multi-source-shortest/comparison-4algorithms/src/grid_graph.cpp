@@ -0,0 +1,78 @@
+#include "./../include/grid_graph.h"
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+void check_dims(int rows, int cols) {
+    if (rows <= 0 || cols <= 0 || (long long)rows * cols > std::numeric_limits<Node>::max()) {
+        throw std::runtime_error("invalid grid size " + std::to_string(rows) + "x" + std::to_string(cols));
+    }
+}
+
+// Mínimo de los pesos finitos (0 si no hay ninguno); lanza si hay negativos
+Weight min_finite(const std::vector<Weight>& w) {
+    Weight lo = std::numeric_limits<Weight>::infinity();
+    for (Weight x : w) {
+        if (x < 0) throw std::runtime_error("negative grid weight: " + std::to_string(x));
+        lo = std::min(lo, x);
+    }
+    return lo < std::numeric_limits<Weight>::infinity() ? lo : 0;
+}
+
+}  // namespace
+
+GridGraph make_cell_grid(int rows, int cols, bool diag, std::vector<Weight> cell_cost) {
+    check_dims(rows, cols);
+    if (cell_cost.size() != (std::size_t)rows * cols) {
+        throw std::runtime_error("cell cost array has " + std::to_string(cell_cost.size()) +
+                                 " entries, expected " + std::to_string((std::size_t)rows * cols));
+    }
+    GridGraph g;
+    g.rows = rows;
+    g.cols = cols;
+    g.diag = diag;
+    g.model = GridCostModel::CELL;
+    g.min_weight = min_finite(cell_cost);
+    g.cell_cost = std::move(cell_cost);
+    return g;
+}
+
+GridGraph make_plane_grid(int rows, int cols, bool diag, std::vector<Weight> planes) {
+    check_dims(rows, cols);
+    std::size_t expected = (std::size_t)(diag ? 8 : 4) * rows * cols;
+    if (planes.size() != expected) {
+        throw std::runtime_error("direction planes have " + std::to_string(planes.size()) +
+                                 " entries, expected " + std::to_string(expected));
+    }
+    GridGraph g;
+    g.rows = rows;
+    g.cols = cols;
+    g.diag = diag;
+    g.model = GridCostModel::PLANES;
+    g.min_weight = min_finite(planes);
+    g.planes = std::move(planes);
+    return g;
+}
+
+std::size_t GridGraph::num_edges() const {
+    std::size_t m = 0;
+    for (Node u = 0; u < num_nodes(); ++u) {
+        for_each_out(u, [&m](Node, Weight) { m++; });
+    }
+    return m;
+}
+
+std::size_t GridGraph::memory_bytes() const {
+    return sizeof(GridGraph) + cell_cost.capacity() * sizeof(Weight) + planes.capacity() * sizeof(Weight);
+}
+
+Graph grid_to_graph(const GridGraph& grid) {
+    Graph graph;
+    graph.reserve(grid.num_nodes());
+    for (Node u = 0; u < grid.num_nodes(); ++u) {
+        auto& adj = graph[u];
+        grid.for_each_out(u, [&adj](Node v, Weight w) { adj.push_back({v, w}); });
+    }
+    return graph;
+}
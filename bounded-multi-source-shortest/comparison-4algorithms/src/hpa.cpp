@@ -0,0 +1,396 @@
+#include "./../include/hpa.h"
+#include "./../include/instrumentation.h"
+#include "./../include/packed_key.h"
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+const Weight INF = std::numeric_limits<Weight>::infinity();
+
+// Tramos de frontera de al menos esta longitud dan dos transiciones (una en
+// cada extremo); los más cortos, una en el centro
+const int LONG_ENTRANCE = 6;
+
+// Rectángulo de celdas [r0, r1) x [c0, c1) con índices locales por filas
+struct Rect {
+    int r0, c0, r1, c1;
+    int cols;  // de la malla
+
+    bool contains(Node u) const {
+        int r = u / cols, c = u % cols;
+        return r >= r0 && r < r1 && c >= c0 && c < c1;
+    }
+    int local(Node u) const { return (u / cols - r0) * (c1 - c0) + (u % cols - c0); }
+    Node cell(int i) const { return (r0 + i / (c1 - c0)) * cols + c0 + i % (c1 - c0); }
+    int area() const { return (r1 - r0) * (c1 - c0); }
+};
+
+Rect cluster_rect(const GridGraph& g, int size, int cluster_cols, int c) {
+    int r0 = (c / cluster_cols) * size, c0 = (c % cluster_cols) * size;
+    return {r0, c0, std::min(g.rows, r0 + size), std::min(g.cols, c0 + size), g.cols};
+}
+
+// Memoria de una búsqueda local, reutilizable entre búsquedas
+struct LocalSearch {
+    std::vector<Weight> dist;  // por índice local
+    std::vector<int> parent;   // índice local del padre, -1 en el origen
+    std::vector<PackedKey> heap;
+    // Si goals > 0, la búsqueda para al fijar las goals celdas con goal 1
+    // (quedan a 2; quien llama las vuelve a poner a 1)
+    std::vector<char> goal;
+    std::size_t goals = 0;
+};
+
+// Dijkstra sin salir de rect desde from (por aristas entrantes si reverse);
+// con target >= 0, A* hacia target que para al fijarlo
+void local_search(const GridGraph& g, const Rect& rect, Node from, Node target, bool reverse, LocalSearch& ws,
+                  Instrument* instr) {
+    Instrument local_instr;
+    if (!instr) instr = &local_instr;
+    const int a = rect.area();
+    ws.dist.assign(a, INF);
+    ws.parent.assign(a, -1);
+    ws.heap.clear();
+    const std::greater<PackedKey> later;
+    auto h = [&](Node u) { return target >= 0 ? g.heuristic(u, target) : (Weight)0; };
+    auto push = [&](Weight f, int i) {
+        ws.heap.push_back(pack_key(f, i));
+        std::push_heap(ws.heap.begin(), ws.heap.end(), later);
+        INSTR_ADD(instr, heap_ops, 1);
+    };
+
+    ws.dist[rect.local(from)] = 0;
+    push(h(from), rect.local(from));
+    std::size_t found = 0;
+    while (!ws.heap.empty()) {
+        std::pop_heap(ws.heap.begin(), ws.heap.end(), later);
+        PackedKey key = ws.heap.back();
+        ws.heap.pop_back();
+        INSTR_ADD(instr, heap_ops, 1);
+        const int i = key_node(key);
+        const Node u = rect.cell(i);
+        const Weight du = ws.dist[i];
+        if (key_bits(key) > monotone_bits(du + h(u))) {
+            INSTR_ADD(instr, stale_pops, 1);
+            continue;
+        }
+        INSTR_ADD(instr, settled, 1);
+        if (u == target) break;
+        if (ws.goals && ws.goal[i] == 1) {
+            ws.goal[i] = 2;
+            if (++found == ws.goals) break;
+        }
+        auto relax = [&](Node v, Weight w) {
+            if (!rect.contains(v)) return;
+            INSTR_ADD(instr, relaxations, 1);
+            const int j = rect.local(v);
+            if (du + w < ws.dist[j]) {
+                ws.dist[j] = du + w;
+                ws.parent[j] = i;
+                push(du + w + h(v), j);
+            }
+        };
+        if (reverse) g.for_each_in(u, relax);
+        else g.for_each_out(u, relax);
+    }
+}
+
+}  // namespace
+
+HpaGrid::HpaGrid(const GridGraph& g, int cluster_size) : grid(g), size(cluster_size) {
+    if (cluster_size < 2) {
+        throw std::runtime_error("HPA* needs cluster_size >= 2, got " + std::to_string(cluster_size));
+    }
+    auto t0 = std::chrono::steady_clock::now();
+    cluster_rows = (grid.rows + size - 1) / size;
+    cluster_cols = (grid.cols + size - 1) / size;
+    clusters.resize((std::size_t)cluster_rows * cluster_cols);
+    // Las transiciones de todos los clusters antes que los nodos: un cluster
+    // toma también las de sus vecinos de la izquierda y de arriba y las
+    // esquinas de los de arriba en diagonal
+    for (int c = 0; c < (int)clusters.size(); ++c) find_entrances(c);
+    for (int c = 0; c < (int)clusters.size(); ++c) rebuild(c);
+    build_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+int HpaGrid::cluster_of(Node u) const {
+    return (u / grid.cols / size) * cluster_cols + (u % grid.cols) / size;
+}
+
+int HpaGrid::node_index(int c, Node u) const {
+    const auto& nodes = clusters[c].nodes;
+    auto it = std::lower_bound(nodes.begin(), nodes.end(), u);
+    return (it != nodes.end() && *it == u) ? (int)(it - nodes.begin()) : -1;
+}
+
+void HpaGrid::find_entrances(int c) {
+    Cluster& cl = clusters[c];
+    const Rect rect = cluster_rect(grid, size, cluster_cols, c);
+    cl.right.clear();
+    cl.down.clear();
+    cl.corner.clear();
+
+    // Celdas vecinas con arista en los dos sentidos (en la malla de celdas,
+    // ambas libres)
+    auto linked = [&](Node a, Node b) {
+        bool fwd = false, back = false;
+        grid.for_each_out(a, [&](Node v, Weight) { fwd |= v == b; });
+        grid.for_each_out(b, [&](Node v, Weight) { back |= v == a; });
+        return fwd && back;
+    };
+    // Frontera de celdas propias first + i * step frente a las vecinas
+    // (+ across): tramos maximales de pares rectos enlazados y, con
+    // diagonales, los cruces que solo existen en diagonal
+    std::vector<char> open;
+    auto scan = [&](std::vector<std::pair<Node, Node>>& out, int len, Node first, int step, Node across) {
+        open.assign(len, 0);
+        for (int i = 0; i < len; ++i) open[i] = linked(first + i * step, first + i * step + across);
+        int run = 0;
+        auto close = [&](int end) {
+            if (run == 0) return;
+            auto add = [&](int i) { out.push_back({first + i * step, first + i * step + across}); };
+            if (run < LONG_ENTRANCE) {
+                add(end - run + run / 2);
+            } else {
+                add(end - run);
+                add(end - 1);
+            }
+            run = 0;
+        };
+        for (int i = 0; i < len; ++i) {
+            if (open[i]) run++;
+            else close(i);
+        }
+        close(len);
+        if (!grid.diag) return;
+        for (int i = 0; i + 1 < len; ++i) {
+            if (open[i] || open[i + 1]) continue;
+            Node a = first + i * step, next = a + step;
+            if (linked(a, next + across)) out.push_back({a, next + across});
+            if (linked(next, a + across)) out.push_back({next, a + across});
+        }
+    };
+    if (rect.c1 < grid.cols) scan(cl.right, rect.r1 - rect.r0, rect.r0 * grid.cols + rect.c1 - 1, grid.cols, 1);
+    if (rect.r1 < grid.rows) scan(cl.down, rect.c1 - rect.c0, (rect.r1 - 1) * grid.cols + rect.c0, 1, grid.cols);
+
+    // La diagonal por la esquina no pasa por ninguna frontera de las de
+    // arriba: sin esta transición esos caminos no existirían
+    if (grid.diag && rect.r1 < grid.rows) {
+        const Node last_row = (Node)(rect.r1 - 1) * grid.cols;
+        auto add = [&](Node a, Node b) { if (linked(a, b)) cl.corner.push_back({a, b}); };
+        if (rect.c1 < grid.cols) add(last_row + rect.c1 - 1, last_row + grid.cols + rect.c1);
+        if (rect.c0 > 0) add(last_row + rect.c0, last_row + grid.cols + rect.c0 - 1);
+    }
+}
+
+void HpaGrid::rebuild(int c) {
+    Cluster& cl = clusters[c];
+    cl.nodes.clear();
+    for (const auto& [a, _] : cl.right) cl.nodes.push_back(a);
+    for (const auto& [a, _] : cl.down) cl.nodes.push_back(a);
+    if (c % cluster_cols > 0) {
+        for (const auto& [_, b] : clusters[c - 1].right) cl.nodes.push_back(b);
+    }
+    if (c >= cluster_cols) {
+        for (const auto& [_, b] : clusters[c - cluster_cols].down) cl.nodes.push_back(b);
+    }
+    for (const auto& [a, _] : cl.corner) cl.nodes.push_back(a);
+    if (c >= cluster_cols) {
+        // Esquinas de los clusters de arriba a la izquierda y a la derecha
+        const int up = c - cluster_cols, col = c % cluster_cols;
+        for (int nb : {up - 1, up + 1}) {
+            if ((nb == up - 1 && col == 0) || (nb == up + 1 && col == cluster_cols - 1)) continue;
+            for (const auto& [_, b] : clusters[nb].corner) {
+                if (cluster_of(b) == c) cl.nodes.push_back(b);
+            }
+        }
+    }
+    std::sort(cl.nodes.begin(), cl.nodes.end());
+    cl.nodes.erase(std::unique(cl.nodes.begin(), cl.nodes.end()), cl.nodes.end());
+
+    const Rect rect = cluster_rect(grid, size, cluster_cols, c);
+    const std::size_t k = cl.nodes.size();
+    cl.dist.assign(k * k, INF);
+    LocalSearch ws;
+    ws.goal.assign(rect.area(), 0);
+    ws.goals = k;
+    for (Node m : cl.nodes) ws.goal[rect.local(m)] = 1;
+    for (std::size_t i = 0; i < k; ++i) {
+        local_search(grid, rect, cl.nodes[i], -1, false, ws, nullptr);
+        for (std::size_t j = 0; j < k; ++j) {
+            cl.dist[i * k + j] = ws.dist[rect.local(cl.nodes[j])];
+            ws.goal[rect.local(cl.nodes[j])] = 1;
+        }
+    }
+}
+
+std::size_t HpaGrid::cells_changed(const std::vector<Node>& cells) {
+    const std::size_t nc = clusters.size();
+    std::vector<char> entrances(nc, 0), dirty(nc, 0);
+    for (Node u : cells) {
+        if (u < 0 || u >= grid.num_nodes()) {
+            throw std::runtime_error("HPA*: cell " + std::to_string(u) + " out of range");
+        }
+        const int c = cluster_of(u);
+        const Rect rect = cluster_rect(grid, size, cluster_cols, c);
+        dirty[c] = 1;
+        entrances[c] = 1;
+        // Las fronteras izquierda y superior pertenecen al vecino, y las
+        // esquinas de arriba a los clusters diagonales de arriba
+        const bool left = u % grid.cols == rect.c0 && rect.c0 > 0;
+        const bool top = u / grid.cols == rect.r0 && rect.r0 > 0;
+        const bool right = u % grid.cols == rect.c1 - 1 && rect.c1 < grid.cols;
+        if (left) entrances[c - 1] = 1;
+        if (top) entrances[c - cluster_cols] = 1;
+        if (top && left) entrances[c - cluster_cols - 1] = 1;
+        if (top && right) entrances[c - cluster_cols + 1] = 1;
+    }
+    for (std::size_t c = 0; c < nc; ++c) {
+        if (!entrances[c]) continue;
+        auto right = clusters[c].right, down = clusters[c].down, corner = clusters[c].corner;
+        find_entrances((int)c);
+        // Solo si cambian las transiciones cambian los nodos del vecino
+        if (clusters[c].right != right) dirty[c] = dirty[c + 1] = 1;
+        if (clusters[c].down != down) dirty[c] = dirty[c + cluster_cols] = 1;
+        if (clusters[c].corner != corner) {
+            dirty[c] = 1;
+            for (const auto& [_, b] : corner) dirty[cluster_of(b)] = 1;
+            for (const auto& [_, b] : clusters[c].corner) dirty[cluster_of(b)] = 1;
+        }
+    }
+    std::size_t rebuilt = 0;
+    for (std::size_t c = 0; c < nc; ++c) {
+        if (!dirty[c]) continue;
+        rebuild((int)c);
+        rebuilt++;
+    }
+    return rebuilt;
+}
+
+std::unordered_map<Node, Weight> HpaGrid::find_path(Node source, Node target, Instrument* instr,
+                                                    std::pmr::memory_resource* mem) const {
+    Instrument local_instr;
+    if (!instr) instr = &local_instr;
+    if (!mem) mem = std::pmr::get_default_resource();
+
+    std::unordered_map<Node, Weight> path;
+    const int n = grid.num_nodes();
+    if (source < 0 || source >= n || target < 0 || target >= n) return path;
+    if (grid.blocked(source) || grid.blocked(target)) return path;
+
+    // source y target con los nodos abstractos de su cluster
+    const int cs = cluster_of(source), ct = cluster_of(target);
+    const Rect rs = cluster_rect(grid, size, cluster_cols, cs);
+    const Rect rt = cluster_rect(grid, size, cluster_cols, ct);
+    LocalSearch from_source, to_target;
+    local_search(grid, rs, source, -1, false, from_source, instr);
+    local_search(grid, rt, target, -1, true, to_target, instr);
+
+    Weight best = INF;
+    Node last = -1;  // último nodo abstracto del mejor camino; -1 = directo dentro del cluster
+    if (cs == ct) best = from_source.dist[rs.local(target)];
+
+    // A* abstracto: g y padre por celda
+    std::pmr::unordered_map<Node, std::pair<Weight, Node>> state(mem);
+    std::priority_queue<PackedKey, std::pmr::vector<PackedKey>, std::greater<PackedKey>> open_list{
+        std::greater<PackedKey>(), std::pmr::vector<PackedKey>(mem)};
+    auto relax = [&](Node v, Weight g_v, Node parent) {
+        INSTR_ADD(instr, relaxations, 1);
+        auto& s = state.try_emplace(v, INF, parent).first->second;
+        if (g_v < s.first) {
+            s = {g_v, parent};
+            open_list.push(pack_key(g_v + grid.heuristic(v, target), v));
+            INSTR_ADD(instr, heap_ops, 1);
+            INSTR_HEAP(instr, open_list.size());
+        }
+    };
+    for (Node m : clusters[cs].nodes) {
+        Weight d = from_source.dist[rs.local(m)];
+        if (d < INF) relax(m, d, source);
+    }
+
+    while (!open_list.empty()) {
+        PackedKey key = open_list.top();
+        if (key_bits(key) > monotone_bits(best)) break;
+        open_list.pop();
+        INSTR_ADD(instr, heap_ops, 1);
+        const Node u = key_node(key);
+        const Weight g_u = state.find(u)->second.first;
+        if (key_bits(key) > monotone_bits(g_u + grid.heuristic(u, target))) {
+            INSTR_ADD(instr, stale_pops, 1);
+            continue;
+        }
+        INSTR_ADD(instr, settled, 1);
+
+        const int c = cluster_of(u);
+        if (c == ct && g_u + to_target.dist[rt.local(u)] < best) {
+            best = g_u + to_target.dist[rt.local(u)];
+            last = u;
+        }
+        const Cluster& cl = clusters[c];
+        const std::size_t k = cl.nodes.size(), i = (std::size_t)node_index(c, u);
+        for (std::size_t j = 0; j < k; ++j) {
+            if (j != i && cl.dist[i * k + j] < INF) relax(cl.nodes[j], g_u + cl.dist[i * k + j], u);
+        }
+        grid.for_each_out(u, [&](Node v, Weight w) {
+            int cv = cluster_of(v);
+            if (cv != c && node_index(cv, v) >= 0) relax(v, g_u + w, u);
+        });
+    }
+    if (!(best < INF)) return path;
+
+    // Puntos de paso source, nodos abstractos..., target
+    std::vector<Node> waypoints{target};
+    if (last >= 0) {
+        for (Node u = last; u != source; u = state.find(u)->second.second) waypoints.push_back(u);
+    }
+    waypoints.push_back(source);
+    std::reverse(waypoints.begin(), waypoints.end());
+
+    // Refinamiento: A* dentro del cluster entre puntos del mismo cluster;
+    // entre clusters distintos los puntos son vecinos en la malla
+    Weight acc = 0;
+    path[source] = 0;
+    LocalSearch ws;
+    std::vector<int> segment;
+    for (std::size_t s = 1; s < waypoints.size(); ++s) {
+        const Node x = waypoints[s - 1], y = waypoints[s];
+        if (x == y) continue;
+        const int cx = cluster_of(x);
+        if (cx == cluster_of(y)) {
+            const Rect rect = cluster_rect(grid, size, cluster_cols, cx);
+            local_search(grid, rect, x, y, false, ws, instr);
+            segment.clear();
+            for (int i = rect.local(y); i != rect.local(x); i = ws.parent[i]) segment.push_back(i);
+            for (auto it = segment.rbegin(); it != segment.rend(); ++it) path[rect.cell(*it)] = acc + ws.dist[*it];
+            acc += ws.dist[rect.local(y)];
+        } else {
+            Weight w = INF;
+            grid.for_each_out(x, [&](Node v, Weight wv) { if (v == y) w = std::min(w, wv); });
+            acc += w;
+            path[y] = acc;
+        }
+    }
+    return path;
+}
+
+std::size_t HpaGrid::abstract_nodes() const {
+    std::size_t total = 0;
+    for (const Cluster& cl : clusters) total += cl.nodes.size();
+    return total;
+}
+
+std::size_t HpaGrid::memory_bytes() const {
+    std::size_t bytes = sizeof(HpaGrid) + clusters.capacity() * sizeof(Cluster);
+    for (const Cluster& cl : clusters) {
+        bytes += cl.nodes.capacity() * sizeof(Node) + cl.dist.capacity() * sizeof(Weight) +
+                 (cl.right.capacity() + cl.down.capacity() + cl.corner.capacity()) * sizeof(std::pair<Node, Node>);
+    }
+    return bytes;
+}
@@ -0,0 +1,96 @@
+#include "./../include/instrumentation.h"
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
+#endif
+
+std::size_t peak_rss_bytes() {
+#if defined(__linux__) || defined(__APPLE__)
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+    return (std::size_t)usage.ru_maxrss;          // bytes
+#else
+    return (std::size_t)usage.ru_maxrss * 1024;   // KiB
+#endif
+#else
+    return 0;
+#endif
+}
+
+#ifdef __linux__
+namespace {
+
+int open_counter(uint64_t config, int group_fd) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    attr.disabled = (group_fd == -1) ? 1 : 0;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP;
+    return (int)syscall(__NR_perf_event_open, &attr, 0, -1, group_fd, 0);
+}
+
+}  // namespace
+#endif
+
+PerfCounters::PerfCounters() : fds{-1, -1, -1} {
+#ifdef __linux__
+    fds[0] = open_counter(PERF_COUNT_HW_INSTRUCTIONS, -1);
+    if (fds[0] < 0) return;
+    fds[1] = open_counter(PERF_COUNT_HW_CACHE_MISSES, fds[0]);
+    fds[2] = open_counter(PERF_COUNT_HW_BRANCH_MISSES, fds[0]);
+    if (fds[1] < 0 || fds[2] < 0) {
+        for (int& fd : fds) {
+            if (fd >= 0) close(fd);
+            fd = -1;
+        }
+    }
+#endif
+}
+
+PerfCounters::~PerfCounters() {
+#ifdef __linux__
+    for (int fd : fds) {
+        if (fd >= 0) close(fd);
+    }
+#endif
+}
+
+bool PerfCounters::available() const {
+    return fds[0] >= 0;
+}
+
+void PerfCounters::start() {
+#ifdef __linux__
+    if (!available()) return;
+    ioctl(fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+}
+
+PerfSample PerfCounters::stop() {
+    PerfSample sample;
+#ifdef __linux__
+    if (!available()) return sample;
+    ioctl(fds[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    struct { uint64_t nr; uint64_t values[3]; } data;
+    if (read(fds[0], &data, sizeof(data)) == (ssize_t)sizeof(data) && data.nr == 3) {
+        sample.instructions = (long long)data.values[0];
+        sample.cache_misses = (long long)data.values[1];
+        sample.branch_misses = (long long)data.values[2];
+    }
+#endif
+    return sample;
+}
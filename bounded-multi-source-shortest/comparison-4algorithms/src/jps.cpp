@@ -0,0 +1,271 @@
+#include "./../include/jps.h"
+#include "./../include/graph_concept.h"
+#include "./../include/instrumentation.h"
+#include "./../include/packed_key.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <queue>
+#include <stdexcept>
+
+namespace {
+
+const int* const DR = GridGraph::DR8;
+const int* const DC = GridGraph::DC8;
+
+inline int sgn(int x) { return (x > 0) - (x < 0); }
+
+// Índice en DR8/DC8 de la dirección (dr, dc); -1 para (0, 0)
+inline int dir_index(int dr, int dc) {
+    static const int index[9] = {7, 6, 5, 4, -1, 3, 2, 1, 0};
+    return index[(dr + 1) * 3 + (dc + 1)];
+}
+
+inline unsigned dir_bit(int dr, int dc) { return 1u << dir_index(dr, dc); }
+
+struct Cells {
+    const GridGraph& grid;
+
+    bool free(int r, int c) const {
+        return r >= 0 && r < grid.rows && c >= 0 && c < grid.cols && !grid.blocked(r * grid.cols + c);
+    }
+    Node node(int r, int c) const { return r * grid.cols + c; }
+};
+
+// Direcciones forzadas al llegar a (r, c) con el movimiento (dr, dc): vecinos
+// a los que solo se llega de forma óptima pasando por (r, c)
+unsigned forced_dirs(const Cells& m, int r, int c, int dr, int dc) {
+    unsigned mask = 0;
+    if (dr != 0 && dc != 0) {
+        if (!m.free(r - dr, c) && m.free(r - dr, c + dc)) mask |= dir_bit(-dr, dc);
+        if (!m.free(r, c - dc) && m.free(r + dr, c - dc)) mask |= dir_bit(dr, -dc);
+    } else if (dr == 0) {
+        for (int s = -1; s <= 1; s += 2) {
+            if (!m.free(r + s, c) && m.free(r + s, c + dc)) mask |= dir_bit(s, dc);
+        }
+    } else {
+        for (int s = -1; s <= 1; s += 2) {
+            if (!m.free(r, c + s) && m.free(r + dr, c + s)) mask |= dir_bit(dr, s);
+        }
+    }
+    return mask;
+}
+
+// Vecinos podados: naturales más forzados; desde el origen, los 8
+unsigned successor_dirs(const Cells& m, int r, int c, int dr, int dc) {
+    if (dr == 0 && dc == 0) return 0xFFu;
+    unsigned mask = dir_bit(dr, dc) | forced_dirs(m, r, c, dr, dc);
+    if (dr != 0 && dc != 0) mask |= dir_bit(dr, 0) | dir_bit(0, dc);
+    return mask;
+}
+
+const char* const NOT_UNIFORM = "JPS needs an 8-connected grid with one uniform cell cost";
+
+// Las consultas no recorren la malla: comprueban el modelo y usan min_weight
+// como coste (la uniformidad es precondición, ver jps.h)
+Weight query_cost(const GridGraph& grid) {
+    if (!grid.diag || grid.model != GridCostModel::CELL) throw std::runtime_error(NOT_UNIFORM);
+    return grid.min_weight;
+}
+
+// A* sobre puntos de salto. next(r, c, d, emit) llama a emit(v) con el
+// sucesor de (r, c) en la dirección d, si lo hay.
+template <class Next>
+std::unordered_map<Node, Weight> jump_search(const GridGraph& grid, Node source, Node target, Weight cost,
+                                             Instrument* instr, std::pmr::memory_resource* mem, Next next) {
+    Instrument local_instr;
+    if (!instr) instr = &local_instr;
+    if (!mem) mem = std::pmr::get_default_resource();
+
+    std::unordered_map<Node, Weight> path;
+    const int n = grid.num_nodes();
+    if (source < 0 || source >= n || target < 0 || target >= n) return path;
+
+    const Weight INF = std::numeric_limits<Weight>::infinity();
+    const Cells m{grid};
+    const Weight straight = cost, diagonal = cost * GridGraph::SQRT2;
+    // f = g + h se recalcula al sacar: sin un tercer vector de n entradas
+    NodeValues<GridGraph, Weight> g(grid, INF, mem);
+    NodeValues<GridGraph, Node> parent(grid, source, mem);
+
+    std::priority_queue<PackedKey, std::pmr::vector<PackedKey>, std::greater<PackedKey>> open_list{
+        std::greater<PackedKey>(), std::pmr::vector<PackedKey>(mem)};
+    g[source] = 0;
+    const Weight f_source = grid.heuristic(source, target);
+    open_list.push(pack_key(f_source, source));
+    INSTR_ADD(instr, heap_ops, 1);
+    Weight f_target = (source == target) ? f_source : INF;
+
+    while (!open_list.empty()) {
+        PackedKey key = open_list.top();
+        if (key_bits(key) > monotone_bits(f_target)) break;
+        open_list.pop();
+        INSTR_ADD(instr, heap_ops, 1);
+
+        Node u = key_node(key);
+        if (key_bits(key) > monotone_bits(g[u] + grid.heuristic(u, target))) {
+            INSTR_ADD(instr, stale_pops, 1);
+            continue;
+        }
+        INSTR_ADD(instr, settled, 1);
+
+        const int r = u / grid.cols, c = u % grid.cols;
+        const Node p = parent[u];
+        const int pdr = sgn(r - p / grid.cols), pdc = sgn(c - p % grid.cols);
+        const Weight g_u = g[u];
+        unsigned dirs = successor_dirs(m, r, c, pdr, pdc);
+        for (int d = 0; d < 8; ++d) {
+            if (!(dirs & (1u << d))) continue;
+            next(r, c, d, [&](Node v) {
+                INSTR_ADD(instr, relaxations, 1);
+                int steps = std::max(std::abs(v / grid.cols - r), std::abs(v % grid.cols - c));
+                Weight ng = g_u + steps * (DR[d] != 0 && DC[d] != 0 ? diagonal : straight);
+                if (ng < g[v]) {
+                    g[v] = ng;
+                    parent[v] = u;
+                    Weight fv = ng + grid.heuristic(v, target);
+                    if (v == target) f_target = fv;
+                    open_list.push(pack_key(fv, v));
+                    INSTR_ADD(instr, heap_ops, 1);
+                    INSTR_HEAP(instr, open_list.size());
+                }
+            });
+        }
+    }
+
+    if (!std::isfinite(g[target])) return path;
+
+    // Camino completo: cada tramo entre puntos de salto es recto o diagonal
+    path[target] = g[target];
+    for (Node v = target; v != source;) {
+        Node a = parent[v];
+        int ar = a / grid.cols, ac = a % grid.cols;
+        int dr = sgn(v / grid.cols - ar), dc = sgn(v % grid.cols - ac);
+        int steps = std::max(std::abs(v / grid.cols - ar), std::abs(v % grid.cols - ac));
+        Weight step = (dr != 0 && dc != 0) ? diagonal : straight;
+        for (int i = 1; i < steps; ++i) {
+            path[m.node(ar + i * dr, ac + i * dc)] = g[a] + i * step;
+        }
+        path[a] = g[a];
+        v = a;
+    }
+    return path;
+}
+
+// Salto de JPS: siguiente celda en (dr, dc) que es target, tiene vecinos
+// forzados o (en diagonal) desde la que un salto recto encuentra algo
+Node jump(const Cells& m, int r, int c, int dr, int dc, int tr, int tc) {
+    while (true) {
+        r += dr;
+        c += dc;
+        if (!m.free(r, c)) return -1;
+        if (r == tr && c == tc) return m.node(r, c);
+        if (forced_dirs(m, r, c, dr, dc)) return m.node(r, c);
+        if (dr != 0 && dc != 0 &&
+            (jump(m, r, c, dr, 0, tr, tc) >= 0 || jump(m, r, c, 0, dc, tr, tc) >= 0)) {
+            return m.node(r, c);
+        }
+    }
+}
+
+}  // namespace
+
+bool is_uniform_grid(const GridGraph& grid, Weight* cost) {
+    if (!grid.diag || grid.model != GridCostModel::CELL) return false;
+    const Weight INF = std::numeric_limits<Weight>::infinity();
+    Weight c = INF;
+    for (Weight x : grid.cell_cost) {
+        if (!(x < INF)) continue;
+        if (c == INF) c = x;
+        else if (x != c) return false;
+    }
+    if (cost) *cost = c;
+    return true;
+}
+
+JumpTable build_jump_table(const GridGraph& grid) {
+    auto t0 = std::chrono::steady_clock::now();
+    if (!is_uniform_grid(grid)) throw std::runtime_error(NOT_UNIFORM);
+    const Cells m{grid};
+    JumpTable t;
+    t.rows = grid.rows;
+    t.cols = grid.cols;
+    const std::size_t n = (std::size_t)grid.rows * grid.cols;
+    t.dist.assign(8 * n, 0);
+
+    // Rectas antes que diagonales (una diagonal consulta los saltos rectos
+    // de cada celda); cada celda después de su vecina en la dirección d
+    const int order[8] = {1, 3, 4, 6, 0, 2, 5, 7};
+    for (int d : order) {
+        const int dr = DR[d], dc = DC[d];
+        std::int32_t* plane = &t.dist[d * n];
+        const int dr_straight = dir_index(dr, 0), dc_straight = dir_index(0, dc);
+        for (int i = 0; i < grid.rows; ++i) {
+            int r = dr > 0 ? grid.rows - 1 - i : i;
+            for (int k = 0; k < grid.cols; ++k) {
+                int c = dc > 0 ? grid.cols - 1 - k : k;
+                int yr = r + dr, yc = c + dc;
+                std::int32_t& out = plane[m.node(r, c)];
+                if (!m.free(yr, yc)) {
+                    out = 0;
+                    continue;
+                }
+                Node y = m.node(yr, yc);
+                bool jump_point = forced_dirs(m, yr, yc, dr, dc) != 0;
+                if (!jump_point && dr != 0 && dc != 0) {
+                    jump_point = t.at(dr_straight, y) > 0 || t.at(dc_straight, y) > 0;
+                }
+                std::int32_t j = plane[y];
+                out = jump_point ? 1 : (j > 0 ? j + 1 : j - 1);
+            }
+        }
+    }
+    t.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return t;
+}
+
+std::unordered_map<Node, Weight> jps(const GridGraph& grid, Node source, Node target,
+                                     Instrument* instr, std::pmr::memory_resource* mem) {
+    Weight cost = query_cost(grid);
+    const Cells m{grid};
+    const int tr = target / grid.cols, tc = target % grid.cols;
+    return jump_search(grid, source, target, cost, instr, mem, [&](int r, int c, int d, auto&& emit) {
+        Node v = jump(m, r, c, DR[d], DC[d], tr, tc);
+        if (v >= 0) emit(v);
+    });
+}
+
+std::unordered_map<Node, Weight> jps_plus(const GridGraph& grid, const JumpTable& table, Node source, Node target,
+                                          Instrument* instr, std::pmr::memory_resource* mem) {
+    Weight cost = query_cost(grid);
+    if (table.rows != grid.rows || table.cols != grid.cols) {
+        throw std::runtime_error("jump table does not match the grid");
+    }
+    const Cells m{grid};
+    const int tr = target / grid.cols, tc = target % grid.cols;
+    return jump_search(grid, source, target, cost, instr, mem, [&](int r, int c, int d, auto&& emit) {
+        const int dr = DR[d], dc = DC[d];
+        const std::int32_t j = table.at(d, m.node(r, c));
+        const int reach = std::abs(j);  // celdas libres garantizadas en esa dirección
+        const int ar = tr - r, ac = tc - c;
+        if (dr != 0 && dc != 0) {
+            // target en el cuadrante: la celda alineada con él hace de punto de salto
+            if (sgn(ar) == dr && sgn(ac) == dc) {
+                int k = std::min(std::abs(ar), std::abs(ac));
+                if (k <= reach) {
+                    emit(m.node(r + k * dr, c + k * dc));
+                    return;
+                }
+            }
+        } else if ((dr == 0 && ar == 0 && sgn(ac) == dc) || (dc == 0 && ac == 0 && sgn(ar) == dr)) {
+            int k = std::abs(ar) + std::abs(ac);
+            if (k <= reach) {
+                emit(target);
+                return;
+            }
+        }
+        if (j > 0) emit(m.node(r + j * dr, c + j * dc));
+    });
+}
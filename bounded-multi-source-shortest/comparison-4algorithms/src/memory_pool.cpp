@@ -0,0 +1,42 @@
+#include "./../include/memory_pool.h"
+#include <stdexcept>
+
+const char* alloc_mode_name(AllocMode mode) {
+    switch (mode) {
+        case AllocMode::DEFAULT: return "default";
+        case AllocMode::POOL:    return "pool";
+        case AllocMode::ARENA:   return "arena";
+    }
+    return "default";
+}
+
+AllocMode parse_alloc_mode(const std::string& s) {
+    if (s == "default") return AllocMode::DEFAULT;
+    if (s == "pool")    return AllocMode::POOL;
+    if (s == "arena")   return AllocMode::ARENA;
+    throw std::runtime_error("unknown allocator mode: " + s);
+}
+
+QueryMemory::QueryMemory(AllocMode m, std::size_t arena_bytes)
+    : mode(m), buffer_bytes(arena_bytes) {
+    if (mode == AllocMode::POOL) {
+        pool.reset(new std::pmr::unsynchronized_pool_resource());
+    } else if (mode == AllocMode::ARENA) {
+        // Lo que no quepa en el bloque inicial se pide a new/delete y se
+        // libera en reset()
+        buffer.reset(new std::byte[buffer_bytes]);
+        arena.reset(new std::pmr::monotonic_buffer_resource(buffer.get(), buffer_bytes));
+    }
+}
+
+std::pmr::memory_resource* QueryMemory::resource() {
+    switch (mode) {
+        case AllocMode::POOL:  return pool.get();
+        case AllocMode::ARENA: return arena.get();
+        default:               return std::pmr::new_delete_resource();
+    }
+}
+
+void QueryMemory::reset() {
+    if (arena) arena->release();
+}
@@ -0,0 +1,217 @@
+#include "./../include/multi_agent.h"
+#include "./../include/instrumentation.h"
+#include "./../include/thread_pool.h"
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+const Weight INF = std::numeric_limits<Weight>::infinity();
+
+// Cambia (o añade) el peso de la arista hacia v en una lista de adyacencia
+void set_weight(std::vector<std::pair<Node, Weight>>& adj, Node v, Weight w) {
+    for (auto& [x, wx] : adj) {
+        if (x == v) {
+            wx = w;
+            return;
+        }
+    }
+    adj.push_back({v, w});
+}
+
+bool key_less(Weight a1, Weight a2, Weight b1, Weight b2) {
+    return a1 < b1 || (a1 == b1 && a2 < b2);
+}
+
+}  // namespace
+
+MultiAgentPlanner::Agent::Agent(Node s, Node g)
+    : start(s), goal(g),
+      memory(std::make_unique<std::pmr::unsynchronized_pool_resource>()),
+      states(memory.get()), open(memory.get()) {}
+
+MultiAgentPlanner::MultiAgentPlanner(Graph g, HeuristicFunction h) : graph(std::move(g)), heuristic(std::move(h)) {
+    reverse.reserve(graph.size());
+    for (const auto& [u, adj] : graph) {
+        for (const auto& [v, w] : adj) reverse[v].push_back({u, w});
+    }
+}
+
+MultiAgentPlanner::~MultiAgentPlanner() = default;
+
+MultiAgentPlanner::State& MultiAgentPlanner::state(Agent& a, Node u) {
+    auto [it, inserted] = a.states.try_emplace(u);
+    if (inserted) it->second.g = it->second.rhs = INF;
+    return it->second;
+}
+
+Weight MultiAgentPlanner::g_of(const Agent& a, Node u) const {
+    auto it = a.states.find(u);
+    return it == a.states.end() ? INF : it->second.g;
+}
+
+void MultiAgentPlanner::calculate_key(Agent& a, Node u, State& st, Weight& k1, Weight& k2) {
+    if (st.h_epoch != a.epoch) {
+        st.h = heuristic(a.start, u);
+        st.h_epoch = a.epoch;
+    }
+    k2 = std::min(st.g, st.rhs);
+    k1 = k2 + st.h + a.km;
+}
+
+void MultiAgentPlanner::update_vertex(Agent& a, Node u) {
+    State& st = state(a, u);
+    if (u != a.goal) {
+        Weight rhs = INF;
+        auto it = graph.find(u);
+        if (it != graph.end()) {
+            for (const auto& [v, w] : it->second) {
+                INSTR_ADD(&a.instr, relaxations, 1);
+                rhs = std::min(rhs, w + g_of(a, v));
+            }
+        }
+        st.rhs = rhs;
+    }
+    if (st.g != st.rhs) {
+        calculate_key(a, u, st, st.k1, st.k2);
+        st.open = true;
+        a.open.push_back({st.k1, st.k2, u});
+        std::push_heap(a.open.begin(), a.open.end());
+        INSTR_ADD(&a.instr, heap_ops, 1);
+        INSTR_HEAP(&a.instr, a.open.size());
+    } else {
+        st.open = false;  // su entrada, si la hay, queda obsoleta
+    }
+}
+
+void MultiAgentPlanner::compute_shortest_path(Agent& a) {
+    // Las referencias a elementos de un unordered_map sobreviven al rehash
+    State& start = state(a, a.start);
+    while (!a.open.empty()) {
+        OpenEntry top = a.open.front();
+        auto it = a.states.find(top.node);
+        if (it == a.states.end() || !it->second.open || it->second.k1 != top.k1 || it->second.k2 != top.k2) {
+            std::pop_heap(a.open.begin(), a.open.end());
+            a.open.pop_back();
+            INSTR_ADD(&a.instr, stale_pops, 1);
+            continue;
+        }
+        Weight s1, s2;
+        calculate_key(a, a.start, start, s1, s2);
+        if (!key_less(top.k1, top.k2, s1, s2) && start.g == start.rhs) break;
+
+        std::pop_heap(a.open.begin(), a.open.end());
+        a.open.pop_back();
+        INSTR_ADD(&a.instr, heap_ops, 1);
+
+        const Node u = top.node;
+        State& st = it->second;
+        Weight n1, n2;
+        calculate_key(a, u, st, n1, n2);
+        if (key_less(top.k1, top.k2, n1, n2)) {
+            // La clave subió (km o h nuevas): vuelve con la vigente
+            st.k1 = n1;
+            st.k2 = n2;
+            a.open.push_back({n1, n2, u});
+            std::push_heap(a.open.begin(), a.open.end());
+            INSTR_ADD(&a.instr, heap_ops, 1);
+            continue;
+        }
+        st.open = false;
+        auto preds = reverse.find(u);
+        if (st.g > st.rhs) {
+            st.g = st.rhs;
+            INSTR_ADD(&a.instr, settled, 1);
+            if (preds != reverse.end()) {
+                for (const auto& [p, w] : preds->second) update_vertex(a, p);
+            }
+        } else {
+            st.g = INF;
+            if (preds != reverse.end()) {
+                for (const auto& [p, w] : preds->second) update_vertex(a, p);
+            }
+            update_vertex(a, u);
+        }
+    }
+}
+
+void MultiAgentPlanner::extract_path(Agent& a) {
+    AgentPath& path = a.path;
+    path.nodes.clear();
+    path.cost = g_of(a, a.start);
+    if (path.cost == INF) return;
+
+    // Siguiente nodo: el sucesor que minimiza c(u, v) + g(v); el tope de
+    // pasos evita ciclos si algún g aún no es consistente
+    Node u = a.start;
+    path.nodes.push_back(u);
+    for (std::size_t steps = a.states.size(); u != a.goal && steps > 0; --steps) {
+        Weight best = INF;
+        Node next = u;
+        auto it = graph.find(u);
+        if (it != graph.end()) {
+            for (const auto& [v, w] : it->second) {
+                Weight c = w + g_of(a, v);
+                if (c < best) {
+                    best = c;
+                    next = v;
+                }
+            }
+        }
+        if (best == INF) break;
+        u = next;
+        path.nodes.push_back(u);
+    }
+    if (u != a.goal) {
+        path.nodes.clear();
+        path.cost = INF;
+    }
+}
+
+void MultiAgentPlanner::replan(Agent& a, const std::vector<Node>& changed_sources) {
+    // rhs(u) depende de las aristas de salida de u; un u sin estado tiene
+    // todos sus g infinitos o aún no lo ha alcanzado la búsqueda
+    for (Node u : changed_sources) {
+        if (a.states.count(u)) update_vertex(a, u);
+    }
+    compute_shortest_path(a);
+    extract_path(a);
+}
+
+int MultiAgentPlanner::add_agent(Node start, Node goal) {
+    agents.push_back(std::make_unique<Agent>(start, goal));
+    Agent& a = *agents.back();
+    State& st = state(a, goal);
+    st.rhs = 0;
+    calculate_key(a, goal, st, st.k1, st.k2);
+    st.open = true;
+    a.open.push_back({st.k1, st.k2, goal});
+    std::push_heap(a.open.begin(), a.open.end());
+    INSTR_ADD(&a.instr, heap_ops, 1);
+    return (int)agents.size() - 1;
+}
+
+void MultiAgentPlanner::move_agent(int id, Node start) {
+    Agent& a = *agents[id];
+    if (start == a.start) return;
+    // Las claves ya en el montículo siguen siendo cotas inferiores
+    a.km += heuristic(a.start, start);
+    a.start = start;
+    a.epoch++;
+}
+
+void MultiAgentPlanner::replan_all() {
+    // Los cambios se aplican una vez, antes de que ningún agente lea el grafo
+    std::vector<Node> sources;
+    sources.reserve(pending.size());
+    for (const Edge& e : pending) {
+        set_weight(graph[e.from], e.to, e.weight);
+        set_weight(reverse[e.to], e.from, e.weight);
+        sources.push_back(e.from);
+    }
+    pending.clear();
+    std::sort(sources.begin(), sources.end());
+    sources.erase(std::unique(sources.begin(), sources.end()), sources.end());
+
+    parallel_for(0, agents.size(), 1, [this, &sources](std::size_t i) { replan(*agents[i], sources); });
+}
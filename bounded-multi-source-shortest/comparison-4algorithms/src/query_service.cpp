@@ -0,0 +1,327 @@
+#include "./../include/query_service.h"
+#include "./../include/dijkstra.h"
+#include "./../include/astar.h"
+#include "./../include/dstar_lite.h"
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+std::uint64_t to_ns(clock_type::duration d) {
+    return (std::uint64_t)std::max<std::int64_t>(0, std::chrono::duration_cast<std::chrono::nanoseconds>(d).count());
+}
+
+std::int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now().time_since_epoch()).count();
+}
+
+// Cubeta de una latencia: cuatro por potencia de dos de nanosegundos
+int latency_bucket(std::uint64_t ns, int buckets) {
+    int b = (int)(std::log2((double)ns + 1.0) * 4.0);
+    return std::min(b, buckets - 1);
+}
+
+double bucket_upper_seconds(int b) { return std::exp2((b + 1) / 4.0) * 1e-9; }
+
+// Vueltas cediendo el procesador antes de que un hilo sin trabajo se duerma
+const int WORKER_SPINS = 64;
+
+// Espera activa breve y después dormida, para quien envía o espera en drain()
+void backoff(int& idle) {
+    if (++idle < 64) std::this_thread::yield();
+    else std::this_thread::sleep_for(std::chrono::microseconds(50));
+}
+
+}  // namespace
+
+const char* query_algorithm_name(QueryAlgorithm algorithm) {
+    switch (algorithm) {
+        case QueryAlgorithm::DIJKSTRA: return "dijkstra";
+        case QueryAlgorithm::BMSSP: return "bmssp";
+        case QueryAlgorithm::ASTAR: return "astar";
+        case QueryAlgorithm::DSTAR_LITE: return "dstar_lite";
+    }
+    return "astar";
+}
+
+QueryAlgorithm parse_query_algorithm(const std::string& s) {
+    if (s == "dijkstra") return QueryAlgorithm::DIJKSTRA;
+    if (s == "bmssp") return QueryAlgorithm::BMSSP;
+    if (s == "astar") return QueryAlgorithm::ASTAR;
+    if (s == "dstar_lite" || s == "dstar") return QueryAlgorithm::DSTAR_LITE;
+    throw std::runtime_error("unknown query algorithm: " + s + " (dijkstra, bmssp, astar, dstar_lite)");
+}
+
+QueryService::QueryService(Graph g, HeuristicFunction h, const ServiceOptions& opt)
+    : graph(std::move(g)), preds(graph), heuristic(std::move(h)), options(opt), queue(opt.queue_capacity) {
+    reset_stats();
+    int threads = opt.threads > 0 ? opt.threads : (int)std::thread::hardware_concurrency();
+    threads = std::max(1, threads);
+    workers.reserve(threads);
+    for (int i = 0; i < threads; ++i) workers.emplace_back([this, i]() { worker_loop(i); });
+}
+
+QueryService::~QueryService() { shutdown(); }
+
+void QueryService::enqueue(Job&& job) {
+    if (stopping.load(std::memory_order_acquire)) throw std::runtime_error("query service is shut down");
+    // Se cuenta antes de entrar en la cola para que drain() la espere
+    submitted.fetch_add(1, std::memory_order_relaxed);
+    job.enqueued = clock::now();
+    int idle = 0;
+    while (!queue.try_push(std::move(job))) backoff(idle);
+    wake_worker();
+}
+
+void QueryService::wake_worker() {
+    // Con la barrera del hilo que se duerme: o este ve sleepers > 0 o aquel
+    // ve la consulta en la cola
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleepers.load(std::memory_order_relaxed) == 0) return;
+    std::lock_guard<std::mutex> lock(wake_mutex);
+    wake.notify_one();
+}
+
+std::future<QueryResult> QueryService::submit(const QueryRequest& request) {
+    Job job;
+    job.request = request;
+    std::future<QueryResult> result = job.promise.get_future();
+    enqueue(std::move(job));
+    return result;
+}
+
+void QueryService::submit(const QueryRequest& request, QueryCallback callback) {
+    Job job;
+    job.request = request;
+    job.callback = std::move(callback);
+    enqueue(std::move(job));
+}
+
+std::vector<std::future<QueryResult>> QueryService::submit_batch(const std::vector<QueryRequest>& requests) {
+    std::vector<std::future<QueryResult>> results;
+    results.reserve(requests.size());
+    for (const QueryRequest& r : requests) results.push_back(submit(r));
+    return results;
+}
+
+bool QueryService::try_submit(const QueryRequest& request, QueryCallback callback) {
+    if (stopping.load(std::memory_order_acquire)) throw std::runtime_error("query service is shut down");
+    Job job;
+    job.request = request;
+    job.callback = std::move(callback);
+    job.enqueued = clock::now();
+    submitted.fetch_add(1, std::memory_order_relaxed);
+    if (queue.try_push(std::move(job))) {
+        wake_worker();
+        return true;
+    }
+    submitted.fetch_sub(1, std::memory_order_relaxed);
+    rejected.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+void QueryService::worker_loop(int id) {
+    QueryMemory memory(options.alloc);
+    Job job;
+    int idle = 0;
+    while (true) {
+        if (queue.try_pop(job)) {
+            run(job, id, memory);
+            job = Job();
+            idle = 0;
+            continue;
+        }
+        if (stopping.load(std::memory_order_acquire)) break;
+        if (++idle < WORKER_SPINS) {
+            std::this_thread::yield();
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(wake_mutex);
+        sleepers.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        wake.wait(lock, [this]() { return !queue.empty() || stopping.load(std::memory_order_acquire); });
+        sleepers.fetch_sub(1, std::memory_order_relaxed);
+        idle = 0;
+    }
+}
+
+void QueryService::run(Job& job, int id, QueryMemory& memory) {
+    const clock::time_point start = clock::now();
+    const Weight INF = std::numeric_limits<Weight>::infinity();
+    const Node s = job.request.source, t = job.request.target;
+    std::pmr::memory_resource* mem = memory.resource();
+
+    QueryResult result;
+    result.request = job.request;
+    result.worker = id;
+    result.distance = INF;
+    try {
+        auto lookup = [&](const std::unordered_map<Node, Weight>& dist) {
+            auto it = dist.find(t);
+            if (it != dist.end()) result.distance = it->second;
+        };
+        switch (job.request.algorithm) {
+            case QueryAlgorithm::DIJKSTRA:
+                lookup(dijkstra(graph, s, nullptr, mem));
+                break;
+            case QueryAlgorithm::BMSSP: {
+                std::unordered_map<Node, Weight> dist;
+                dist.reserve(graph.size());
+                for (const auto& [u, _] : graph) dist[u] = INF;
+                dist[s] = 0;
+                bmssp_complete(graph, dist, options.bmssp, INF, {s}, (int)graph.size(), nullptr, mem);
+                lookup(dist);
+                break;
+            }
+            case QueryAlgorithm::ASTAR:
+                lookup(astar(graph, s, t, heuristic, nullptr, mem));
+                break;
+            case QueryAlgorithm::DSTAR_LITE:
+                lookup(dstar_lite(graph, preds, s, t, heuristic, nullptr, mem));
+                break;
+        }
+    } catch (...) {
+        memory.reset();
+        failed.fetch_add(1, std::memory_order_relaxed);
+        if (!job.callback) job.promise.set_exception(std::current_exception());
+        return;
+    }
+    memory.reset();
+
+    const clock::time_point end = clock::now();
+    const std::uint64_t queue_ns = to_ns(start - job.enqueued);
+    const std::uint64_t service_ns = to_ns(end - start);
+    const std::uint64_t latency_ns = queue_ns + service_ns;
+    result.queue_seconds = queue_ns * 1e-9;
+    result.service_seconds = service_ns * 1e-9;
+
+    // Un callback que lanza no debe salir del hilo (std::terminate): cuenta
+    // como fallo y la consulta queda fuera de las latencias
+    if (job.callback) {
+        try {
+            job.callback(result);
+        } catch (...) {
+            failed.fetch_add(1, std::memory_order_release);
+            return;
+        }
+    }
+
+    latency_ns_sum.fetch_add(latency_ns, std::memory_order_relaxed);
+    queue_ns_sum.fetch_add(queue_ns, std::memory_order_relaxed);
+    service_ns_sum.fetch_add(service_ns, std::memory_order_relaxed);
+    latency_hist[latency_bucket(latency_ns, LATENCY_BUCKETS)].fetch_add(1, std::memory_order_relaxed);
+    std::uint64_t prev = latency_ns_max.load(std::memory_order_relaxed);
+    while (prev < latency_ns && !latency_ns_max.compare_exchange_weak(prev, latency_ns, std::memory_order_relaxed)) {}
+
+    // Contar antes de entregar: quien espera el future ya ve la consulta en stats()
+    completed.fetch_add(1, std::memory_order_release);
+    if (!job.callback) job.promise.set_value(std::move(result));
+}
+
+void QueryService::drain() {
+    int idle = 0;
+    while (completed.load(std::memory_order_acquire) + failed.load(std::memory_order_acquire) <
+           submitted.load(std::memory_order_acquire)) {
+        backoff(idle);
+    }
+}
+
+void QueryService::shutdown() {
+    if (workers.empty()) return;
+    drain();
+    stopping.store(true, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex);
+        wake.notify_all();
+    }
+    for (auto& w : workers) w.join();
+    workers.clear();
+}
+
+ServiceStats QueryService::stats() const {
+    ServiceStats st;
+    st.submitted = submitted.load(std::memory_order_relaxed);
+    st.completed = completed.load(std::memory_order_acquire);
+    st.failed = failed.load(std::memory_order_relaxed);
+    st.rejected = rejected.load(std::memory_order_relaxed);
+    st.elapsed_seconds = (now_ns() - stats_start_ns.load(std::memory_order_relaxed)) * 1e-9;
+    if (st.elapsed_seconds > 0) st.throughput = st.completed / st.elapsed_seconds;
+    if (st.completed == 0) return st;
+
+    st.mean_latency = latency_ns_sum.load(std::memory_order_relaxed) * 1e-9 / st.completed;
+    st.mean_queue = queue_ns_sum.load(std::memory_order_relaxed) * 1e-9 / st.completed;
+    st.mean_service = service_ns_sum.load(std::memory_order_relaxed) * 1e-9 / st.completed;
+    st.max_latency = latency_ns_max.load(std::memory_order_relaxed) * 1e-9;
+
+    std::array<std::uint64_t, LATENCY_BUCKETS> hist;
+    std::uint64_t total = 0;
+    for (int b = 0; b < LATENCY_BUCKETS; ++b) total += hist[b] = latency_hist[b].load(std::memory_order_relaxed);
+    auto percentile = [&](double q) {
+        std::uint64_t rank = (std::uint64_t)std::ceil(q * total), seen = 0;
+        for (int b = 0; b < LATENCY_BUCKETS; ++b) {
+            seen += hist[b];
+            if (seen >= rank && seen > 0) return std::min(bucket_upper_seconds(b), st.max_latency);
+        }
+        return st.max_latency;
+    };
+    st.p50_latency = percentile(0.50);
+    st.p99_latency = percentile(0.99);
+    return st;
+}
+
+void QueryService::reset_stats() {
+    submitted.store(0);
+    completed.store(0);
+    failed.store(0);
+    rejected.store(0);
+    latency_ns_sum.store(0);
+    queue_ns_sum.store(0);
+    service_ns_sum.store(0);
+    latency_ns_max.store(0);
+    for (auto& b : latency_hist) b.store(0);
+    stats_start_ns.store(now_ns());
+}
+
+std::vector<QueryRequest> load_query_log(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) throw std::runtime_error("cannot open query log: " + path);
+    std::vector<QueryRequest> requests;
+    std::string line;
+    for (std::size_t lineno = 1; std::getline(in, line); ++lineno) {
+        std::size_t first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#') continue;
+        std::istringstream is(line);
+        std::string alg;
+        long long s, t;
+        if (!(is >> alg >> s >> t)) {
+            throw std::runtime_error(path + ":" + std::to_string(lineno) + ": expected 'algorithm source target'");
+        }
+        requests.push_back({parse_query_algorithm(alg), (Node)s, (Node)t});
+    }
+    return requests;
+}
+
+ServiceStats replay_queries(QueryService& service, const std::vector<QueryRequest>& requests, double rate) {
+    service.drain();
+    service.reset_stats();
+    const auto start = std::chrono::steady_clock::now();
+    auto ignore = [](const QueryResult&) {};
+    for (std::size_t i = 0; i < requests.size(); ++i) {
+        if (rate > 0) {
+            std::this_thread::sleep_until(start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                                      std::chrono::duration<double>(i / rate)));
+            service.try_submit(requests[i], ignore);
+        } else {
+            service.submit(requests[i], ignore);
+        }
+    }
+    service.drain();
+    return service.stats();
+}
@@ -0,0 +1,270 @@
+#include "./../include/thread_pool.h"
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+using pool_detail::Task;
+using pool_detail::WorkDeque;
+
+namespace {
+
+// Trabajador que ejecuta el hilo actual (nullptr fuera de cualquier pool)
+struct CurrentWorker {
+    const ThreadPool* pool = nullptr;
+    int index = -1;
+};
+thread_local CurrentWorker current;
+
+// Antes de dormir, un trabajador sin tareas cede el procesador estas veces
+const int SPIN_ROUNDS = 64;
+
+void pin_thread(std::thread& th, int cpu) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    pthread_setaffinity_np(th.native_handle(), sizeof(set), &set);
+#else
+    (void)th;
+    (void)cpu;
+#endif
+}
+
+// Pool global: el puntero atómico evita el cerrojo una vez creado
+std::mutex global_mutex;
+std::unique_ptr<ThreadPool> global_owner;
+std::atomic<ThreadPool*> global_pool{nullptr};
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// Deque de Chase–Lev con los órdenes de memoria de Lê et al.
+
+WorkDeque::WorkDeque(std::int64_t capacity) {
+    arrays.push_back(std::make_unique<Array>(capacity));
+    array.store(arrays.back().get(), std::memory_order_relaxed);
+}
+
+void WorkDeque::push(Task* t) {
+    std::int64_t b = bottom.load(std::memory_order_relaxed);
+    std::int64_t tp = top.load(std::memory_order_acquire);
+    Array* a = array.load(std::memory_order_relaxed);
+    if (b - tp > a->capacity - 1) {
+        auto bigger = std::make_unique<Array>(a->capacity * 2);
+        for (std::int64_t i = tp; i < b; ++i) bigger->put(i, a->get(i));
+        a = bigger.get();
+        arrays.push_back(std::move(bigger));
+        array.store(a, std::memory_order_release);
+    }
+    a->put(b, t);
+    // Store release en vez de fence + relaxed: mismo código en x86 y así
+    // ThreadSanitizer ve la sincronización con steal()
+    bottom.store(b + 1, std::memory_order_release);
+}
+
+Task* WorkDeque::pop() {
+    std::int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+    Array* a = array.load(std::memory_order_relaxed);
+    bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    std::int64_t tp = top.load(std::memory_order_relaxed);
+    if (tp > b) {
+        bottom.store(b + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    Task* t = a->get(b);
+    if (tp == b) {
+        // Último elemento: se disputa con los ladrones
+        if (!top.compare_exchange_strong(tp, tp + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            t = nullptr;
+        }
+        bottom.store(b + 1, std::memory_order_relaxed);
+    }
+    return t;
+}
+
+Task* WorkDeque::steal() {
+    std::int64_t tp = top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    std::int64_t b = bottom.load(std::memory_order_acquire);
+    if (tp >= b) return nullptr;
+    Array* a = array.load(std::memory_order_acquire);
+    Task* t = a->get(tp);
+    if (!top.compare_exchange_strong(tp, tp + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+        return nullptr;  // otro ladrón o el dueño se la llevó
+    }
+    return t;
+}
+
+// ---------------------------------------------------------------------------
+
+ThreadPool::ThreadPool(const PoolOptions& opt) : inject(opt.inject_capacity) {
+    int hw = std::max(1, (int)std::thread::hardware_concurrency());
+    int threads = opt.threads > 0 ? opt.threads : hw;
+    workers.reserve(threads - 1);
+    for (int i = 0; i + 1 < threads; ++i) workers.push_back(std::make_unique<Worker>());
+    // Se arrancan cuando todas las deques existen: los ladrones las recorren
+    for (int i = 0; i + 1 < threads; ++i) {
+        workers[i]->thread = std::thread([this, i]() { worker_loop(i); });
+        if (opt.pin) pin_thread(workers[i]->thread, (i + 1) % hw);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    stopping.store(true, std::memory_order_seq_cst);
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+        epoch.fetch_add(1, std::memory_order_seq_cst);
+    }
+    wake.notify_all();
+    for (auto& w : workers) w->thread.join();
+}
+
+ThreadPool& ThreadPool::global() {
+    if (ThreadPool* p = global_pool.load(std::memory_order_acquire)) return *p;
+    std::lock_guard<std::mutex> lock(global_mutex);
+    if (!global_owner) {
+        global_owner = std::make_unique<ThreadPool>();
+        global_pool.store(global_owner.get(), std::memory_order_release);
+    }
+    return *global_owner;
+}
+
+void ThreadPool::configure_global(const PoolOptions& opt) {
+    std::lock_guard<std::mutex> lock(global_mutex);
+    if (global_owner) throw std::runtime_error("global thread pool already created");
+    global_owner = std::make_unique<ThreadPool>(opt);
+    global_pool.store(global_owner.get(), std::memory_order_release);
+}
+
+void ThreadPool::submit(Task* task) {
+    if (current.pool == this) {
+        workers[current.index]->deque.push(task);
+    } else if (!inject.try_push(std::move(task))) {
+        // Cola de inyección llena: la tarea corre aquí mismo
+        TaskGroup::execute(task);
+        return;
+    }
+    notify();
+}
+
+// Tras publicar cada tarea: la época avanza siempre, y solo si hay alguien
+// dormido se toma el cerrojo (vacío: basta con que quien está comprobando la
+// época antes de esperar termine de hacerlo) y se le despierta
+void ThreadPool::notify() {
+    epoch.fetch_add(1, std::memory_order_seq_cst);
+    if (sleeping.load(std::memory_order_seq_cst) == 0) return;
+    { std::lock_guard<std::mutex> lock(sleep_mutex); }
+    wake.notify_one();
+}
+
+bool ThreadPool::has_work() const {
+    if (!inject.empty()) return true;
+    for (const auto& w : workers) {
+        if (!w->deque.empty()) return true;
+    }
+    return false;
+}
+
+Task* ThreadPool::find_task() {
+    const int self = current.pool == this ? current.index : -1;
+    if (self >= 0) {
+        if (Task* t = workers[self]->deque.pop()) return t;
+    }
+    Task* t = nullptr;
+    if (inject.try_pop(t)) return t;
+    // Víctimas a partir de la siguiente deque, para no robar todos a la misma
+    const int n = (int)workers.size();
+    for (int k = 1; k <= n; ++k) {
+        int victim = (self + k + n) % n;
+        if (victim == self) continue;
+        if ((t = workers[victim]->deque.steal())) return t;
+    }
+    return nullptr;
+}
+
+void ThreadPool::worker_loop(int index) {
+    current.pool = this;
+    current.index = index;
+    int idle = 0;
+    while (!stopping.load(std::memory_order_acquire)) {
+        if (Task* t = find_task()) {
+            TaskGroup::execute(t);
+            idle = 0;
+            continue;
+        }
+        if (++idle < SPIN_ROUNDS) {
+            std::this_thread::yield();
+            continue;
+        }
+        // A dormir hasta que cambie la época. Una tarea publicada antes de
+        // leer e la ve has_work() (la época se incrementa después de
+        // publicarla); una posterior cambia la época, y notify() o bien ve
+        // sleeping > 0 y despierta, o bien la incrementó antes de que aquí se
+        // comprobara. Sin plazo: un pool ocioso no despierta a nadie.
+        std::uint64_t e = epoch.load(std::memory_order_seq_cst);
+        sleeping.fetch_add(1, std::memory_order_seq_cst);
+        {
+            std::unique_lock<std::mutex> lock(sleep_mutex);
+            if (!has_work()) {
+                wake.wait(lock, [&]() {
+                    return stopping.load(std::memory_order_seq_cst) ||
+                           epoch.load(std::memory_order_seq_cst) != e;
+                });
+            }
+        }
+        sleeping.fetch_sub(1, std::memory_order_seq_cst);
+        idle = 0;
+    }
+    current = CurrentWorker();
+}
+
+// ---------------------------------------------------------------------------
+
+void TaskGroup::execute(Task* task) {
+    TaskGroup* group = task->group;
+    try {
+        task->invoke(task);
+    } catch (...) {
+        group->fail(std::current_exception());
+    }
+    // Tras esto el grupo puede destruirse: no se vuelve a tocar
+    group->pending.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+void TaskGroup::fail(std::exception_ptr e) {
+    if (!failed.exchange(true, std::memory_order_acq_rel)) error = e;
+}
+
+void TaskGroup::wait() {
+    int idle = 0;
+    while (pending.load(std::memory_order_acquire) > 0) {
+        if (Task* t = pool.find_task()) {
+            execute(t);
+            idle = 0;
+        } else if (++idle < SPIN_ROUNDS) {
+            std::this_thread::yield();
+        } else {
+            // Lo que queda lo está ejecutando otro hilo
+            std::this_thread::sleep_for(std::chrono::microseconds(20));
+        }
+    }
+    if (failed.load(std::memory_order_acquire)) {
+        std::exception_ptr e = error;
+        error = nullptr;
+        failed.store(false, std::memory_order_relaxed);
+        std::rethrow_exception(e);
+    }
+}
+
+TaskGroup::~TaskGroup() {
+    try {
+        wait();
+    } catch (...) {
+        // Quien no llamó a wait() renuncia a la excepción
+    }
+}
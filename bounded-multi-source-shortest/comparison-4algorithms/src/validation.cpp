@@ -0,0 +1,103 @@
+#include "./../include/validation.h"
+#include "./../include/dijkstra.h"
+#include "./../include/bmssp.h"
+#include "./../include/astar.h"
+#include "./../include/dstar_lite.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+const Weight INF = std::numeric_limits<Weight>::infinity();
+
+Weight lookup(const std::unordered_map<Node, Weight>& dist, Node u) {
+    auto it = dist.find(u);
+    return it == dist.end() ? INF : it->second;
+}
+
+void note(ValidationReport& rep, Node u, Weight expected, Weight got) {
+    rep.mismatches++;
+    rep.first.push_back({u, expected, got});
+}
+
+}  // namespace
+
+bool distances_match(Weight expected, Weight got, double tolerance) {
+    if (std::isinf(expected) || std::isinf(got)) return std::isinf(expected) && std::isinf(got);
+    return std::fabs(expected - got) <= tolerance * std::max<Weight>(1.0, std::fabs(expected));
+}
+
+ValidationReport compare_all(const std::string& algorithm,
+                             const std::unordered_map<Node, Weight>& reference,
+                             const std::unordered_map<Node, Weight>& candidate,
+                             const ValidationOptions& opt) {
+    ValidationReport rep;
+    rep.algorithm = algorithm;
+
+    // Orden por id para que "primeros nodos" sea reproducible
+    std::vector<Node> nodes;
+    nodes.reserve(reference.size());
+    for (const auto& [u, _] : reference) nodes.push_back(u);
+    std::sort(nodes.begin(), nodes.end());
+
+    for (Node u : nodes) {
+        rep.checked++;
+        Weight expected = reference.at(u);
+        Weight got = lookup(candidate, u);
+        if (!distances_match(expected, got, opt.tolerance)) note(rep, u, expected, got);
+    }
+    if ((int)rep.first.size() > opt.max_report) rep.first.resize(std::max(0, opt.max_report));
+    return rep;
+}
+
+ValidationReport compare_one(const std::string& algorithm, Node node, Weight expected, Weight got,
+                             const ValidationOptions& opt) {
+    ValidationReport rep;
+    rep.algorithm = algorithm;
+    rep.checked = 1;
+    if (!distances_match(expected, got, opt.tolerance)) note(rep, node, expected, got);
+    if ((int)rep.first.size() > opt.max_report) rep.first.resize(std::max(0, opt.max_report));
+    return rep;
+}
+
+std::vector<ValidationReport> validate_query(const Graph& graph, Node source, Node target,
+                                             const HeuristicFunction& heuristic,
+                                             const ValidationOptions& opt,
+                                             const DegreeReduction* reduced) {
+    std::vector<ValidationReport> out;
+    auto reference = dijkstra(graph, source);
+    Weight expected_target = lookup(reference, target);
+
+    // BMSSP con B = infinito desde {source} debe fijar todas las distancias;
+    // se valida la versión que se mide (con Dijkstra de cierre si es parcial)
+    std::unordered_map<Node, Weight> dist_bm;
+    dist_bm.reserve(graph.size());
+    for (const auto& [u, _] : graph) dist_bm[u] = INF;
+    dist_bm[source] = 0.0;
+    int n = (int)graph.size();
+    BmsspParams params;
+    params.parallel = opt.bmssp_parallel;
+    bmssp_complete(graph, dist_bm, params, INF, {source}, n);
+    out.push_back(compare_all("bmssp", reference, dist_bm, opt));
+
+    if (reduced) {
+        std::unordered_map<Node, Weight> dist_red;
+        dist_red.reserve(reduced->graph.size());
+        for (const auto& [u, _] : reduced->graph) dist_red[u] = INF;
+        dist_red[source] = 0.0;
+        bmssp_complete(reduced->graph, dist_red, params, INF, {source}, (int)reduced->graph.size());
+        out.push_back(compare_all("bmssp_reduced", reference, map_back_distances(*reduced, dist_red), opt));
+    }
+
+    auto dist_astar = astar(graph, source, target, heuristic);
+    out.push_back(compare_one("astar", target, expected_target, lookup(dist_astar, target), opt));
+
+    // D*-lite busca hacia atrás desde el destino: g(source) es la distancia
+    // source -> target
+    auto dist_dstar = dstar_lite(graph, source, target, heuristic);
+    Weight got_dstar = (source == target) ? 0.0 : lookup(dist_dstar, source);
+    out.push_back(compare_one("dstar_lite", target, expected_target, got_dstar, opt));
+
+    return out;
+}
@@ -4,30 +4,100 @@
 #include "./../include/bmssp.h"
 #include "./../include/astar.h"
 #include "./../include/dstar_lite.h"
+#include "./../include/graph_io.h"
+#include "./../include/benchmark.h"
+#include "./../include/validation.h"
+#include "./../include/instrumentation.h"
+#include "./../include/bmssp_trace.h"
+#include "./../include/bmssp_tuner.h"
+#include "./../include/memory_pool.h"
+#include "./../include/degree_reduction.h"
+#include "./../include/jps.h"
+#include "./../include/hpa.h"
+#include "./../include/query_service.h"
+#include "./../include/thread_pool.h"
+#include "./../include/multi_agent.h"
+#include "./../include/anytime.h"
 
 #include <iostream>
 #include <fstream>
 #include <chrono>
 #include <cmath>
+#include <cstdlib>
 #include <limits>
 #include <string>
 #include <unordered_map>
 #include <random>
+#include <algorithm>
+#include <vector>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <thread>
+#include <atomic>
+
+static const char* const ALGORITHMS[4] = {"dijkstra", "bmssp", "astar", "dstar_lite"};
+static const char* const PHASE_NAMES[PHASE_COUNT] = {"find_pivots", "basecase", "d_pull", "batch_relax"};
 
 struct BenchResult { 
     double time_dij; 
     double time_bm; 
     double time_astar;
     double time_dstar;
+    double time_bm_reduced;  // BMSSP sobre el grafo de grado reducido; < 0 sin --degree-reduce
+    // Dijkstra, A* y D*-lite sobre la malla implícita; < 0 sin --implicit
+    double time_dij_grid, time_astar_grid, time_dstar_grid;
+    double time_jps, time_jps_plus;  // malla 8-conectada de coste uniforme; < 0 si no
+    double time_hpa, hpa_excess;     // HPA* y su coste / coste de A* - 1; < 0 sin --hpa
+    int grid_errors;                 // JPS/JPS+ con distancia distinta de A* o HPA* sin camino; < 0 sin --implicit
+    double grid_mb, adjacency_mb;  // memoria de la malla implícita y de G (estimada)
+    Instrument instr[4];   // en el orden de ALGORITHMS
+    PerfSample perf[4];
+};
+
+// Opciones de una ejecución de run_benchmark
+struct RunConfig {
+    PerfCounters* perf = nullptr;  // contadores hardware de cada algoritmo por separado
+    BmsspTrace* trace = nullptr;   // registro de las llamadas recursivas de bmssp()
+    BmsspParams bmssp;             // campos <= 0: valores por defecto
+    QueryMemory* memory = nullptr; // memoria de trabajo; nullptr = new/delete
+    const DegreeReduction* reduced = nullptr;  // además, BMSSP sobre el grafo reducido
+    const GridGraph* grid = nullptr;           // además, la misma malla sin listas de adyacencia
+    const JumpTable* jump_table = nullptr;     // malla uniforme con diag: además JPS y JPS+
+    const HpaGrid* hpa = nullptr;              // además HPA* sobre la malla implícita
+    Predecessors<Graph>* preds = nullptr;      // índice de D*-lite, uno por grafo; nullptr = uno por consulta
 };
 
-static BenchResult run_benchmark(const Graph& G, const std::vector<Edge>& E, Node source, Node target) {
+// Bytes aproximados de un Graph: nodo del unordered_map (siguiente, clave,
+// vector y hash), cubetas y aristas
+static double adjacency_bytes(const Graph& G) {
+    double bytes = G.bucket_count() * sizeof(void*);
+    for (const auto& [u, adj] : G) {
+        bytes += sizeof(void*) + sizeof(size_t) + sizeof(u) + sizeof(adj) + adj.capacity() * sizeof(adj[0]);
+    }
+    return bytes;
+}
+
+static BenchResult run_benchmark(const Graph& G, const std::vector<Edge>& E, Node source, Node target,
+                                 const HeuristicFunction& heuristic, const RunConfig& cfg = RunConfig()) {
+    using clock = std::chrono::steady_clock;
+    BenchResult r{};
+    PerfCounters* perf = cfg.perf;
+    r.instr[1].trace = cfg.trace;
+    auto perf_start = [&]() { if (perf) perf->start(); };
+    auto perf_stop = [&](int a) { if (perf) r.perf[a] = perf->stop(); };
+    // Cada algoritmo empieza con la arena vacía; los resultados ya no viven en ella
+    std::pmr::memory_resource* mem = cfg.memory ? cfg.memory->resource() : nullptr;
+    auto mem_reset = [&]() { if (cfg.memory) cfg.memory->reset(); };
+
     // Dijkstra
-    Instrument instr_dij;
-    auto t0 = std::chrono::high_resolution_clock::now();
-    auto dist_dij = dijkstra(G, source, &instr_dij);
-    auto t1 = std::chrono::high_resolution_clock::now();
-    double time_dij = std::chrono::duration<double>(t1 - t0).count();
+    mem_reset();
+    perf_start();
+    auto t0 = clock::now();
+    auto dist_dij = dijkstra(G, source, &r.instr[0], mem);
+    auto t1 = clock::now();
+    perf_stop(0);
+    r.time_dij = std::chrono::duration<double>(t1 - t0).count();
 
     // BMSSP
     std::unordered_map<Node, Weight> dist_bm;
@@ -36,36 +106,983 @@ static BenchResult run_benchmark(const Graph& G, const std::vector<Edge>& E, Nod
     dist_bm[source] = 0.0;
 
     int n_nodes = (int)G.size();
-    int l;
-    if (n_nodes <= 2) l = 1;
-    else {
-        int t_guess = std::max(1, (int)std::round(std::pow(std::log(std::max(3, n_nodes)), 2.0/3.0)));
-        l = std::max(1, (int)std::round(std::log(std::max(3, n_nodes)) / t_guess));
+
+    mem_reset();
+    perf_start();
+    t0 = clock::now();
+    (void)E;
+    bmssp_complete(G, dist_bm, cfg.bmssp, std::numeric_limits<double>::infinity(),
+                   {source}, n_nodes, &r.instr[1], mem);
+    t1 = clock::now();
+    perf_stop(1);
+    r.time_bm = std::chrono::duration<double>(t1 - t0).count();
+
+    // BMSSP sobre el grafo de grado reducido, incluida la vuelta a los ids
+    // originales (la transformación se hace una vez por grafo, fuera)
+    r.time_bm_reduced = -1.0;
+    if (cfg.reduced) {
+        const Graph& R = cfg.reduced->graph;
+        std::unordered_map<Node, Weight> dist_red;
+        dist_red.reserve(R.size());
+        for (const auto& [u, _] : R) dist_red[u] = std::numeric_limits<Weight>::infinity();
+        dist_red[source] = 0.0;
+        mem_reset();
+        t0 = clock::now();
+        bmssp_complete(R, dist_red, cfg.bmssp, std::numeric_limits<double>::infinity(),
+                       {source}, (int)R.size(), nullptr, mem);
+        map_back_distances(*cfg.reduced, dist_red);
+        t1 = clock::now();
+        r.time_bm_reduced = std::chrono::duration<double>(t1 - t0).count();
     }
 
-    Instrument instr_bm;
-    t0 = std::chrono::high_resolution_clock::now();
-    auto [Bp, U_final] = bmssp(G, dist_bm, E, l,
-                               std::numeric_limits<double>::infinity(),
-                               {source}, n_nodes, &instr_bm);
-    t1 = std::chrono::high_resolution_clock::now();
-    double time_bm = std::chrono::duration<double>(t1 - t0).count();
+    // Malla implícita: los mismos algoritmos sin hashing ni listas de adyacencia
+    r.time_dij_grid = r.time_astar_grid = r.time_dstar_grid = -1.0;
+    r.time_hpa = r.hpa_excess = -1.0;
+    r.time_jps = r.time_jps_plus = -1.0;
+    r.grid_mb = r.adjacency_mb = -1.0;
+    r.grid_errors = -1;
+    if (cfg.grid) {
+        const GridGraph& grid = *cfg.grid;
+        r.grid_mb = grid.memory_bytes() / (1024.0 * 1024.0);
+        r.adjacency_mb = adjacency_bytes(G) / (1024.0 * 1024.0);
+        r.grid_errors = 0;
+        auto timed = [&](auto&& run) {
+            mem_reset();
+            auto start = clock::now();
+            run();
+            return std::chrono::duration<double>(clock::now() - start).count();
+        };
+        r.time_dij_grid = timed([&]() { dijkstra_indexed(grid, source, nullptr, mem); });
+        std::unordered_map<Node, Weight> astar_grid;
+        r.time_astar_grid = timed([&]() { astar_grid = astar(grid, source, target, heuristic, nullptr, mem); });
+        r.time_dstar_grid = timed([&]() { dstar_lite(grid, source, target, heuristic, nullptr, mem); });
+        if (cfg.hpa) {
+            std::unordered_map<Node, Weight> path;
+            r.time_hpa = timed([&]() { path = cfg.hpa->find_path(source, target, nullptr, mem); });
+            if (!path.empty() && !astar_grid.empty()) {
+                Weight best = astar_grid[target];
+                r.hpa_excess = best > 0 ? path[target] / best - 1.0 : 0.0;
+            } else if (path.empty() != astar_grid.empty()) {
+                // HPA* es completo: o los dos encuentran camino o ninguno
+                r.grid_errors++;
+                std::cerr << "Aviso: hpa " << source << " -> " << target << (path.empty() ? " sin" : " con")
+                          << " camino y A* " << (astar_grid.empty() ? "sin" : "con") << " camino\n";
+            }
+        }
+        if (cfg.jump_table) {
+            // JPS y JPS+ son exactos: su distancia a target debe ser la de A*
+            auto at_target = [&](const std::unordered_map<Node, Weight>& d) {
+                auto it = d.find(target);
+                return it == d.end() ? std::numeric_limits<Weight>::infinity() : it->second;
+            };
+            Weight expected = at_target(astar_grid);
+            std::unordered_map<Node, Weight> d_jps, d_jps_plus;
+            r.time_jps = timed([&]() { d_jps = jps(grid, source, target, nullptr, mem); });
+            r.time_jps_plus = timed([&]() {
+                d_jps_plus = jps_plus(grid, *cfg.jump_table, source, target, nullptr, mem);
+            });
+            const std::pair<const char*, Weight> got[] = {{"jps", at_target(d_jps)},
+                                                          {"jps_plus", at_target(d_jps_plus)}};
+            for (const auto& [name, d] : got) {
+                if (distances_match(expected, d, 1e-9)) continue;
+                r.grid_errors++;
+                std::cerr << "Aviso: " << name << " " << source << " -> " << target << " da " << d
+                          << " y A* " << expected << "\n";
+            }
+        }
+    }
 
     // A*
-    Instrument instr_astar;
-    t0 = std::chrono::high_resolution_clock::now();
-    auto dist_astar = astar(G, source, target, euclidean_heuristic, &instr_astar);
-    t1 = std::chrono::high_resolution_clock::now();
-    double time_astar = std::chrono::duration<double>(t1 - t0).count();
+    mem_reset();
+    perf_start();
+    t0 = clock::now();
+    auto dist_astar = astar(G, source, target, heuristic, &r.instr[2], mem);
+    t1 = clock::now();
+    perf_stop(2);
+    r.time_astar = std::chrono::duration<double>(t1 - t0).count();
 
     // D*-lite
-    Instrument instr_dstar;
-    t0 = std::chrono::high_resolution_clock::now();
-    auto dist_dstar = dstar_lite(G, source, target, euclidean_heuristic, &instr_dstar);
-    t1 = std::chrono::high_resolution_clock::now();
-    double time_dstar = std::chrono::duration<double>(t1 - t0).count();
+    mem_reset();
+    perf_start();
+    t0 = clock::now();
+    auto dist_dstar = cfg.preds ? dstar_lite(G, *cfg.preds, source, target, heuristic, &r.instr[3], mem)
+                                : dstar_lite(G, source, target, heuristic, &r.instr[3], mem);
+    t1 = clock::now();
+    perf_stop(3);
+    r.time_dstar = std::chrono::duration<double>(t1 - t0).count();
+
+    return r;
+}
+
+// Fila de resultados como pares columna/valor; un valor vacío es un dato ausente
+using Row = std::vector<std::pair<std::string, std::string>>;
+
+static std::string fmt_num(double x) {
+    std::ostringstream os;
+    os.precision(9);
+    os << x;
+    return os.str();
+}
+
+// Añade tiempos y, si with_counters, contadores de Instrument, fases de BMSSP,
+// contadores hardware y pico de RSS. Las filas agregadas dejan vacías esas columnas.
+static void append_result(Row& row, const BenchResult& r, bool with_counters) {
+    row.push_back({"time_dijkstra", fmt_num(r.time_dij)});
+    row.push_back({"time_bmssp", fmt_num(r.time_bm)});
+    row.push_back({"time_astar", fmt_num(r.time_astar)});
+    row.push_back({"time_dstar_lite", fmt_num(r.time_dstar)});
+    auto optional = [](double x) { return x >= 0.0 ? fmt_num(x) : std::string(); };
+    row.push_back({"time_bmssp_reduced", optional(r.time_bm_reduced)});
+    row.push_back({"time_dijkstra_grid", optional(r.time_dij_grid)});
+    row.push_back({"time_astar_grid", optional(r.time_astar_grid)});
+    row.push_back({"time_dstar_lite_grid", optional(r.time_dstar_grid)});
+    row.push_back({"time_jps", optional(r.time_jps)});
+    row.push_back({"time_jps_plus", optional(r.time_jps_plus)});
+    row.push_back({"time_hpa", optional(r.time_hpa)});
+    row.push_back({"hpa_excess", optional(r.hpa_excess)});
+    row.push_back({"grid_errors", r.grid_errors >= 0 ? std::to_string(r.grid_errors) : std::string()});
+    row.push_back({"grid_mb", optional(r.grid_mb)});
+    row.push_back({"adjacency_mb", optional(r.adjacency_mb)});
+
+    auto count = [&](long long v) { return with_counters ? std::to_string(v) : std::string(); };
+    auto hw = [&](long long v) { return with_counters && v >= 0 ? std::to_string(v) : std::string(); };
+    for (int a = 0; a < 4; ++a) {
+        const Instrument& in = r.instr[a];
+        const PerfSample& ps = r.perf[a];
+        std::string name = ALGORITHMS[a];
+        row.push_back({"relaxations_" + name, count(in.relaxations)});
+        row.push_back({"heap_ops_" + name, count(in.heap_ops)});
+        row.push_back({"settled_" + name, count(in.settled)});
+        row.push_back({"stale_pops_" + name, count(in.stale_pops)});
+        row.push_back({"peak_heap_" + name, count((long long)in.peak_heap)});
+        row.push_back({"instructions_" + name, hw(ps.instructions)});
+        row.push_back({"cache_misses_" + name, hw(ps.cache_misses)});
+        row.push_back({"branch_misses_" + name, hw(ps.branch_misses)});
+    }
+
+    // Desglose de BMSSP: solo tiene datos con INSTRUMENTATION_LEVEL >= 2
+    const Instrument& bm = r.instr[1];
+    for (int p = 0; p < PHASE_COUNT; ++p) {
+        row.push_back({std::string("bmssp_") + PHASE_NAMES[p] + "_s",
+                       with_counters ? fmt_num(bm.phase_seconds[p]) : std::string()});
+    }
+    std::ostringstream levels;  // "nivel:llamadas:segundos;..."
+    if (with_counters) {
+        levels.precision(9);
+        bool first = true;
+        for (int l = 0; l < MAX_LEVELS; ++l) {
+            if (!bm.level_calls[l]) continue;
+            if (!first) levels << ";";
+            levels << l << ":" << bm.level_calls[l] << ":" << bm.level_seconds[l];
+            first = false;
+        }
+    }
+    row.push_back({"bmssp_levels", levels.str()});
+    row.push_back({"bmssp_partial_calls", count(r.instr[1].partial_calls)});
+    row.push_back({"bmssp_fallback_settled", count(r.instr[1].fallback_settled)});
+    row.push_back({"bmssp_parallel_rounds", count(r.instr[1].pivot_rounds_parallel)});
+    row.push_back({"bmssp_bottom_up_rounds", count(r.instr[1].pivot_rounds_bottom_up)});
+    row.push_back({"peak_rss_mb", with_counters ? fmt_num(peak_rss_bytes() / (1024.0 * 1024.0)) : std::string()});
+}
+
+// Escribe filas como CSV (cabecera tomada de la primera fila) y, si json
+// no es nulo, como un array JSON con un objeto por fila
+class RowWriter {
+private:
+    std::ostream& csv;
+    std::ostream* json;
+    bool header_done = false;
+    bool json_first = true;
+
+    static bool is_number(const std::string& v) {
+        if (v.empty()) return false;
+        char* end = nullptr;
+        std::strtod(v.c_str(), &end);
+        return end && *end == '\0';
+    }
+
+public:
+    RowWriter(std::ostream& csv_out, std::ostream* json_out) : csv(csv_out), json(json_out) {
+        if (json) *json << "[\n";
+    }
+    ~RowWriter() {
+        if (json) *json << (json_first ? "" : "\n") << "]\n";
+    }
+
+    void write(const Row& row) {
+        if (!header_done) {
+            for (size_t i = 0; i < row.size(); ++i) csv << (i ? "," : "") << row[i].first;
+            csv << "\n";
+            header_done = true;
+        }
+        for (size_t i = 0; i < row.size(); ++i) csv << (i ? "," : "") << row[i].second;
+        csv << "\n";
+
+        if (!json) return;
+        *json << (json_first ? "  {" : ",\n  {");
+        json_first = false;
+        for (size_t i = 0; i < row.size(); ++i) {
+            const std::string& v = row[i].second;
+            *json << (i ? ", " : "") << "\"" << row[i].first << "\": ";
+            if (v.empty()) *json << "null";
+            else if (is_number(v)) *json << v;
+            else *json << "\"" << v << "\"";
+        }
+        *json << "}";
+    }
+};
+
+// Mide cada algoritmo por separado con el arnés (calentamiento, repetición
+// hasta IC objetivo, percentiles) sobre la misma consulta, una vez por modo
+// de memoria. Con más de un modo la etiqueta lleva el modo ("bmssp/arena").
+static std::vector<BenchRecord> run_stats(const Graph& G, Predecessors<Graph>& preds, Node source, Node target,
+                                          const HeuristicFunction& heuristic,
+                                          const HarnessOptions& hopt,
+                                          const BmsspParams& bm_params,
+                                          const std::vector<AllocMode>& alloc_modes,
+                                          int graph, unsigned seed,
+                                          const DegreeReduction* reduced = nullptr) {
+    int n_nodes = (int)G.size();
+    std::unordered_map<Node, Weight> dist_bm;
+
+    std::vector<BenchRecord> out;
+    for (AllocMode am : alloc_modes) {
+        QueryMemory memory(am);
+        std::pmr::memory_resource* mem = memory.resource();
+
+        auto record = [&](const std::string& name, BenchStats st) {
+            BenchRecord r;
+            r.label = alloc_modes.size() > 1 ? name + "/" + alloc_mode_name(am) : name;
+            r.fields = {{"graph", std::to_string(graph)}, {"seed", std::to_string(seed)},
+                        {"source", std::to_string(source)}, {"target", std::to_string(target)},
+                        {"alloc", alloc_mode_name(am)}};
+            r.stats = std::move(st);
+            return r;
+        };
+        auto reset = [&]() { memory.reset(); };
+
+        out.push_back(record("dijkstra", measure([&]() { dijkstra(G, source, nullptr, mem); }, hopt, reset)));
+        out.push_back(record("bmssp", measure(
+            [&]() {
+                bmssp_complete(G, dist_bm, bm_params, std::numeric_limits<double>::infinity(), {source},
+                               n_nodes, nullptr, mem);
+            },
+            hopt,
+            [&]() {
+                memory.reset();
+                dist_bm.clear();
+                dist_bm.reserve(G.size());
+                for (const auto& [u, _] : G) dist_bm[u] = std::numeric_limits<Weight>::infinity();
+                dist_bm[source] = 0.0;
+            })));
+        if (reduced) {
+            const Graph& R = reduced->graph;
+            out.push_back(record("bmssp_reduced", measure(
+                [&]() {
+                    bmssp_complete(R, dist_bm, bm_params, std::numeric_limits<double>::infinity(), {source},
+                                   (int)R.size(), nullptr, mem);
+                    map_back_distances(*reduced, dist_bm);
+                },
+                hopt,
+                [&]() {
+                    memory.reset();
+                    dist_bm.clear();
+                    dist_bm.reserve(R.size());
+                    for (const auto& [u, _] : R) dist_bm[u] = std::numeric_limits<Weight>::infinity();
+                    dist_bm[source] = 0.0;
+                })));
+        }
+        out.push_back(record("astar", measure([&]() { astar(G, source, target, heuristic, nullptr, mem); },
+                                              hopt, reset)));
+        out.push_back(record("dstar_lite", measure(
+            [&]() { dstar_lite(G, preds, source, target, heuristic, nullptr, mem); }, hopt, reset)));
+    }
+    return out;
+}
+
+// Nodos del grafo en orden creciente, para sortear fuentes/destinos
+// reproducibles también en grafos cargados con ids no contiguos
+// "1000,2000,4000" -> {1000, 2000, 4000}; lanza std::runtime_error si algún valor no es un número
+static std::vector<double> parse_number_list(const std::string& s) {
+    std::vector<double> out;
+    std::stringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        char* end = nullptr;
+        double x = std::strtod(item.c_str(), &end);
+        if (item.empty() || *end != '\0') throw std::runtime_error("invalid number list: " + s);
+        out.push_back(x);
+    }
+    if (out.empty()) throw std::runtime_error("empty number list");
+    return out;
+}
+
+static std::vector<Node> sorted_nodes(const Graph& G) {
+    std::vector<Node> nodes;
+    nodes.reserve(G.size());
+    for (const auto& [u, _] : G) nodes.push_back(u);
+    std::sort(nodes.begin(), nodes.end());
+    return nodes;
+}
+
+static double mean_of(std::vector<double> v) {
+    double acc = 0.0;
+    for (double x : v) acc += x;
+    return v.empty() ? 0.0 : acc / v.size();
+}
+
+static double median_of(std::vector<double> v) {
+    if (v.empty()) return 0.0;
+    std::sort(v.begin(), v.end());
+    size_t h = v.size() / 2;
+    return (v.size() % 2) ? v[h] : 0.5 * (v[h - 1] + v[h]);
+}
+
+// Filas agregadas (media y mediana) de todas las consultas de un grafo;
+// en ellas la columna query guarda el número de consultas
+static void write_sweep_aggregates(RowWriter& out, int graph, unsigned seed, AllocMode alloc,
+                                   const std::vector<BenchResult>& rows) {
+    // Los tiempos opcionales (< 0 sin la opción correspondiente) quedan fuera;
+    // hpa_excess se agrega igual que un tiempo
+    static double BenchResult::* const TIMES[] = {
+        &BenchResult::time_dij, &BenchResult::time_bm, &BenchResult::time_astar, &BenchResult::time_dstar,
+        &BenchResult::time_bm_reduced, &BenchResult::time_dij_grid, &BenchResult::time_astar_grid,
+        &BenchResult::time_dstar_grid, &BenchResult::time_jps, &BenchResult::time_jps_plus,
+        &BenchResult::time_hpa, &BenchResult::hpa_excess};
+    auto aggregate = [&](const char* kind, double (*stat)(std::vector<double>)) {
+        BenchResult r{};
+        for (auto field : TIMES) {
+            std::vector<double> v;
+            for (const auto& q : rows) {
+                if (q.*field >= 0.0) v.push_back(q.*field);
+            }
+            r.*field = v.empty() ? -1.0 : stat(std::move(v));
+        }
+        // Errores de la malla: la suma de todas las consultas
+        r.grid_errors = -1;
+        for (const auto& q : rows) {
+            if (q.grid_errors >= 0) r.grid_errors = std::max(r.grid_errors, 0) + q.grid_errors;
+        }
+        r.grid_mb = rows.empty() ? -1.0 : rows.front().grid_mb;
+        r.adjacency_mb = rows.empty() ? -1.0 : rows.front().adjacency_mb;
+        Row row = {{"kind", kind}, {"graph", std::to_string(graph)}, {"seed", std::to_string(seed)},
+                   {"query", std::to_string(rows.size())}, {"source", ""}, {"target", ""},
+                   {"alloc", alloc_mode_name(alloc)}};
+        append_result(row, r, false);
+        out.write(row);
+    };
+    aggregate("mean", mean_of);
+    aggregate("median", median_of);
+}
+
+// Una pasada de dijkstra_csr con pesos W sobre las mismas fuentes
+struct WeightRun {
+    const char* name = "";
+    std::size_t bytes = 0;         // offsets + targets + weights del CSR
+    std::vector<double> seconds;   // una medida por fuente
+    double max_abs_error = 0.0;    // distancias frente a la referencia
+    double max_rel_error = 0.0;
+    std::size_t reach_mismatches = 0;  // alcanzable en uno e infinito en otro (saturación)
+    WeightCastReport cast;
+};
 
-    return {time_dij, time_bm, time_astar, time_dstar};
+// Convierte csr a W y mide cada fuente. Si reference está vacía la rellena
+// con las distancias obtenidas (pasada de referencia).
+template <class W>
+static WeightRun measure_weight_type(const CsrGraph& csr, const std::vector<Node>& sources, double scale,
+                                     int warmup, std::vector<std::vector<double>>& reference) {
+    using clock = std::chrono::steady_clock;
+    WeightRun run;
+    run.name = WeightTraits<W>::name;
+    BasicCsrGraph<W> g = cast_weights<W>(csr, scale, &run.cast);
+    run.bytes = g.offsets.size() * sizeof(std::size_t) + g.targets.size() * sizeof(Node) +
+                g.weights.size() * sizeof(W);
+
+    const bool fill = reference.empty();
+    for (int w = 0; w < warmup && !sources.empty(); ++w) dijkstra_csr(g, sources[w % sources.size()]);
+    for (size_t q = 0; q < sources.size(); ++q) {
+        auto t0 = clock::now();
+        std::vector<W> dist = dijkstra_csr(g, sources[q]);
+        auto t1 = clock::now();
+        run.seconds.push_back(std::chrono::duration<double>(t1 - t0).count());
+
+        std::vector<double> d(dist.size());
+        for (size_t u = 0; u < dist.size(); ++u) d[u] = WeightTraits<W>::to_double(dist[u], g.scale);
+        if (fill) {
+            reference.push_back(std::move(d));
+            continue;
+        }
+        const std::vector<double>& ref = reference[q];
+        for (size_t u = 0; u < d.size(); ++u) {
+            if (std::isinf(ref[u]) || std::isinf(d[u])) {
+                if (std::isinf(ref[u]) != std::isinf(d[u])) run.reach_mismatches++;
+                continue;
+            }
+            double err = std::fabs(d[u] - ref[u]);
+            run.max_abs_error = std::max(run.max_abs_error, err);
+            if (ref[u] > 0.0) run.max_rel_error = std::max(run.max_rel_error, err / ref[u]);
+        }
+    }
+    return run;
+}
+
+// Compara double, float y Fixed32 sobre el mismo grafo y las mismas fuentes;
+// una fila por tipo con tiempo, memoria del CSR y error frente a double
+static void compare_weight_types(RowWriter& out, const CsrGraph& csr, int graph, unsigned seed,
+                                 int queries, unsigned query_seed, int warmup, double fixed_scale) {
+    int n = csr.num_nodes();
+    if (n <= 0) return;
+    std::mt19937 qrng(query_seed + 7919u * (unsigned)graph);
+    std::vector<Node> sources;
+    for (int q = 0; q < std::max(1, queries); ++q) sources.push_back((Node)(qrng() % (unsigned)n));
+
+    std::vector<std::vector<double>> reference;
+    std::vector<WeightRun> runs;
+    runs.push_back(measure_weight_type<double>(csr, sources, 1.0, warmup, reference));
+    runs.push_back(measure_weight_type<float>(csr, sources, 1.0, warmup, reference));
+    try {
+        runs.push_back(measure_weight_type<Fixed32>(csr, sources, fixed_scale, warmup, reference));
+    } catch (const std::exception& ex) {
+        std::cerr << "Aviso: fixed32 con escala " << fixed_scale << " no aplicable: " << ex.what() << "\n";
+    }
+
+    double base = median_of(runs.front().seconds);
+    for (const WeightRun& r : runs) {
+        double med = median_of(r.seconds);
+        std::cout << "  " << r.name << ": mediana " << med << " s (x" << (med > 0.0 ? base / med : 0.0)
+                  << "), CSR " << r.bytes / (1024.0 * 1024.0) << " MB, error máx " << r.max_abs_error
+                  << (r.reach_mismatches ? ", distancias saturadas" : "")
+                  << (r.cast.path_may_overflow ? ", cota de camino fuera de rango" : "")
+                  << (r.cast.path_may_lose_precision ? ", precisión insuficiente para caminos largos" : "")
+                  << "\n";
+        Row row = {{"graph", std::to_string(graph)}, {"seed", std::to_string(seed)},
+                   {"weight", r.name}, {"scale", fmt_num(std::string(r.name) == "fixed32" ? fixed_scale : 1.0)},
+                   {"queries", std::to_string(r.seconds.size())}, {"csr_bytes", std::to_string(r.bytes)},
+                   {"median_s", fmt_num(med)}, {"speedup_vs_double", fmt_num(med > 0.0 ? base / med : 0.0)},
+                   {"max_abs_error", fmt_num(r.max_abs_error)}, {"max_rel_error", fmt_num(r.max_rel_error)},
+                   {"reach_mismatches", std::to_string(r.reach_mismatches)},
+                   {"cast_max_abs_error", fmt_num(r.cast.max_abs_error)},
+                   {"cast_zeroed", std::to_string(r.cast.zeroed)},
+                   {"path_may_overflow", r.cast.path_may_overflow ? "1" : "0"},
+                   {"path_may_lose_precision", r.cast.path_may_lose_precision ? "1" : "0"}};
+        out.write(row);
+    }
+}
+
+static const char* graph_type_name(GraphType t) {
+    switch (t) {
+        case GraphType::RANDOM_M:    return "random-m";
+        case GraphType::ER:          return "er";
+        case GraphType::BA:          return "ba";
+        case GraphType::WS:          return "ws";
+        case GraphType::GRID2D:      return "grid2d";
+        case GraphType::LAYERED_DAG: return "layered-dag";
+    }
+    return "random-m";
+}
+
+// Totales de validación por algoritmo: consultas y consultas con errores
+struct ValidationTotals {
+    std::map<std::string, std::pair<size_t, size_t>> per_algorithm;
+    size_t failed_queries = 0;
+};
+
+// Una fila por informe de la consulta source -> target y suma a los totales
+static void record_reports(std::ofstream& fout, const std::string& gname, int graph, unsigned seed,
+                           Node source, Node target, const std::vector<ValidationReport>& reports,
+                           ValidationTotals& totals) {
+    bool failed = false;
+    for (const auto& rep : reports) {
+        auto& tot = totals.per_algorithm[rep.algorithm];
+        tot.first++;
+        if (!rep.ok()) { tot.second++; failed = true; }
+
+        std::ostringstream first;
+        for (size_t j = 0; j < rep.first.size(); ++j) {
+            if (j) first << ";";
+            first << rep.first[j].node << ":" << rep.first[j].expected << "/" << rep.first[j].got;
+        }
+        fout << gname << "," << graph << "," << seed << "," << source << "," << target << ","
+             << rep.algorithm << "," << rep.checked << "," << rep.mismatches << "," << first.str() << "\n";
+    }
+    if (failed) totals.failed_queries++;
+}
+
+// Valida `queries` pares aleatorios sobre G y escribe una fila por algoritmo
+static void validate_graph(std::ofstream& fout, const std::string& gname, int graph, unsigned seed,
+                           const Graph& G, const HeuristicFunction& heuristic, int queries, unsigned query_seed,
+                           const ValidationOptions& vopt, ValidationTotals& totals,
+                           int degree_max = 0) {
+    std::vector<Node> nodes = sorted_nodes(G);
+    if (nodes.empty()) return;
+    std::mt19937 qrng(query_seed + 7919u * (unsigned)graph);
+    auto pick = [&]() { return nodes[qrng() % nodes.size()]; };
+    DegreeReduction reduction;
+    if (degree_max > 0) reduction = reduce_degree(G, degree_max);
+
+    for (int q = 0; q < queries; ++q) {
+        Node s_q = pick(), t_q = pick();
+        auto reports = validate_query(G, s_q, t_q, heuristic, vopt, degree_max > 0 ? &reduction : nullptr);
+        record_reports(fout, gname, graph, seed, s_q, t_q, reports, totals);
+    }
+}
+
+// Valida `queries` pares de celdas libres de la malla implícita: distancia a
+// target de A* y, si la malla es uniforme (jump_table), de JPS y JPS+ contra
+// dijkstra_indexed. HPA* es casi óptimo: solo se exige que encuentre camino
+// cuando lo hay y que no sea más corto que el óptimo.
+static void validate_grid(std::ofstream& fout, int graph, unsigned seed, const GridGraph& grid,
+                          const JumpTable* jump_table, const HpaGrid* hpa, int queries, unsigned query_seed,
+                          const ValidationOptions& vopt, ValidationTotals& totals) {
+    std::vector<Node> cells;
+    for (Node u = 0; u < grid.num_nodes(); ++u) {
+        if (!grid.blocked(u)) cells.push_back(u);
+    }
+    if (cells.empty()) return;
+    std::mt19937 qrng(query_seed + 7919u * (unsigned)graph);
+    auto pick = [&]() { return cells[qrng() % cells.size()]; };
+    HeuristicFunction h = [&grid](Node a, Node b) { return grid.heuristic(a, b); };
+    auto at = [](const std::unordered_map<Node, Weight>& d, Node u) {
+        auto it = d.find(u);
+        return it == d.end() ? std::numeric_limits<Weight>::infinity() : it->second;
+    };
+
+    for (int q = 0; q < queries; ++q) {
+        Node s_q = pick(), t_q = pick();
+        Weight expected = dijkstra_indexed(grid, s_q)[t_q];
+        std::vector<ValidationReport> reports;
+        reports.push_back(compare_one("astar_grid", t_q, expected, at(astar(grid, s_q, t_q, h), t_q), vopt));
+        if (jump_table) {
+            reports.push_back(compare_one("jps", t_q, expected, at(jps(grid, s_q, t_q), t_q), vopt));
+            reports.push_back(compare_one("jps_plus", t_q, expected,
+                                          at(jps_plus(grid, *jump_table, s_q, t_q), t_q), vopt));
+        }
+        if (hpa) {
+            ValidationReport rep;
+            rep.algorithm = "hpa";
+            rep.checked = 1;
+            Weight got = at(hpa->find_path(s_q, t_q), t_q);
+            bool complete = std::isinf(expected) == std::isinf(got);
+            if (!complete || (!std::isinf(got) && got < expected && !distances_match(expected, got, vopt.tolerance))) {
+                rep.mismatches = 1;
+                rep.first.push_back({t_q, expected, got});
+            }
+            reports.push_back(rep);
+        }
+        record_reports(fout, "grid-implicit", graph, seed, s_q, t_q, reports, totals);
+    }
+}
+
+// Parámetros pequeños y variados para la prueba de estrés de cada tipo de grafo
+static GraphGenOptions random_stress_options(GraphType t, std::mt19937& rng, double wmax) {
+    auto uni = [&](int lo, int hi) { return lo + (int)(rng() % (unsigned)(hi - lo + 1)); };
+    GraphGenOptions opt;
+    opt.wmax = wmax;
+    opt.seed = rng();
+    switch (t) {
+        case GraphType::RANDOM_M:  opt.n = uni(20, 2000); opt.m = opt.n * uni(1, 6); break;
+        case GraphType::ER:        opt.n = uni(20, 600); opt.p = uni(1, 8) / (double)opt.n; break;
+        case GraphType::BA:        opt.n = uni(20, 2000); opt.attach = uni(1, 4); break;
+        case GraphType::WS:        opt.n = uni(20, 2000); opt.k = uni(2, 8); opt.beta = uni(0, 30) / 100.0; break;
+        case GraphType::GRID2D:    opt.rows = uni(2, 40); opt.cols = uni(2, 40); opt.diag = rng() % 2; break;
+        case GraphType::LAYERED_DAG: opt.layers = uni(2, 12); opt.width = uni(2, 60); opt.dagp = uni(5, 30) / 100.0; break;
+    }
+    return opt;
+}
+
+// Suma de [lo, hi) partiendo el rango por fork/join hasta hojas de 64: un
+// árbol de tareas anidadas que obliga a robar a todos los niveles
+static uint64_t fork_join_sum(uint64_t lo, uint64_t hi) {
+    if (hi - lo <= 64) {
+        uint64_t acc = 0;
+        for (uint64_t x = lo; x < hi; ++x) acc += x;
+        return acc;
+    }
+    uint64_t mid = lo + (hi - lo) / 2, a = 0, b = 0;
+    fork_join([&]() { a = fork_join_sum(lo, mid); }, [&]() { b = fork_join_sum(mid, hi); });
+    return a + b;
+}
+
+static uint64_t range_sum(uint64_t lo, uint64_t hi) {
+    return hi <= lo ? 0 : (hi - lo) * (lo + hi - 1) / 2;
+}
+
+// Coste de lanzar tareas: tareas vacías en un TaskGroup, un std::thread por
+// tarea (lo que hacían antes los caminos paralelos), un árbol fork/join y un
+// parallel_for sobre nodes índices. Una fila por medida.
+static bool pool_benchmark(RowWriter& out, int trial, size_t tasks, size_t nodes) {
+    using clk = std::chrono::steady_clock;
+    auto secs = [](clk::time_point a) { return std::chrono::duration<double>(clk::now() - a).count(); };
+    ThreadPool& pool = ThreadPool::global();
+    bool all_ok = true;
+    auto row = [&](const char* bench, size_t count, double seconds, bool ok) {
+        all_ok = all_ok && ok;
+        out.write({{"trial", std::to_string(trial)}, {"benchmark", bench},
+                   {"threads", std::to_string(pool.concurrency())}, {"tasks", std::to_string(count)},
+                   {"seconds", fmt_num(seconds)}, {"ns_per_task", fmt_num(count ? seconds * 1e9 / count : 0.0)},
+                   {"ok", ok ? "1" : "0"}});
+        std::cout << "  " << bench << ": " << count << " tareas, " << (count ? seconds * 1e9 / count : 0.0)
+                  << " ns/tarea" << (ok ? "" : "  FALLO") << "\n";
+    };
+
+    std::atomic<size_t> done{0};
+    auto t0 = clk::now();
+    {
+        TaskGroup group(pool);
+        for (size_t i = 0; i < tasks; ++i) group.run([&done]() { done.fetch_add(1, std::memory_order_relaxed); });
+        group.wait();
+    }
+    row("pool_spawn", tasks, secs(t0), done.load() == tasks);
+
+    // Hilos del sistema: muchos menos, el coste por tarea es el mismo
+    const size_t thread_tasks = std::min<size_t>(tasks, 2000);
+    done = 0;
+    t0 = clk::now();
+    for (size_t i = 0; i < thread_tasks; ++i) {
+        std::thread th([&done]() { done.fetch_add(1, std::memory_order_relaxed); });
+        th.join();
+    }
+    row("thread_spawn", thread_tasks, secs(t0), done.load() == thread_tasks);
+
+    t0 = clk::now();
+    uint64_t sum = fork_join_sum(0, (uint64_t)tasks * 64);
+    row("fork_join", tasks, secs(t0), sum == range_sum(0, (uint64_t)tasks * 64));
+
+    std::vector<uint64_t> values(nodes);
+    t0 = clk::now();
+    parallel_for(0, nodes, 1024, [&values](size_t i) { values[i] = i; }, pool);
+    double pf_seconds = secs(t0);
+    uint64_t pf_sum = 0;
+    for (uint64_t v : values) pf_sum += v;
+    row("parallel_for", nodes, pf_seconds, pf_sum == range_sum(0, nodes));
+    return all_ok;
+}
+
+// Prueba de estrés del pool: rangos y granos aleatorios en fork/join y
+// parallel_for, grupos anidados y una excepción que debe llegar a wait()
+static bool pool_stress(std::mt19937& rng, int rounds) {
+    bool ok = true;
+    for (int r = 0; r < rounds && ok; ++r) {
+        uint64_t lo = rng() % 1000, hi = lo + rng() % 200000;
+        ok = ok && fork_join_sum(lo, hi) == range_sum(lo, hi);
+
+        size_t n = rng() % 100000, grain = 1 + rng() % 4096;
+        std::vector<std::atomic<int>> hits(n);
+        parallel_for(0, n, grain, [&hits](size_t i) { hits[i].fetch_add(1, std::memory_order_relaxed); });
+        for (size_t i = 0; i < n && ok; ++i) ok = hits[i].load() == 1;
+
+        // Grupos dentro de tareas de otro grupo
+        std::atomic<uint64_t> nested{0};
+        TaskGroup outer;
+        for (int g = 0; g < 16; ++g) {
+            outer.run([&nested, g]() {
+                TaskGroup inner;
+                for (int j = 0; j < 32; ++j) inner.run([&nested, g, j]() { nested += (uint64_t)(g * 32 + j); });
+                inner.wait();
+            });
+        }
+        outer.wait();
+        ok = ok && nested.load() == range_sum(0, 16 * 32);
+
+        bool caught = false;
+        TaskGroup failing;
+        for (int j = 0; j < 8; ++j) {
+            failing.run([j]() {
+                if (j == 5) throw std::runtime_error("pool stress");
+            });
+        }
+        try {
+            failing.wait();
+        } catch (const std::runtime_error&) {
+            caught = true;
+        }
+        ok = ok && caught;
+    }
+    return ok;
+}
+
+// Modo agents: agentes D* Lite sobre un mismo grafo que cambia en cada paso.
+// Por paso: replan_all() con los cambios acumulados frente a un A* desde cero
+// por agente sobre el grafo ya cambiado, costes comparados, y cada agente
+// avanza un nodo. Devuelve el número de costes que no coinciden.
+static size_t run_agents(RowWriter& out, Graph G, const HeuristicFunction& heuristic, int graph, unsigned seed,
+                         unsigned query_seed, int num_agents, int steps, int changes, double wmax) {
+    using clk = std::chrono::steady_clock;
+    auto secs = [](clk::time_point a) { return std::chrono::duration<double>(clk::now() - a).count(); };
+    const Weight INF = std::numeric_limits<Weight>::infinity();
+    std::vector<Node> nodes = sorted_nodes(G);
+    if (nodes.empty()) return 0;
+    std::mt19937 rng(query_seed + 7919u * (unsigned)graph);
+    auto pick = [&]() { return nodes[rng() % nodes.size()]; };
+    std::uniform_real_distribution<double> wdist(1.0, std::max(1.0, wmax));
+
+    const size_t graph_nodes = G.size();
+    MultiAgentPlanner planner(std::move(G), heuristic);
+    std::vector<Node> starts, goals;
+    for (int a = 0; a < num_agents; ++a) {
+        starts.push_back(pick());
+        goals.push_back(pick());
+        planner.add_agent(starts.back(), goals.back());
+    }
+
+    size_t total_mismatches = 0;
+    for (int step = 0; step <= steps; ++step) {
+        auto t0 = clk::now();
+        planner.replan_all();
+        double replan_seconds = secs(t0);
+
+        std::vector<Weight> scratch(num_agents);
+        t0 = clk::now();
+        for (int a = 0; a < num_agents; ++a) {
+            auto d = astar(planner.shared_graph(), starts[a], goals[a], heuristic);
+            auto it = d.find(goals[a]);
+            scratch[a] = it == d.end() ? INF : it->second;
+        }
+        double scratch_seconds = secs(t0);
+
+        size_t mismatches = 0, max_states = 0, reached = 0;
+        double sum_states = 0;
+        for (int a = 0; a < num_agents; ++a) {
+            if (!distances_match(scratch[a], planner.path(a).cost, 1e-9)) mismatches++;
+            size_t st = planner.agent_state_nodes(a);
+            sum_states += (double)st;
+            max_states = std::max(max_states, st);
+            if (starts[a] == goals[a]) reached++;
+        }
+        total_mismatches += mismatches;
+        out.write({{"graph", std::to_string(graph)}, {"seed", std::to_string(seed)}, {"step", std::to_string(step)},
+                   {"agents", std::to_string(num_agents)}, {"changes", std::to_string(step ? changes : 0)},
+                   {"time_replan", fmt_num(replan_seconds)}, {"time_scratch", fmt_num(scratch_seconds)},
+                   {"mismatches", std::to_string(mismatches)}, {"arrived", std::to_string(reached)},
+                   {"mean_state_nodes", fmt_num(num_agents ? sum_states / num_agents : 0.0)},
+                   {"max_state_nodes", std::to_string(max_states)}, {"graph_nodes", std::to_string(graph_nodes)}});
+        if (step == steps) break;
+
+        // Cada agente avanza un nodo por su camino; después cambian los
+        // costes de aristas sorteadas (una de cada diez queda bloqueada)
+        for (int a = 0; a < num_agents; ++a) {
+            const AgentPath& p = planner.path(a);
+            if (p.nodes.size() < 2) continue;
+            starts[a] = p.nodes[1];
+            planner.move_agent(a, starts[a]);
+        }
+        for (int c = 0; c < changes; ++c) {
+            Node u = pick();
+            auto it = planner.shared_graph().find(u);
+            if (it == planner.shared_graph().end() || it->second.empty()) continue;
+            Node v = it->second[rng() % it->second.size()].first;
+            planner.push_change({u, v, rng() % 10 == 0 ? INF : (Weight)wdist(rng)});
+        }
+    }
+    return total_mismatches;
+}
+
+// Modo anytime: calidad frente a tiempo. Por consulta, una fila por cada
+// solución que publican ARA* y Anytime D* (antes y después de un lote de
+// cambios de coste), más A* ponderado y A* como referencias. ratio es el
+// coste sobre el óptimo (Dijkstra); bound solo es cota con h consistente.
+static void run_anytime(RowWriter& out, const Graph& G, const HeuristicFunction& heuristic, int graph,
+                        unsigned seed, unsigned query_seed, int queries, const AnytimeOptions& aopt, int changes,
+                        double wmax) {
+    using clk = std::chrono::steady_clock;
+    auto secs = [](clk::time_point a) { return std::chrono::duration<double>(clk::now() - a).count(); };
+    const Weight INF = std::numeric_limits<Weight>::infinity();
+    std::vector<Node> nodes = sorted_nodes(G);
+    if (nodes.empty()) return;
+    std::mt19937 rng(query_seed + 7919u * (unsigned)graph);
+    auto pick = [&]() { return nodes[rng() % nodes.size()]; };
+    std::uniform_real_distribution<double> wdist(1.0, std::max(1.0, wmax));
+    auto optimum = [&](const Graph& g, Node s, Node t) {
+        auto d = astar(g, s, t, zero_heuristic);
+        auto it = d.find(t);
+        return it == d.end() ? INF : it->second;
+    };
+
+    // Anytime D* trabaja sobre una copia que cada consulta cambia y después
+    // restaura; solo cambian pesos, así que el índice de predecesores se
+    // construye una vez por grafo
+    Graph dyn = G;
+    Predecessors<Graph> preds(dyn);
+
+    std::vector<double> first_ratio, first_seconds, astar_seconds;
+    for (int q = 0; q < queries; ++q) {
+        Node s = pick(), t = pick();
+        Weight opt = optimum(G, s, t);
+        if (opt == INF) continue;
+        auto row = [&](const char* alg, const char* phase, int sol_index, const AnytimeSolution& sol, Weight best) {
+            out.write({{"graph", std::to_string(graph)}, {"seed", std::to_string(seed)}, {"query", std::to_string(q)},
+                       {"source", std::to_string(s)}, {"target", std::to_string(t)}, {"algorithm", alg},
+                       {"phase", phase}, {"solution", std::to_string(sol_index)}, {"epsilon", fmt_num(sol.epsilon)},
+                       {"bound", fmt_num(sol.bound)}, {"seconds", fmt_num(sol.seconds)},
+                       {"expansions", std::to_string(sol.expansions)}, {"cost", fmt_num(sol.cost)},
+                       {"optimal", fmt_num(best)}, {"ratio", fmt_num(best > 0 ? sol.cost / best : 1.0)}});
+        };
+
+        Instrument in;
+        auto t0 = clk::now();
+        auto d = astar(G, s, t, heuristic, &in);
+        AnytimeSolution ref;
+        ref.cost = d.count(t) ? d[t] : INF;
+        ref.epsilon = ref.bound = 1.0;
+        ref.seconds = secs(t0);
+        ref.expansions = in.settled;
+        row("astar", "initial", 0, ref, opt);
+        astar_seconds.push_back(ref.seconds);
+
+        AnytimeResult wa = weighted_astar(G, s, t, heuristic, aopt.epsilon_start, aopt.budget);
+        if (wa.solutions > 0) row("weighted_astar", "initial", 0, wa.best, opt);
+
+        int n = 0;
+        ara_star(G, s, t, heuristic, aopt, [&](const AnytimeSolution& sol) {
+            if (n == 0) {
+                first_ratio.push_back(sol.cost / opt);
+                first_seconds.push_back(sol.seconds);
+            }
+            row("ara_star", "initial", n++, sol, opt);
+        });
+
+        // Anytime D*: solución, lote de cambios de coste, reparación y mejora
+        AnytimeDStar ad(dyn, preds, s, t, heuristic, aopt);
+        n = 0;
+        ad.improve([&](const AnytimeSolution& sol) { row("anytime_dstar", "initial", n++, sol, opt); });
+        std::vector<Edge> batch;
+        std::vector<std::pair<Weight*, Weight>> undo;
+        for (int c = 0; c < changes; ++c) {
+            auto it = dyn.find(pick());
+            if (it == dyn.end() || it->second.empty()) continue;
+            auto& [v, w] = it->second[rng() % it->second.size()];
+            undo.push_back({&w, w});
+            w = rng() % 10 == 0 ? INF : (Weight)wdist(rng);
+            batch.push_back({it->first, v, w});
+        }
+        ad.update_graph(batch);
+        Weight opt2 = optimum(dyn, s, t);
+        n = 0;
+        ad.improve([&](const AnytimeSolution& sol) { row("anytime_dstar", "replan", n++, sol, opt2); });
+        for (auto it = undo.rbegin(); it != undo.rend(); ++it) *it->first = it->second;
+    }
+    if (!first_ratio.empty()) {
+        std::cout << "Grafo " << graph << ": ARA* primera solución en " << mean_of(first_seconds) << " s (ratio medio "
+                  << mean_of(first_ratio) << "), A* " << mean_of(astar_seconds) << " s\n";
+    }
+}
+
+// Modo deadline: coste del token de cancelación sin plazo (objetivo < 1 %)
+// y comportamiento con plazo. Por consulta y algoritmo: tiempo sin token,
+// con token sin plazo y con plazo de deadline_ms, estado final y cuánto se
+// pasó del plazo. El orden sin token / con token alterna entre consultas.
+// Los algoritmos trabajan en memory (--alloc), vaciada fuera de la medida
+// como en el servicio; con --alloc default liberar el estado (proporcional a
+// los nodos tocados) cuenta dentro del exceso.
+//
+// Antes, la prueba de la primera consulta: planificadores de D*-lite nuevos
+// hacia el vecino más cercano de source deben dar camino dentro del plazo
+// (nada del trabajo por grafo cae en la consulta). false si alguno no lo da.
+static bool run_deadline(RowWriter& out, const Graph& G, const HeuristicFunction& heuristic, int graph,
+                         unsigned seed, unsigned query_seed, int queries, const BmsspParams& bm,
+                         double deadline_ms, QueryMemory& memory) {
+    using clk = std::chrono::steady_clock;
+    const Weight INF = std::numeric_limits<Weight>::infinity();
+    std::vector<Node> nodes = sorted_nodes(G);
+    if (nodes.empty()) return true;
+    std::mt19937 rng(query_seed + 7919u * (unsigned)graph);
+    auto pick = [&]() { return nodes[rng() % nodes.size()]; };
+    // El índice de predecesores de D*-lite es del grafo: se prepara una vez, sin plazo
+    Predecessors<Graph> preds(G);
+
+    const int FIRST_QUERIES = 5;
+    int first_ok = 0, first_tried = 0;
+    double first_worst_ms = 0.0;
+    for (int q = 0; q < FIRST_QUERIES; ++q) {
+        // Destino: la arista de salida más barata
+        Node s = pick(), t = s;
+        Weight w_min = INF;
+        auto adj = G.find(s);
+        if (adj != G.end()) {
+            for (const auto& [v, w] : adj->second) {
+                if (v != s && w < w_min) {
+                    w_min = w;
+                    t = v;
+                }
+            }
+        }
+        if (t == s) continue;
+        first_tried++;
+        memory.reset();
+        CancelToken token(deadline_ms / 1000.0);
+        auto t0 = clk::now();
+        auto result = dstar_lite(G, preds, s, t, heuristic, nullptr, memory.resource(), &token);
+        double ms = std::chrono::duration<double>(clk::now() - t0).count() * 1000.0;
+        auto it = result.find(s);
+        if (token.status() == SearchStatus::COMPLETE && it != result.end() && it->second < INF && ms <= deadline_ms) {
+            first_ok++;
+        }
+        first_worst_ms = std::max(first_worst_ms, ms);
+    }
+    std::cout << "Grafo " << graph << ", dstar_lite primera consulta al vecino más cercano con plazo " << deadline_ms
+              << " ms: " << first_ok << " de " << first_tried << " con camino, máximo " << first_worst_ms << " ms\n";
+
+    // timeout < 0: sin token; 0: token sin plazo; > 0: plazo en segundos.
+    // El token se crea tras preparar dist de BMSSP: el plazo es de la búsqueda.
+    auto run = [&](int alg, Node s, Node t, double timeout, SearchStatus& status) {
+        std::unordered_map<Node, Weight> dist_bm;
+        if (alg == 1) {
+            dist_bm.reserve(G.size());
+            for (const auto& [u, _] : G) dist_bm[u] = INF;
+            dist_bm[s] = 0.0;
+        }
+        std::unordered_map<Node, Weight> result;  // se libera fuera de la medida
+        memory.reset();
+        std::pmr::memory_resource* mem = memory.resource();
+        CancelToken token(timeout);
+        CancelToken* tok = timeout < 0 ? nullptr : &token;
+        auto t0 = clk::now();
+        switch (alg) {
+            case 0: result = dijkstra(G, s, nullptr, mem, tok); break;
+            case 1: bmssp_complete(G, dist_bm, bm, INF, {s}, (int)G.size(), nullptr, mem, tok); break;
+            case 2: result = astar(G, s, t, heuristic, nullptr, mem, tok); break;
+            default: result = dstar_lite(G, preds, s, t, heuristic, nullptr, mem, tok); break;
+        }
+        double seconds = std::chrono::duration<double>(clk::now() - t0).count();
+        status = token.status();
+        return seconds;
+    };
+
+    double plain_sum[4] = {}, token_sum[4] = {}, worst_overshoot[4] = {};
+    int stopped[4] = {};
+    for (int q = 0; q < queries; ++q) {
+        Node s = pick(), t = pick();
+        for (int a = 0; a < 4; ++a) {
+            SearchStatus st;
+            double plain, with_token;
+            if (q % 2 == 0) {
+                plain = run(a, s, t, -1.0, st);
+                with_token = run(a, s, t, 0.0, st);
+            } else {
+                with_token = run(a, s, t, 0.0, st);
+                plain = run(a, s, t, -1.0, st);
+            }
+            double limited = run(a, s, t, deadline_ms / 1000.0, st);
+            double overshoot_ms = st == SearchStatus::COMPLETE ? 0.0 : limited * 1000.0 - deadline_ms;
+            plain_sum[a] += plain;
+            token_sum[a] += with_token;
+            if (st != SearchStatus::COMPLETE) stopped[a]++;
+            worst_overshoot[a] = std::max(worst_overshoot[a], overshoot_ms);
+            out.write({{"graph", std::to_string(graph)}, {"seed", std::to_string(seed)}, {"query", std::to_string(q)},
+                       {"source", std::to_string(s)}, {"target", std::to_string(t)}, {"algorithm", ALGORITHMS[a]},
+                       {"seconds_plain", fmt_num(plain)}, {"seconds_token", fmt_num(with_token)},
+                       {"deadline_ms", fmt_num(deadline_ms)}, {"seconds_deadline", fmt_num(limited)},
+                       {"status", search_status_name(st)}, {"overshoot_ms", fmt_num(overshoot_ms)},
+                       {"alloc", alloc_mode_name(memory.alloc_mode())}});
+        }
+    }
+    for (int a = 0; a < 4; ++a) {
+        double overhead = plain_sum[a] > 0 ? (token_sum[a] / plain_sum[a] - 1.0) * 100.0 : 0.0;
+        std::cout << "Grafo " << graph << ", " << ALGORITHMS[a] << ": token sin plazo " << overhead
+                  << " % sobre " << plain_sum[a] << " s; plazo " << deadline_ms << " ms: " << stopped[a] << " de "
+                  << queries << " interrumpidas, exceso máximo " << worst_overshoot[a] << " ms\n";
+    }
+    return first_ok == first_tried;
 }
 
 static GraphType parse_graph_type(const std::string& s) {
@@ -89,6 +1106,80 @@ int main(int argc, char* argv[]) {
     std::string out_path = "benchmark_times.csv";
     std::string gtype_str = "random-m";
 
+    // modo sweep: un grafo por trial y muchas consultas (fuente, destino) sobre él
+    std::string mode = "trials";
+    int queries = 100;
+    int warmup = 3;
+    unsigned query_seed = 12345;
+
+    // modo weights: double / float / punto fijo sobre el mismo grafo CSR
+    double fixed_scale = 1000.0;  // unidades de punto fijo por unidad de peso
+
+    // modo stats: arnés con repetición adaptativa y percentiles
+    HarnessOptions hopt;
+    std::string json_path;
+    bool use_perf = false;  // contadores hardware (perf_event_open, solo Linux)
+    // memoria de trabajo de los algoritmos: default, pool, arena o all (solo stats)
+    std::string alloc_str = "default";
+
+    // traza de la recursión de BMSSP: JSON de Chrome y resumen por nivel
+    std::string trace_path, trace_levels_path;
+    size_t trace_capacity = 1u << 16;
+
+    // parámetros de BMSSP: explícitos (--bm-*), de la base de ajuste o por defecto
+    BmsspParams bm_cli;
+    std::string tune_db;
+    TuneOptions topt;
+
+    // modos validate / stress: distancias contra Dijkstra
+    ValidationOptions vopt;
+
+    // grafo real (DIMACS .gr/.co o lista de aristas) en lugar de generado
+    std::string input_path, coords_path, format_str = "auto";
+    int threads = 0;  // lectura y generación en paralelo
+    double hscale = -1.0;  // < 0: escala admisible calculada sobre el grafo
+
+    // BMSSP también sobre el grafo transformado a grado <= degree_max
+    bool degree_reduce = false;
+    int degree_max = 2;
+
+    // grid2d: además, Dijkstra/A*/D*-lite sobre la malla implícita (planes
+    // reproduce los pesos del generador; cell sortea un coste por celda;
+    // uniform es un mapa de ocupación de coste 1 que con --diag añade JPS y JPS+)
+    bool implicit_grid = false;
+    std::string grid_cost_str = "planes";
+    double obstacles = 0.2;  // uniform: probabilidad de celda bloqueada
+    int hpa_cluster = 0;     // > 0: además HPA* con clusters de este lado
+
+    // modo serve: servicio de consultas concurrentes alimentado por un
+    // registro (o consultas sorteadas) a uno o varios ritmos (0 = sin límite)
+    std::string query_log_path;
+    std::string rates_str = "0";
+    int service_threads = 0;
+    std::string serve_alg_str = "astar";  // algoritmo de las consultas sorteadas, o mix
+    size_t queue_capacity = 1024;
+
+    // pool de trabajo común (generación, lectura y modo pool): paralelismo
+    // total y afinidad de sus hilos; modo pool: tareas por medida
+    int pool_threads = 0;
+    bool pool_pin = false;
+    size_t pool_tasks = 100000;
+
+    // modo agents: agentes D* Lite sobre un grafo compartido, pasos
+    // simulados y cambios de coste por paso
+    int num_agents = 16;
+    int agent_steps = 50;
+    int agent_changes = 100;
+
+    // modo anytime: epsilon inicial y paso de ARA*/AD* (también el peso de
+    // A* ponderado) y presupuesto por búsqueda; --changes cambia aristas
+    // antes de replanificar con AD*
+    AnytimeOptions aopt;
+    double budget_ms = 0.0;
+
+    // modo deadline: plazo por búsqueda de las consultas con token
+    double deadline_ms = 10.0;
+
     // specific
     double p = 0.0005;
     int attach = 2;
@@ -109,6 +1200,63 @@ int main(int argc, char* argv[]) {
         else if ((a=="--target") && need(1)) target = static_cast<Node>(std::atoi(argv[++i]));
         else if ((a=="--wmax") && need(1)) wmax = std::atof(argv[++i]);
         else if ((a=="--graph") && need(1)) gtype_str = argv[++i];
+        else if ((a=="--mode") && need(1)) mode = argv[++i];
+        else if ((a=="--queries") && need(1)) queries = std::atoi(argv[++i]);
+        else if ((a=="--warmup") && need(1)) warmup = std::atoi(argv[++i]);
+        else if ((a=="--query-seed") && need(1)) query_seed = (unsigned)std::atoi(argv[++i]);
+        else if ((a=="--min-reps") && need(1)) hopt.min_reps = std::atoi(argv[++i]);
+        else if ((a=="--max-reps") && need(1)) hopt.max_reps = std::atoi(argv[++i]);
+        else if ((a=="--max-time") && need(1)) hopt.max_seconds = std::atof(argv[++i]);
+        else if ((a=="--ci") && need(1)) hopt.ci_target = std::atof(argv[++i]);
+        else if ((a=="--pin") && need(1)) hopt.pin_cpu = std::atoi(argv[++i]);
+        else if (a=="--cold") hopt.flush_cache = true;
+        else if ((a=="--json") && need(1)) json_path = argv[++i];
+        else if (a=="--perf") use_perf = true;
+        else if ((a=="--alloc") && need(1)) alloc_str = argv[++i];
+        else if ((a=="--fixed-scale") && need(1)) fixed_scale = std::atof(argv[++i]);
+        else if ((a=="--trace") && need(1)) trace_path = argv[++i];
+        else if ((a=="--trace-levels") && need(1)) trace_levels_path = argv[++i];
+        else if ((a=="--trace-capacity") && need(1)) trace_capacity = (size_t)std::atoll(argv[++i]);
+        else if ((a=="--bm-levels") && need(1)) bm_cli.levels = std::atoi(argv[++i]);
+        else if ((a=="--bm-t") && need(1)) bm_cli.t = std::atoi(argv[++i]);
+        else if ((a=="--bm-k") && need(1)) bm_cli.k = std::atoi(argv[++i]);
+        else if ((a=="--bm-plimit") && need(1)) bm_cli.p_limit = std::atoi(argv[++i]);
+        else if ((a=="--bm-block") && need(1)) bm_cli.block_size = std::atoi(argv[++i]);
+        else if (a=="--bm-parallel") bm_cli.parallel = vopt.bmssp_parallel = true;
+        else if ((a=="--tune-db") && need(1)) tune_db = argv[++i];
+        else if ((a=="--tune-samples") && need(1)) topt.samples = std::atoi(argv[++i]);
+        else if ((a=="--tune-method") && need(1)) {
+            std::string m_str = argv[++i];
+            topt.method = (m_str == "grid") ? TuneMethod::GRID : TuneMethod::SUCCESSIVE_HALVING;
+        }
+        else if ((a=="--tol") && need(1)) vopt.tolerance = std::atof(argv[++i]);
+        else if ((a=="--input") && need(1)) input_path = argv[++i];
+        else if ((a=="--coords") && need(1)) coords_path = argv[++i];
+        else if ((a=="--format") && need(1)) format_str = argv[++i];
+        else if ((a=="--threads") && need(1)) threads = std::atoi(argv[++i]);
+        else if ((a=="--hscale") && need(1)) hscale = std::atof(argv[++i]);
+        else if (a=="--degree-reduce") degree_reduce = true;
+        else if ((a=="--degree-max") && need(1)) degree_max = std::atoi(argv[++i]);
+        else if (a=="--implicit") implicit_grid = true;
+        else if ((a=="--grid-cost") && need(1)) grid_cost_str = argv[++i];
+        else if ((a=="--obstacles") && need(1)) obstacles = std::atof(argv[++i]);
+        else if ((a=="--hpa") && need(1)) hpa_cluster = std::atoi(argv[++i]);
+        else if ((a=="--query-log") && need(1)) query_log_path = argv[++i];
+        else if ((a=="--rate") && need(1)) rates_str = argv[++i];
+        else if ((a=="--service-threads") && need(1)) service_threads = std::atoi(argv[++i]);
+        else if ((a=="--serve-algorithm") && need(1)) serve_alg_str = argv[++i];
+        else if ((a=="--queue-capacity") && need(1)) queue_capacity = (size_t)std::atoll(argv[++i]);
+        else if ((a=="--pool-threads") && need(1)) pool_threads = std::atoi(argv[++i]);
+        else if (a=="--pool-pin") pool_pin = true;
+        else if ((a=="--pool-tasks") && need(1)) pool_tasks = (size_t)std::atoll(argv[++i]);
+        else if ((a=="--agents") && need(1)) num_agents = std::atoi(argv[++i]);
+        else if ((a=="--agent-steps") && need(1)) agent_steps = std::atoi(argv[++i]);
+        else if ((a=="--changes") && need(1)) agent_changes = std::atoi(argv[++i]);
+        else if ((a=="--epsilon") && need(1)) aopt.epsilon_start = std::atof(argv[++i]);
+        else if ((a=="--epsilon-step") && need(1)) aopt.epsilon_step = std::atof(argv[++i]);
+        else if ((a=="--budget-ms") && need(1)) budget_ms = std::atof(argv[++i]);
+        else if ((a=="--deadline-ms") && need(1)) deadline_ms = std::atof(argv[++i]);
+        else if ((a=="--budget-expansions") && need(1)) aopt.budget.expansions = (size_t)std::atoll(argv[++i]);
         // específicos
         else if ((a=="--p") && need(1)) p = std::atof(argv[++i]);
         else if ((a=="--attach") && need(1)) attach = std::atoi(argv[++i]);
@@ -123,18 +1271,257 @@ int main(int argc, char* argv[]) {
     }
 
     GraphType gtype = parse_graph_type(gtype_str);
+    if (degree_reduce && degree_max < 2) {
+        std::cerr << "Error: --degree-max must be >= 2\n";
+        return 1;
+    }
+    const int reduce_max = degree_reduce ? degree_max : 0;  // 0 = sin reducción
+    if (implicit_grid && (gtype != GraphType::GRID2D || !input_path.empty())) {
+        std::cerr << "Error: --implicit needs a generated --graph grid2d\n";
+        return 1;
+    }
+    if (hpa_cluster != 0 && (!implicit_grid || hpa_cluster < 2)) {
+        std::cerr << "Error: --hpa needs --implicit and a cluster size >= 2\n";
+        return 1;
+    }
+    if (grid_cost_str != "planes" && grid_cost_str != "cell" && grid_cost_str != "uniform") {
+        std::cerr << "Error: unknown --grid-cost: " << grid_cost_str << " (planes, cell, uniform)\n";
+        return 1;
+    }
+    const bool occupancy = grid_cost_str == "uniform";
+    const GridCostModel grid_cost = grid_cost_str == "planes" ? GridCostModel::PLANES : GridCostModel::CELL;
+    if (pool_threads > 0 || pool_pin) {
+        PoolOptions pool_opt;
+        pool_opt.threads = pool_threads;
+        pool_opt.pin = pool_pin;
+        ThreadPool::configure_global(pool_opt);
+    }
+
+    // Con --input el grafo se carga una sola vez y se reutiliza en todos los trials
+    Graph G_input;
+    Coordinates coords;
+    HeuristicFunction heuristic = euclidean_heuristic;
+    if (!input_path.empty()) {
+        ParseOptions popt;
+        popt.threads = threads;
+        if (format_str == "gr" || format_str == "dimacs") popt.format = InputFormat::DIMACS_GR;
+        else if (format_str == "edges" || format_str == "csv") popt.format = InputFormat::EDGE_LIST;
+
+        ParseStats pst;
+        try {
+            G_input = load_graph(input_path, popt, &pst);
+        } catch (const std::exception& ex) {
+            std::cerr << "Error: " << ex.what() << "\n";
+            return 1;
+        }
+        std::cout << "Grafo cargado: " << pst.nodes << " nodos, " << pst.edges << " aristas, "
+                  << pst.bytes / (1024.0 * 1024.0) << " MB en " << pst.seconds << " s ("
+                  << pst.mb_per_s() << " MB/s)\n";
+
+        if (!coords_path.empty()) {
+            ParseStats cst;
+            try {
+                coords = load_coordinates(coords_path, popt, &cst);
+            } catch (const std::exception& ex) {
+                std::cerr << "Error: " << ex.what() << "\n";
+                return 1;
+            }
+            if (hscale < 0.0) hscale = admissible_heuristic_scale(G_input, coords);
+            heuristic = coordinate_heuristic(coords, hscale);
+            std::cout << "Coordenadas cargadas: " << cst.nodes << " nodos en " << cst.seconds << " s ("
+                      << cst.mb_per_s() << " MB/s), escala heurística " << hscale << "\n";
+        }
+    }
+    const std::vector<Edge> no_edges;  // bmssp() no usa la lista de aristas
 
     std::ofstream fout(out_path);
     if (!fout) {
         std::cerr << "Error: cannot open output file: " << out_path << "\n";
         return 1;
     }
-    fout << "trial,seed,time_dijkstra,time_bmssp,time_astar,time_dstar_lite\n";
+    std::ofstream vout;
+    if (mode == "validate" || mode == "stress") {
+        vout.open(out_path);
+        if (!vout) {
+            std::cerr << "Error: cannot open output file: " << out_path << "\n";
+            return 1;
+        }
+        vout << "graph_type,graph,seed,source,target,algorithm,checked,mismatches,first_mismatches\n";
+        ValidationTotals totals;
+
+        if (mode == "stress") {
+            // Todos los tipos de grafo con parámetros aleatorios; sin coordenadas
+            // reales se usa la heurística cero para no mezclar errores de heurística
+            const GraphType all_types[] = {GraphType::RANDOM_M, GraphType::ER, GraphType::BA,
+                                           GraphType::WS, GraphType::GRID2D, GraphType::LAYERED_DAG};
+            std::mt19937 srng(seed0);
+            for (int i = 0; i < trials; ++i) {
+                for (GraphType t : all_types) {
+                    GraphGenOptions sopt = random_stress_options(t, srng, wmax);
+                    Graph G = generate_graph(t, sopt).first;
+                    validate_graph(vout, graph_type_name(t), i, sopt.seed, G, zero_heuristic,
+                                   queries, query_seed, vopt, totals, reduce_max);
+                }
+                // Malla implícita 8-conectada de coste uniforme (JPS/JPS+ aplicables)
+                int g_rows = 2 + (int)(srng() % 59), g_cols = 2 + (int)(srng() % 59);
+                double g_obstacles = (srng() % 41) / 100.0;
+                unsigned g_seed = srng();
+                GridGraph grid = generate_occupancy_grid(g_rows, g_cols, true, g_obstacles, g_seed);
+                JumpTable table = build_jump_table(grid);
+                HpaGrid hpa(grid, 2 + (int)(srng() % 7));
+                validate_grid(vout, i, g_seed, grid, &table, &hpa, queries, query_seed, vopt, totals);
+            }
+        } else {
+            if (!input_path.empty()) trials = 1;
+            // euclidean_heuristic (sobre ids) no es admisible: A* daría errores
+            // que no son suyos. Solo las coordenadas cargadas tienen escala admisible.
+            HeuristicFunction h_validate = coords.empty() ? HeuristicFunction(zero_heuristic) : heuristic;
+            for (int i = 0; i < trials; ++i) {
+                GraphGenOptions opt;
+                opt.wmax = wmax; opt.seed = seed0 + (unsigned)i; opt.threads = threads;
+                opt.n = n; opt.m = m; opt.p = p; opt.attach = attach; opt.k = k; opt.beta = beta;
+                opt.rows = rows; opt.cols = cols; opt.diag = diag;
+                opt.layers = layers; opt.width = width; opt.dagp = dagp;
+                std::pair<Graph, std::vector<Edge>> generated;
+                GridGraph grid;
+                if (implicit_grid) {
+                    // Como en el benchmark: G sale de la malla, que se valida aparte
+                    grid = occupancy ? generate_occupancy_grid(rows, cols, diag, obstacles, opt.seed, threads)
+                                     : generate_grid_implicit(rows, cols, diag, grid_cost, wmax, opt.seed, threads);
+                    generated.first = grid_to_graph(grid);
+                } else if (input_path.empty()) {
+                    generated = generate_graph(gtype, opt);
+                }
+                const Graph& G = input_path.empty() ? generated.first : G_input;
+                std::string gname = input_path.empty() ? graph_type_name(gtype) : "input";
+                validate_graph(vout, gname, i, opt.seed, G, h_validate, queries, query_seed, vopt, totals,
+                               reduce_max);
+                if (implicit_grid) {
+                    const bool uniform = is_uniform_grid(grid);
+                    JumpTable table;
+                    if (uniform) table = build_jump_table(grid);
+                    std::unique_ptr<HpaGrid> hpa;
+                    if (hpa_cluster > 0) hpa = std::make_unique<HpaGrid>(grid, hpa_cluster);
+                    validate_grid(vout, i, opt.seed, grid, uniform ? &table : nullptr, hpa.get(), queries,
+                                  query_seed, vopt, totals);
+                }
+            }
+        }
+
+        std::cout << "Validación contra Dijkstra (tolerancia " << vopt.tolerance << "):\n";
+        for (const auto& [alg, tot] : totals.per_algorithm) {
+            std::cout << "  " << alg << ": " << tot.second << " de " << tot.first << " consultas con errores\n";
+        }
+        std::cout << "CSV listo => " << out_path << "\n";
+        return totals.failed_queries == 0 ? 0 : 2;
+    }
+
+    if (mode == "pool") {
+        // Coste de lanzar tareas y prueba de estrés; sin grafos
+        RowWriter pool_out(fout, nullptr);
+        std::mt19937 prng(seed0);
+        bool ok = true;
+        for (int i = 0; i < trials; ++i) {
+            std::cout << "Pool (" << ThreadPool::global().concurrency() << " hilos), trial " << i << ":\n";
+            ok = pool_benchmark(pool_out, i, pool_tasks, (size_t)std::max(n, 1)) && ok;
+            auto st0 = std::chrono::steady_clock::now();
+            bool stress_ok = pool_stress(prng, queries);
+            double stress_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - st0).count();
+            pool_out.write({{"trial", std::to_string(i)}, {"benchmark", "stress"},
+                            {"threads", std::to_string(ThreadPool::global().concurrency())},
+                            {"tasks", std::to_string(queries)}, {"seconds", fmt_num(stress_seconds)},
+                            {"ns_per_task", "0"},
+                            {"ok", stress_ok ? "1" : "0"}});
+            std::cout << "  stress: " << queries << " rondas " << (stress_ok ? "ok" : "FALLO") << "\n";
+            ok = ok && stress_ok;
+        }
+        std::cout << "CSV listo => " << out_path << "\n";
+        return ok ? 0 : 2;
+    }
+
+    const bool sweep = (mode == "sweep");
+    const bool stats = (mode == "stats");
+    const bool tune = (mode == "tune");
+    const bool weights = (mode == "weights");
+    const bool serve = (mode == "serve");
+    const bool agents = (mode == "agents");
+    const bool anytime = (mode == "anytime");
+    const bool deadline = (mode == "deadline");
+    aopt.budget.seconds = budget_ms / 1000.0;
+    std::vector<double> rates;
+    std::vector<QueryRequest> query_log;
+    if (serve) {
+        try {
+            rates = parse_number_list(rates_str);
+            if (serve_alg_str != "mix") parse_query_algorithm(serve_alg_str);
+            if (!query_log_path.empty()) query_log = load_query_log(query_log_path);
+        } catch (const std::exception& ex) {
+            std::cerr << "Error: " << ex.what() << "\n";
+            return 1;
+        }
+    }
+    if (weights && !input_path.empty()) {
+        std::cerr << "Error: --mode weights needs a generated graph (CSR), not --input\n";
+        return 1;
+    }
+    hopt.warmup = warmup;
+    std::vector<BenchRecord> records;
+
+    std::vector<AllocMode> alloc_modes;
+    try {
+        if (alloc_str == "all") {
+            if (!stats) throw std::runtime_error("--alloc all is only supported in --mode stats");
+            alloc_modes = {AllocMode::DEFAULT, AllocMode::POOL, AllocMode::ARENA};
+        } else {
+            alloc_modes = {parse_alloc_mode(alloc_str)};
+        }
+    } catch (const std::exception& ex) {
+        std::cerr << "Error: " << ex.what() << "\n";
+        return 1;
+    }
+    if (tune && tune_db.empty()) tune_db = "bmssp_tuned.txt";
+    if (stats || sweep || tune || weights || serve || agents || anytime || deadline) {
+        // Con --input solo hay un grafo
+        if (!input_path.empty()) trials = 1;
+    }
+
+    // trials y sweep: CSV (y JSON con --json) con contadores por algoritmo
+    std::ofstream jout;
+    if (!stats && !json_path.empty()) {
+        jout.open(json_path);
+        if (!jout) {
+            std::cerr << "Error: cannot open output file: " << json_path << "\n";
+            return 1;
+        }
+    }
+    RowWriter rows_out(fout, jout.is_open() ? &jout : nullptr);
+
+    PerfCounters perf_counters;
+    PerfCounters* perf = nullptr;
+    if (use_perf) {
+        if (perf_counters.available()) perf = &perf_counters;
+        else std::cerr << "Aviso: contadores hardware no disponibles (perf_event_open)\n";
+    }
+
+    const bool tracing = !trace_path.empty() || !trace_levels_path.empty();
+    BmsspTrace bmssp_trace(trace_capacity);
+    BmsspTrace* trace = tracing ? &bmssp_trace : nullptr;
+    QueryMemory query_memory(alloc_modes.front());
+    RunConfig cfg;
+    bool first_query_ok = true;  // deadline: D*-lite respondió dentro del plazo en todas las primeras consultas
+    cfg.perf = perf;
+    cfg.trace = trace;
+    cfg.memory = &query_memory;
+    DegreeReduction reduction;
+    GridGraph grid;
+    JumpTable jump_table;
+    std::unique_ptr<HpaGrid> hpa;
 
     for (int i=0; i<trials; ++i) {
         GraphGenOptions opt;
         opt.wmax = wmax;
         opt.seed = seed0 + (unsigned)i;
+        opt.threads = threads;
         switch (gtype) {
             case GraphType::RANDOM_M:  opt.n = n; opt.m = m; break;
             case GraphType::ER:        opt.n = n; opt.p = p; break;
@@ -144,15 +1531,279 @@ int main(int argc, char* argv[]) {
             case GraphType::LAYERED_DAG: opt.layers = layers; opt.width = width; opt.dagp = dagp; break;
         }
 
-        auto [G, E] = generate_graph(gtype, opt);
+        if (weights) {
+            CsrGraph csr = generate_graph_csr(gtype, opt);
+            std::cout << "Grafo " << i << ": " << csr.num_nodes() << " nodos, " << csr.num_edges() << " aristas\n";
+            compare_weight_types(rows_out, csr, i, opt.seed, queries, query_seed, warmup, fixed_scale);
+            continue;
+        }
+
+        if (!input_path.empty()) opt.seed = seed0;
+        std::pair<Graph, std::vector<Edge>> generated;
+        cfg.grid = nullptr;
+        if (implicit_grid && !tune) {
+            // G se obtiene de la malla: los dos lados ven los mismos pesos
+            grid = occupancy ? generate_occupancy_grid(rows, cols, diag, obstacles, opt.seed, threads)
+                             : generate_grid_implicit(rows, cols, diag, grid_cost, wmax, opt.seed, threads);
+            generated.first = grid_to_graph(grid);
+            cfg.grid = &grid;
+            cfg.jump_table = nullptr;
+            if (is_uniform_grid(grid)) {
+                jump_table = build_jump_table(grid);
+                cfg.jump_table = &jump_table;
+                std::cout << "Tabla JPS+: " << jump_table.memory_bytes() / (1024.0 * 1024.0) << " MB en "
+                          << jump_table.seconds << " s\n";
+            }
+            cfg.hpa = nullptr;
+            if (hpa_cluster > 0) {
+                hpa = std::make_unique<HpaGrid>(grid, hpa_cluster);
+                cfg.hpa = hpa.get();
+                std::cout << "HPA*: " << hpa->num_clusters() << " clusters, " << hpa->abstract_nodes()
+                          << " nodos abstractos, " << hpa->memory_bytes() / (1024.0 * 1024.0) << " MB en "
+                          << hpa->build_seconds << " s\n";
+            }
+            heuristic = [&grid](Node a, Node b) { return grid.heuristic(a, b); };
+        } else if (input_path.empty()) {
+            generated = generate_graph(gtype, opt);
+        }
+        const Graph& G = input_path.empty() ? generated.first : G_input;
+        const std::vector<Edge>& E = input_path.empty() ? generated.second : no_edges;
+
+        if (tune) {
+            TuneResult tr = tune_bmssp(G, E, default_search_space((int)G.size()), topt);
+            save_tuned_params(tune_db, tr.fingerprint, tr.best.params);
+            double speedup = tr.best.mean_seconds() > 0.0 ? tr.baseline.mean_seconds() / tr.best.mean_seconds() : 0.0;
+            std::cout << "Grafo " << i << " (" << tr.fingerprint << "): " << tr.candidates << " configuraciones, "
+                      << tr.runs << " ejecuciones\n"
+                      << "  por defecto: " << params_to_string(tr.baseline.params) << "  "
+                      << tr.baseline.mean_seconds() << " s, " << tr.baseline.mismatches << " errores\n"
+                      << "  mejor:       " << params_to_string(tr.best.params) << "  "
+                      << tr.best.mean_seconds() << " s, " << tr.best.mismatches << " errores (x" << speedup << ")\n";
+            const BmsspParams& bp = tr.best.params;
+            const BmsspParams& dp = tr.baseline.params;
+            Row row = {{"graph", std::to_string(i)}, {"seed", std::to_string(opt.seed)},
+                       {"fingerprint", tr.fingerprint}, {"levels", std::to_string(bp.levels)},
+                       {"t", std::to_string(bp.t)}, {"k", std::to_string(bp.k)},
+                       {"p_limit", std::to_string(bp.p_limit)}, {"block_size", std::to_string(bp.block_size)},
+                       {"mean_s", fmt_num(tr.best.mean_seconds())}, {"mismatches", std::to_string(tr.best.mismatches)},
+                       {"default_levels", std::to_string(dp.levels)}, {"default_t", std::to_string(dp.t)},
+                       {"default_k", std::to_string(dp.k)}, {"default_p_limit", std::to_string(dp.p_limit)},
+                       {"default_mean_s", fmt_num(tr.baseline.mean_seconds())},
+                       {"default_mismatches", std::to_string(tr.baseline.mismatches)},
+                       {"speedup", fmt_num(speedup)}, {"candidates", std::to_string(tr.candidates)},
+                       {"runs", std::to_string(tr.runs)}};
+            rows_out.write(row);
+            continue;
+        }
+
+        // Parámetros de BMSSP para este grafo: base de ajuste y encima --bm-*
+        cfg.bmssp = BmsspParams();
+        if (!tune_db.empty()) {
+            std::string fp = graph_fingerprint(G);
+            if (load_tuned_params(tune_db, fp, cfg.bmssp)) {
+                std::cout << "BMSSP ajustado (" << fp << "): " << params_to_string(cfg.bmssp) << "\n";
+            }
+        }
+        if (bm_cli.levels > 0) cfg.bmssp.levels = bm_cli.levels;
+        if (bm_cli.t > 0) cfg.bmssp.t = bm_cli.t;
+        if (bm_cli.k > 0) cfg.bmssp.k = bm_cli.k;
+        if (bm_cli.p_limit > 0) cfg.bmssp.p_limit = bm_cli.p_limit;
+        if (bm_cli.block_size > 0) cfg.bmssp.block_size = bm_cli.block_size;
+        cfg.bmssp.parallel = bm_cli.parallel;
+
+        cfg.reduced = nullptr;
+        cfg.preds = nullptr;
+        if (degree_reduce) {
+            reduction = reduce_degree(G, degree_max);
+            cfg.reduced = &reduction;
+            std::cout << "Reducción de grado (<= " << degree_max << "): " << reduction.original_nodes << " -> "
+                      << reduction.nodes() << " nodos, " << reduction.original_edges << " -> " << reduction.edges
+                      << " aristas, " << reduction.reduced_vertices << " vértices sustituidos, "
+                      << reduction.seconds << " s\n";
+        }
+
+        if (serve) {
+            // Consultas del registro o sorteadas como en sweep; el grafo pasa al servicio
+            std::vector<QueryRequest> requests = query_log;
+            if (requests.empty()) {
+                std::vector<Node> nodes = sorted_nodes(G);
+                if (nodes.empty()) continue;
+                std::mt19937 qrng(query_seed + 7919u * (unsigned)i);
+                const QueryAlgorithm all[] = {QueryAlgorithm::DIJKSTRA, QueryAlgorithm::BMSSP,
+                                              QueryAlgorithm::ASTAR, QueryAlgorithm::DSTAR_LITE};
+                for (int q = 0; q < queries; ++q) {
+                    QueryAlgorithm alg = serve_alg_str == "mix" ? all[q % 4] : parse_query_algorithm(serve_alg_str);
+                    Node s_q = nodes[qrng() % nodes.size()];
+                    Node t_q = nodes[qrng() % nodes.size()];
+                    requests.push_back({alg, s_q, t_q});
+                }
+            }
+            ServiceOptions sopt;
+            sopt.threads = service_threads;
+            sopt.queue_capacity = queue_capacity;
+            sopt.alloc = alloc_modes.front();
+            sopt.bmssp = cfg.bmssp;
+            std::unique_ptr<QueryService> service;
+            try {
+                service = std::make_unique<QueryService>(input_path.empty() ? std::move(generated.first) : G_input,
+                                                         heuristic, sopt);
+            } catch (const std::exception& ex) {
+                std::cerr << "Error: " << ex.what() << "\n";
+                return 1;
+            }
+            if (warmup > 0) {
+                std::vector<QueryRequest> warm(requests.begin(),
+                                               requests.begin() + std::min<size_t>(warmup, requests.size()));
+                replay_queries(*service, warm, 0.0);
+            }
+            for (double rate : rates) {
+                ServiceStats st = replay_queries(*service, requests, rate);
+                std::cout << "Grafo " << i << ", ritmo " << (rate > 0 ? fmt_num(rate) : "max") << ": "
+                          << st.completed << " consultas en " << st.elapsed_seconds << " s (" << st.throughput
+                          << " /s), latencia media " << st.mean_latency << " s, p99 " << st.p99_latency << " s, "
+                          << st.rejected << " rechazadas\n";
+                Row row = {{"graph", std::to_string(i)}, {"seed", std::to_string(opt.seed)},
+                           {"threads", std::to_string(service->num_threads())}, {"rate", fmt_num(rate)},
+                           {"queries", std::to_string(requests.size())}, {"completed", std::to_string(st.completed)},
+                           {"failed", std::to_string(st.failed)}, {"rejected", std::to_string(st.rejected)},
+                           {"seconds", fmt_num(st.elapsed_seconds)}, {"throughput", fmt_num(st.throughput)},
+                           {"mean_latency", fmt_num(st.mean_latency)}, {"p50_latency", fmt_num(st.p50_latency)},
+                           {"p99_latency", fmt_num(st.p99_latency)}, {"max_latency", fmt_num(st.max_latency)},
+                           {"mean_queue", fmt_num(st.mean_queue)}, {"mean_service", fmt_num(st.mean_service)}};
+                rows_out.write(row);
+            }
+            continue;
+        }
+
+        if (agents) {
+            // La heurística por id no es admisible: sin coordenadas, la cero
+            HeuristicFunction h_agents = coords.empty() ? HeuristicFunction(zero_heuristic) : heuristic;
+            size_t bad = run_agents(rows_out, input_path.empty() ? std::move(generated.first) : G_input, h_agents, i,
+                                    opt.seed, query_seed, std::max(0, num_agents), std::max(0, agent_steps),
+                                    std::max(0, agent_changes), wmax);
+            std::cout << "Grafo " << i << ": " << num_agents << " agentes, " << agent_steps << " pasos, "
+                      << bad << " costes distintos de A*\n";
+            continue;
+        }
+
+        if (deadline) {
+            first_query_ok = run_deadline(rows_out, G, heuristic, i, opt.seed, query_seed, queries, cfg.bmssp,
+                                          deadline_ms, query_memory) && first_query_ok;
+            continue;
+        }
+
+        if (anytime) {
+            run_anytime(rows_out, G, heuristic, i, opt.seed, query_seed, queries, aopt, std::max(0, agent_changes),
+                        wmax);
+            continue;
+        }
+
+        // Predecesores para D*-lite: parte de preparar el grafo, fuera de las medidas
+        Predecessors<Graph> preds(G);
+        cfg.preds = &preds;
+
+        if (sweep) {
+            // Pares sorteados con mt19937 (salida fija por estándar) a partir de
+            // query_seed y del índice del grafo; el calentamiento usa pares propios
+            std::vector<Node> nodes = sorted_nodes(G);
+            if (nodes.empty()) continue;
+            std::mt19937 qrng(query_seed + 7919u * (unsigned)i);
+            auto pick = [&]() { return nodes[qrng() % nodes.size()]; };
+
+            for (int w = 0; w < warmup; ++w) {
+                Node s_w = pick(), t_w = pick();
+                RunConfig warm = cfg;
+                warm.trace = nullptr;  // el calentamiento no se traza
+                run_benchmark(G, E, s_w, t_w, heuristic, warm);
+            }
+
+            std::vector<BenchResult> rows;
+            rows.reserve(std::max(0, queries));
+            for (int q = 0; q < queries; ++q) {
+                Node s_q = pick(), t_q = pick();
+                BenchResult r = run_benchmark(G, E, s_q, t_q, heuristic, cfg);
+                Row row = {{"kind", "query"}, {"graph", std::to_string(i)}, {"seed", std::to_string(opt.seed)},
+                           {"query", std::to_string(q)}, {"source", std::to_string(s_q)},
+                           {"target", std::to_string(t_q)}, {"alloc", alloc_mode_name(alloc_modes.front())}};
+                append_result(row, r, true);
+                rows_out.write(row);
+                rows.push_back(r);
+            }
+            write_sweep_aggregates(rows_out, i, opt.seed, alloc_modes.front(), rows);
+            continue;
+        }
+
         if (!G.count(source)) source = 0;
-        if (!G.count(target)) target = std::min(n-1, 1000);  // Asegurar que target existe
+        if (!G.count(target)) target = std::min((int)G.size() - 1, 1000);  // Asegurar que target existe
+
+        if (stats) {
+            auto recs = run_stats(G, preds, source, target, heuristic, hopt, cfg.bmssp, alloc_modes, i, opt.seed,
+                                  cfg.reduced);
+            for (const auto& r : recs) {
+                std::cout << "  " << r.label << ": mediana " << r.stats.median << " s  [" << r.stats.ci_low
+                          << ", " << r.stats.ci_high << "]  p99 " << r.stats.p99 << " s  (" << r.stats.reps
+                          << " reps" << (r.stats.converged ? "" : ", sin converger") << ")\n";
+            }
+            records.insert(records.end(), recs.begin(), recs.end());
+            continue;
+        }
 
-        BenchResult r = run_benchmark(G, E, source, target);
-        fout << i << "," << opt.seed << "," << r.time_dij << "," << r.time_bm << "," << r.time_astar << "," << r.time_dstar << "\n";
+        BenchResult r = run_benchmark(G, E, source, target, heuristic, cfg);
+        Row row = {{"trial", std::to_string(i)}, {"seed", std::to_string(opt.seed)},
+                   {"alloc", alloc_mode_name(alloc_modes.front())}};
+        append_result(row, r, true);
+        rows_out.write(row);
+    }
+
+    if (stats) {
+        write_bench_csv(fout, records);
+        if (!json_path.empty()) {
+            jout.open(json_path);
+            if (!jout) {
+                std::cerr << "Error: cannot open output file: " << json_path << "\n";
+                return 1;
+            }
+            write_bench_json(jout, records);
+        }
+    }
+
+    if (tracing) {
+        std::cout << "Traza BMSSP: " << bmssp_trace.recorded() << " llamadas ("
+                  << bmssp_trace.dropped() << " descartadas del buffer)\n";
+        for (size_t l = 0; l < bmssp_trace.levels().size(); ++l) {
+            const TraceLevelSummary& s = bmssp_trace.levels()[l];
+            if (!s.calls) continue;
+            std::cout << "  nivel " << l << ": " << s.calls << " llamadas, |S| medio " << (double)s.sum_S / s.calls
+                      << ", |U| medio " << (double)s.sum_U / s.calls << ", " << s.pulls << " pulls, "
+                      << s.partial << " parciales, " << s.seconds << " s\n";
+        }
+        if (!trace_path.empty()) {
+            std::ofstream tout(trace_path);
+            if (!tout) {
+                std::cerr << "Error: cannot open output file: " << trace_path << "\n";
+                return 1;
+            }
+            bmssp_trace.write_chrome_trace(tout);
+        }
+        if (!trace_levels_path.empty()) {
+            std::ofstream lout(trace_levels_path);
+            if (!lout) {
+                std::cerr << "Error: cannot open output file: " << trace_levels_path << "\n";
+                return 1;
+            }
+            bmssp_trace.write_level_summary(lout);
+        }
     }
 
     fout.close();
-    std::cout << "CSV listo ("<<trials<<" tests) => " << out_path << "\n";
-    return 0;
+    if (stats) std::cout << "CSV listo (" << records.size() << " mediciones) => " << out_path << "\n";
+    else if (tune) std::cout << "CSV listo (" << trials << " grafos ajustados, base " << tune_db << ") => " << out_path << "\n";
+    else if (weights) std::cout << "CSV listo (" << trials << " grafos x 3 tipos de peso) => " << out_path << "\n";
+    else if (deadline) std::cout << "CSV listo (" << trials << " grafos x " << queries << " consultas) => " << out_path << "\n";
+    else if (anytime) std::cout << "CSV listo (" << trials << " grafos x " << queries << " consultas) => " << out_path << "\n";
+    else if (agents) std::cout << "CSV listo (" << trials << " grafos x " << agent_steps << " pasos) => " << out_path << "\n";
+    else if (serve) std::cout << "CSV listo (" << trials << " grafos x " << rates.size() << " ritmos) => " << out_path << "\n";
+    else if (sweep) std::cout << "CSV listo ("<<trials<<" grafos x "<<queries<<" consultas) => " << out_path << "\n";
+    else std::cout << "CSV listo ("<<trials<<" tests) => " << out_path << "\n";
+    return first_query_ok ? 0 : 2;
 }